@@ -1,4 +1,5 @@
 #include <frost/ast/destructure-array.hpp>
+#include <frost/ast/resolver.hpp>
 
 namespace frst::ast
 {
@@ -38,12 +39,20 @@ void Destructure_Array::do_destructure(Execution_Context ctx,
     }
     else if (rest_name_)
     {
-        ctx.symbols.define(
-            rest_name_.value(),
+        ctx.define(
+            rest_name_.value(), rest_slot_,
             Value::create(arr
                           | std::views::drop(destructures_.size())
                           | std::ranges::to<Array>()));
     }
 }
 
+void Destructure_Array::resolve(Resolver& resolver) const
+{
+    AST_Node::resolve(resolver);
+
+    if (rest_name_ && rest_name_ != "_")
+        rest_slot_ = resolver.define(rest_name_.value());
+}
+
 } // namespace frst::ast
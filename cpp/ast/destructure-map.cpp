@@ -1,4 +1,5 @@
 #include <frost/ast/destructure-map.hpp>
+#include <frost/ast/resolver.hpp>
 
 namespace frst::ast
 {
@@ -38,7 +39,15 @@ void Destructure_Map::do_destructure(Execution_Context ctx,
     }
 
     if (bind_whole_name_)
-        ctx.symbols.define(bind_whole_name_.value(), value);
+        ctx.define(bind_whole_name_.value(), bind_whole_slot_, value);
+}
+
+void Destructure_Map::resolve(Resolver& resolver) const
+{
+    AST_Node::resolve(resolver);
+
+    if (bind_whole_name_)
+        bind_whole_slot_ = resolver.define(bind_whole_name_.value());
 }
 
 } // namespace frst::ast
@@ -1,4 +1,5 @@
 #include <frost/ast/do.hpp>
+#include <frost/ast/resolver.hpp>
 #include <frost/ast/utils/block-utils.hpp>
 
 #include <flat_set>
@@ -38,11 +39,26 @@ Do_Block::Do_Block(const Source_Range& source_range,
 
 Value_Ptr Do_Block::do_evaluate(Evaluation_Context ctx) const
 {
+    const auto run = [&](Execution_Context block_context) {
+        for (const auto& statement : body_prefix_)
+            statement->execute(block_context);
+        return value_expr_->evaluate(block_context.as_eval());
+    };
+
+    // A resolved block defines into frame slots, so it needs no table
+    if (resolved_)
+        return run({.symbols = Symbol_Table::sealed(), .frame = ctx.frame});
+
     Symbol_Table block_table{&ctx.symbols};
-    Execution_Context block_context{.symbols = block_table};
-    for (const auto& statement : body_prefix_)
-        statement->execute(block_context);
-    return value_expr_->evaluate(block_context.as_eval());
+    return run({.symbols = block_table, .frame = ctx.frame});
+}
+
+void Do_Block::resolve(Resolver& resolver) const
+{
+    resolver.push_scope();
+    AST_Node::resolve(resolver);
+    resolver.pop_scope();
+    resolved_ = true;
 }
 
 std::string Do_Block::do_node_label() const
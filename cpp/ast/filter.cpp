@@ -5,6 +5,14 @@
 
 using namespace frst;
 
+namespace
+{
+std::string describe_filter(const Callable& fn)
+{
+    return fmt::format("Filter ({})", fn.name());
+}
+} // namespace
+
 ast::Filter::Filter(const Source_Range& source_range, Expression::Ptr structure,
                     Expression::Ptr operation)
     : Expression(source_range)
@@ -32,7 +40,7 @@ Value_Ptr ast::Filter::do_evaluate(Evaluation_Context ctx) const
 
     const auto& fn = op_val->raw_get<Function>();
 
-    auto guard = make_frame_guard("Filter ({})", fn->name());
+    auto guard = make_frame_guard<describe_filter>(*fn);
 
     return Value::do_filter(structure_val, fn);
 }
@@ -4,6 +4,14 @@
 
 using namespace frst;
 
+namespace
+{
+std::string describe_foreach(const Callable& op)
+{
+    return fmt::format("Foreach ({})", op.name());
+}
+} // namespace
+
 ast::Foreach::Foreach(const Source_Range& source_range,
                       Expression::Ptr structure, Expression::Ptr operation)
     : Expression(source_range)
@@ -31,7 +39,7 @@ Value_Ptr ast::Foreach::do_evaluate(Evaluation_Context ctx) const
 
     const auto& op = op_val->raw_get<Function>();
 
-    auto guard = make_frame_guard("Foreach ({})", op->name());
+    auto guard = make_frame_guard<describe_foreach>(*op);
 
     if (structure_val->is<Array>())
     {
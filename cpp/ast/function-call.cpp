@@ -1,5 +1,6 @@
 #include <frost/ast/function-call.hpp>
 #include <frost/backtrace.hpp>
+#include <frost/tail-call.hpp>
 
 #include <ranges>
 
@@ -24,7 +25,7 @@ Value_Ptr ast::Function_Call::do_evaluate(Evaluation_Context ctx) const
             fmt::format("Cannot call value of type {}", fn->type_name())};
     }
 
-    const auto args =
+    auto args =
         args_exprs_
         | std::views::transform([&](const Expression::Ptr& arg_expr) {
               return arg_expr->evaluate(ctx);
@@ -33,7 +34,11 @@ Value_Ptr ast::Function_Call::do_evaluate(Evaluation_Context ctx) const
 
     const auto& callable = fn->raw_get<Function>();
 
-    auto guard = make_frame_guard("In {}", callable->name());
+    // While backtraces are recorded, every call keeps its frame
+    if (tail_call_ && not Backtrace_State::current())
+        return Tail_Call::defer(callable, std::move(args));
+
+    auto guard = make_frame_guard<describe_call>(*callable);
 
     return callable->call(std::move(args));
 }
@@ -24,6 +24,13 @@ Value_Ptr ast::If::do_evaluate(Evaluation_Context ctx) const
     return Value::null();
 }
 
+void ast::If::mark_tail_position() const
+{
+    consequent_->mark_tail_position();
+    if (alternate_)
+        alternate_.value()->mark_tail_position();
+}
+
 std::string ast::If::do_node_label() const
 {
     return "If";
@@ -29,6 +29,7 @@
 #include <frost/ast/match-value.hpp>
 #include <frost/ast/name-lookup.hpp>
 #include <frost/ast/reduce.hpp>
+#include <frost/ast/resolver.hpp>
 #include <frost/ast/statement.hpp>
 #include <frost/ast/unop.hpp>
 
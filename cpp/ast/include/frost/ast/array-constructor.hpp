@@ -24,6 +24,11 @@ class Array_Constructor final : public Expression
 
     bool data_safe() const final;
 
+    const std::vector<Expression::Ptr>& elems() const
+    {
+        return elems_;
+    }
+
   protected:
     std::string do_node_label() const final;
 
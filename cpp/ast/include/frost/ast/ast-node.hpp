@@ -15,6 +15,8 @@
 namespace frst::ast
 {
 
+class Resolver;
+
 //! @brief Common base class of all AST nodes (tree infrastructure)
 class AST_Node
 {
@@ -66,6 +68,17 @@ class AST_Node
             co_yield std::ranges::elements_of(child.node->symbol_sequence());
     }
 
+    //! @brief Assign frame slots to the names used and defined by this node
+    //!
+    //! Called once, at parse time, on each node of a closure body. Nodes that
+    //! use or define names stamp their resolved slots, everything else just
+    //! passes the resolver on to its children in evaluation order.
+    virtual void resolve(Resolver& resolver) const
+    {
+        for (const Child_Info& child : children())
+            child.node->resolve(resolver);
+    }
+
     std::string node_label() const;
 
     // True if a node is safe to deserialize from Frost Data
@@ -174,19 +187,18 @@ struct fmt::formatter<frst::ast::AST_Node::Source_Range>
 namespace frst::ast
 {
 
-inline std::optional<Frame_Guard> make_node_frame_guard(const AST_Node& node)
+inline std::string describe_node_frame(const AST_Node& node)
 {
-    auto* bt = Backtrace_State::current();
-    if (not bt)
-        return std::nullopt;
-
     std::string_view path =
         node.filepath() ? std::string_view{*node.filepath()} : "<unknown>";
 
-    auto label =
-        fmt::format("{} [{}] {}", node.node_label(), node.source_range(), path);
+    return fmt::format("{} [{}] {}", node.node_label(), node.source_range(),
+                       path);
+}
 
-    return Frame_Guard{bt, std::move(label)};
+inline Frame_Guard make_node_frame_guard(const AST_Node& node)
+{
+    return make_frame_guard<describe_node_frame>(node);
 }
 
 } // namespace frst::ast
@@ -84,6 +84,21 @@ class Binop final : public Expression
 
     bool data_safe() const final;
 
+    const Expression& lhs() const
+    {
+        return *lhs_;
+    }
+
+    const Expression& rhs() const
+    {
+        return *rhs_;
+    }
+
+    Binary_Op op() const
+    {
+        return op_;
+    }
+
   protected:
     std::string do_node_label() const final;
 
@@ -33,6 +33,16 @@ class Define final : public Statement
         return exports_;
     }
 
+    const Destructure& destructure() const
+    {
+        return *destructure_;
+    }
+
+    const Expression& expr() const
+    {
+        return *expr_;
+    }
+
   protected:
     std::string do_node_label() const final;
 
@@ -44,6 +44,8 @@ class Destructure_Array final : public Destructure
             co_yield make_child(d);
     }
 
+    void resolve(Resolver& resolver) const final;
+
   protected:
     void do_destructure(Execution_Context ctx,
                         const Value_Ptr& value) const final;
@@ -60,6 +62,7 @@ class Destructure_Array final : public Destructure
   private:
     std::vector<Destructure::Ptr> destructures_;
     std::optional<std::string> rest_name_;
+    mutable std::optional<Frame_Slot> rest_slot_;
 };
 
 } // namespace frst::ast
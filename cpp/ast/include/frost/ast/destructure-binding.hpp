@@ -3,6 +3,7 @@
 
 #include "frost/execution-context.hpp"
 #include <frost/ast/destructure.hpp>
+#include <frost/ast/resolver.hpp>
 
 namespace frst::ast
 {
@@ -36,12 +37,29 @@ class Destructure_Binding final : public Destructure
             co_yield AST_Node::Definition{name_.value()};
     }
 
+    void resolve(Resolver& resolver) const final
+    {
+        if (name_)
+            slot_ = resolver.define(name_.value());
+    }
+
+    // Empty if the value is discarded
+    const std::optional<std::string>& name() const
+    {
+        return name_;
+    }
+
+    const std::optional<Frame_Slot>& slot() const
+    {
+        return slot_;
+    }
+
   protected:
     void do_destructure(Execution_Context ctx,
                         const Value_Ptr& value) const final
     {
         if (name_)
-            ctx.symbols.define(name_.value(), value);
+            ctx.define(name_.value(), slot_, value);
     }
 
     std::string do_node_label() const final
@@ -52,6 +70,7 @@ class Destructure_Binding final : public Destructure
 
   private:
     std::optional<std::string> name_;
+    mutable std::optional<Frame_Slot> slot_;
 };
 
 } // namespace frst::ast
@@ -60,6 +60,8 @@ class Destructure_Map final : public Destructure
         }
     }
 
+    void resolve(Resolver& resolver) const final;
+
   protected:
     std::string do_node_label() const final
     {
@@ -75,6 +77,7 @@ class Destructure_Map final : public Destructure
   private:
     std::vector<Element> destructure_elems_;
     std::optional<std::string> bind_whole_name_;
+    mutable std::optional<Frame_Slot> bind_whole_slot_;
 };
 
 } // namespace frst::ast
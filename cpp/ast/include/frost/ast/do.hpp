@@ -23,6 +23,29 @@ class Do_Block final : public Expression
 
     std::generator<Symbol_Action> symbol_sequence() const final;
 
+    void resolve(Resolver& resolver) const final;
+
+    void mark_tail_position() const final
+    {
+        value_expr_->mark_tail_position();
+    }
+
+    const std::vector<ast::Statement::Ptr>& body_prefix() const
+    {
+        return body_prefix_;
+    }
+
+    const ast::Expression& value_expr() const
+    {
+        return *value_expr_;
+    }
+
+    // True once resolve() has bound the block's names into its closure's frame
+    bool resolved() const
+    {
+        return resolved_;
+    }
+
   protected:
     std::string do_node_label() const final;
 
@@ -33,6 +56,7 @@ class Do_Block final : public Expression
   private:
     std::vector<ast::Statement::Ptr> body_prefix_;
     ast::Expression::Ptr value_expr_;
+    mutable bool resolved_ = false;
 };
 
 } // namespace frst::ast
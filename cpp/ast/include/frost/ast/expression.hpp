@@ -31,6 +31,15 @@ class Expression : public Statement
         return do_evaluate(ctx);
     }
 
+    //! @brief Note that this expression's value is returned from its closure
+    //!
+    //! Called once, at parse time, on the return expression of each lambda.
+    //! Nodes whose value is exactly that of one of their children pass it on
+    //! to those children, and calls become tail calls.
+    virtual void mark_tail_position() const
+    {
+    }
+
   protected:
     [[nodiscard]] virtual Value_Ptr do_evaluate(
         Evaluation_Context ctx) const = 0;
@@ -24,6 +24,32 @@ class Function_Call final : public Expression
     Function_Call(const Source_Range& source_range, Expression::Ptr fn_expr,
                   std::vector<Expression::Ptr> args_exprs);
 
+    // Backtrace frame text for a call into `callable`
+    static std::string describe_call(const Callable& callable)
+    {
+        return fmt::format("In {}", callable.name());
+    }
+
+    void mark_tail_position() const final
+    {
+        tail_call_ = true;
+    }
+
+    bool tail_call() const
+    {
+        return tail_call_;
+    }
+
+    const Expression& fn_expr() const
+    {
+        return *fn_expr_;
+    }
+
+    const std::vector<Expression::Ptr>& args_exprs() const
+    {
+        return args_exprs_;
+    }
+
   protected:
     std::string do_node_label() const final;
 
@@ -34,6 +60,9 @@ class Function_Call final : public Expression
   private:
     Expression::Ptr fn_expr_;
     std::vector<Expression::Ptr> args_exprs_;
+
+    // Set by mark_tail_position(), the call is then left to the closure
+    mutable bool tail_call_ = false;
 };
 } // namespace frst::ast
 #endif
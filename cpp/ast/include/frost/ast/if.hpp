@@ -21,6 +21,23 @@ class If final : public Expression
     If& operator=(If&&) = delete;
     ~If() final = default;
 
+    void mark_tail_position() const final;
+
+    const Expression& condition() const
+    {
+        return *condition_;
+    }
+
+    const Expression& consequent() const
+    {
+        return *consequent_;
+    }
+
+    const Expression* alternate() const
+    {
+        return alternate_ ? alternate_->get() : nullptr;
+    }
+
   protected:
     std::string do_node_label() const final;
 
@@ -26,6 +26,11 @@ class Literal final : public Expression
 
     bool data_safe() const final;
 
+    const Value_Ptr& value() const
+    {
+        return value_;
+    }
+
   protected:
     std::string do_node_label() const final;
 
@@ -24,6 +24,8 @@ class Match_Alternative final : public Match_Pattern
     std::generator<Symbol_Action> symbol_sequence() const final;
     std::generator<Child_Info> children() const final;
 
+    void resolve(Resolver& resolver) const final;
+
   protected:
     bool do_try_match(Execution_Context ctx,
                       const Value_Ptr& value) const final;
@@ -35,6 +37,16 @@ class Match_Alternative final : public Match_Pattern
 
   private:
     std::vector<Match_Pattern::Ptr> alternatives_;
+
+    // Once resolved, every alternative binds into the same scratch slots,
+    // which are copied into the enclosing scope's slots on success
+    struct Resolved_Binding
+    {
+        std::string name;
+        Frame_Slot scratch;
+        Frame_Slot target;
+    };
+    mutable std::optional<std::vector<Resolved_Binding>> resolved_bindings_;
 };
 
 } // namespace frst::ast
@@ -58,6 +58,8 @@ class Match_Array final : public Match_Pattern
     std::generator<Symbol_Action> symbol_sequence() const final;
     std::generator<Child_Info> children() const final;
 
+    void resolve(Resolver& resolver) const final;
+
   protected:
     bool do_try_match(Execution_Context ctx,
                       const Value_Ptr& value) const final;
@@ -66,6 +68,7 @@ class Match_Array final : public Match_Pattern
   private:
     std::vector<Match_Pattern::Ptr> subpatterns_;
     std::optional<Rest> rest_;
+    mutable std::optional<Frame_Slot> rest_slot_;
 };
 
 } // namespace frst::ast
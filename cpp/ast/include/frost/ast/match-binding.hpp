@@ -108,6 +108,8 @@ class Match_Binding final : public Match_Pattern
 
     std::generator<Symbol_Action> symbol_sequence() const final;
 
+    void resolve(Resolver& resolver) const final;
+
   protected:
     bool do_try_match(Execution_Context ctx,
                       const Value_Ptr& value) const final;
@@ -116,6 +118,7 @@ class Match_Binding final : public Match_Pattern
   private:
     std::optional<std::string> name_;
     std::optional<Type_Constraint> type_constraint_;
+    mutable std::optional<Frame_Slot> slot_;
 };
 
 } // namespace frst::ast
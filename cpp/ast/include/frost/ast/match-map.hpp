@@ -56,6 +56,8 @@ class Match_Map final : public Match_Pattern
     std::generator<Symbol_Action> symbol_sequence() const final;
     std::generator<Child_Info> children() const final;
 
+    void resolve(Resolver& resolver) const final;
+
   protected:
     bool do_try_match(Execution_Context ctx,
                       const Value_Ptr& value) const final;
@@ -64,6 +66,7 @@ class Match_Map final : public Match_Pattern
   private:
     std::vector<Element> elements_;
     std::optional<std::string> bind_whole_name_;
+    mutable std::optional<Frame_Slot> bind_whole_slot_;
 };
 
 } // namespace frst::ast
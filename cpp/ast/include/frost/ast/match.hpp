@@ -3,6 +3,7 @@
 
 #include <frost/ast/expression.hpp>
 #include <frost/ast/match-pattern.hpp>
+#include <frost/ast/resolver.hpp>
 #include <frost/ast/utils/block-utils.hpp>
 
 #include <flat_set>
@@ -85,25 +86,54 @@ class Match final : public Expression
         }
     }
 
+    void resolve(Resolver& resolver) const final
+    {
+        target_->resolve(resolver);
+
+        for (const auto& [pat, guard, result] : arms_)
+        {
+            resolver.push_scope();
+            pat->resolve(resolver);
+            if (guard)
+                guard.value()->resolve(resolver);
+            result->resolve(resolver);
+            resolver.pop_scope();
+        }
+
+        resolved_ = true;
+    }
+
+    void mark_tail_position() const final
+    {
+        for (const Arm& arm : arms_)
+            arm.result->mark_tail_position();
+    }
+
   protected:
     Value_Ptr do_evaluate(Evaluation_Context ctx) const final
     {
         auto target = target_->evaluate(ctx);
 
-        for (const auto& [pat, guard, result] : arms_)
+        for (const auto& arm : arms_)
         {
-            Symbol_Table arm_table{&ctx.symbols};
-            Execution_Context arm_ctx{.symbols = arm_table};
-
-            // pat assigns into the arm_table
-            if (not pat->try_match(arm_ctx, target))
+            // A resolved arm binds into its own frame slots, which no other
+            // arm shares, so a failed match needs no scratch scope
+            if (resolved_)
+            {
+                if (auto result = try_arm(arm,
+                                          {.symbols = Symbol_Table::sealed(),
+                                           .frame = ctx.frame},
+                                          target))
+                    return std::move(result).value();
                 continue;
+            }
 
-            if (guard
-                && not guard.value()->evaluate(arm_ctx.as_eval())->truthy())
-                continue;
+            Symbol_Table arm_table{&ctx.symbols};
 
-            return result->evaluate(arm_ctx.as_eval());
+            // pat assigns into the arm_table
+            if (auto result = try_arm(
+                    arm, {.symbols = arm_table, .frame = ctx.frame}, target))
+                return std::move(result).value();
         }
 
         throw Frost_Recoverable_Error{
@@ -117,8 +147,26 @@ class Match final : public Expression
     }
 
   private:
+    // Empty if the arm did not match
+    // The result itself is an empty Value_Ptr if it is a tail call
+    static std::optional<Value_Ptr> try_arm(const Arm& arm,
+                                            Execution_Context arm_ctx,
+                                            const Value_Ptr& target)
+    {
+        const auto& [pat, guard, result] = arm;
+
+        if (not pat->try_match(arm_ctx, target))
+            return std::nullopt;
+
+        if (guard && not guard.value()->evaluate(arm_ctx.as_eval())->truthy())
+            return std::nullopt;
+
+        return result->evaluate(arm_ctx.as_eval());
+    }
+
     Expression::Ptr target_;
     std::vector<Arm> arms_;
+    mutable bool resolved_ = false;
 };
 
 } // namespace frst::ast
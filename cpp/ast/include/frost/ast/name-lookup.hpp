@@ -24,6 +24,18 @@ class Name_Lookup final : public Expression
 
     std::generator<Symbol_Action> symbol_sequence() const final;
 
+    void resolve(Resolver& resolver) const final;
+
+    const std::string& name() const
+    {
+        return name_;
+    }
+
+    const std::optional<Frame_Slot>& slot() const
+    {
+        return slot_;
+    }
+
   protected:
     std::string do_node_label() const final;
 
@@ -31,6 +43,9 @@ class Name_Lookup final : public Expression
 
   private:
     std::string name_;
+
+    // Stamped by resolve() when this lookup is within a closure body
+    mutable std::optional<Frame_Slot> slot_;
 };
 } // namespace frst::ast
 
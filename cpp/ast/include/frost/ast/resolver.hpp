@@ -0,0 +1,69 @@
+#ifndef FROST_AST_RESOLVER_HPP
+#define FROST_AST_RESOLVER_HPP
+
+#include <frost/frame.hpp>
+
+#include <cstdint>
+#include <flat_map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace frst::ast
+{
+
+//! @brief Assigns frame slots to the names within a closure body
+//!
+//! Scopes mirror the runtime symbol tables a closure body would otherwise
+//! create (the body itself, do-blocks, match arms, match alternatives).
+//! Every scope allocates from the same flat run of local slots, so a name
+//! resolves to a single index no matter how deeply it is nested.
+class Resolver
+{
+  public:
+    using Scope_Bindings = std::flat_map<std::string, Frame_Slot>;
+
+    Resolver(const std::vector<std::string>& captures);
+
+    Resolver() = delete;
+    Resolver(const Resolver&) = delete;
+    Resolver(Resolver&&) = delete;
+    Resolver& operator=(const Resolver&) = delete;
+    Resolver& operator=(Resolver&&) = delete;
+    ~Resolver() = default;
+
+    // Resolve a usage, searching from the innermost scope outward, then the
+    // captures
+    // Empty if the name is not visible at all
+    std::optional<Frame_Slot> use(const std::string& name) const;
+
+    // Resolve a definition in the innermost scope
+    // Redefining a name within one scope yields its existing slot, so the
+    // redefinition error is still raised at runtime
+    Frame_Slot define(const std::string& name);
+
+    // Definitions in the new scope take their slot from `reuse` when it has
+    // one for the name, so sibling scopes can share slots
+    void push_scope(const Scope_Bindings* reuse = nullptr);
+    Scope_Bindings pop_scope();
+
+    std::size_t local_count() const
+    {
+        return local_count_;
+    }
+
+  private:
+    struct Scope
+    {
+        Scope_Bindings names;
+        const Scope_Bindings* reuse = nullptr;
+    };
+
+    Scope_Bindings captures_;
+    std::vector<Scope> scopes_;
+    std::uint32_t local_count_ = 0;
+};
+
+} // namespace frst::ast
+
+#endif
@@ -7,6 +7,14 @@
 
 using namespace frst;
 
+namespace
+{
+std::string describe_map(const Callable& fn)
+{
+    return fmt::format("Map ({})", fn.name());
+}
+} // namespace
+
 ast::Map::Map(const Source_Range& source_range, Expression::Ptr structure,
               Expression::Ptr operation)
     : Expression(source_range)
@@ -33,7 +41,7 @@ Value_Ptr ast::Map::do_evaluate(Evaluation_Context ctx) const
 
     const auto& fn = op_val->raw_get<Function>();
 
-    auto guard = make_frame_guard("Map ({})", fn->name());
+    auto guard = make_frame_guard<describe_map>(*fn);
 
     return Value::do_map(structure_val, fn, "Map");
 }
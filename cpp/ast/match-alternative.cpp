@@ -1,4 +1,5 @@
 #include <frost/ast/match-alternative.hpp>
+#include <frost/ast/resolver.hpp>
 
 #include <flat_set>
 
@@ -80,9 +81,51 @@ std::generator<AST_Node::Child_Info> Match_Alternative::children() const
         co_yield make_child(alternative);
 }
 
+void Match_Alternative::resolve(Resolver& resolver) const
+{
+    resolver.push_scope();
+    alternatives_.front()->resolve(resolver);
+    const auto scratch = resolver.pop_scope();
+
+    for (const auto& alternative : alternatives_ | std::views::drop(1))
+    {
+        resolver.push_scope(&scratch);
+        alternative->resolve(resolver);
+        resolver.pop_scope();
+    }
+
+    auto& bindings = resolved_bindings_.emplace();
+    for (const auto& [name, slot] : scratch)
+        bindings.push_back({
+            .name = name,
+            .scratch = slot,
+            .target = resolver.define(name),
+        });
+}
+
 bool Match_Alternative::do_try_match(Execution_Context ctx,
                                      const Value_Ptr& value) const
 {
+    if (resolved_bindings_)
+    {
+        for (const auto& alternative : alternatives_)
+        {
+            // Discard whatever a previous failed alternative left behind
+            for (const auto& binding : resolved_bindings_.value())
+                ctx.frame->reset(binding.scratch);
+
+            if (alternative->try_match(ctx, value))
+            {
+                for (const auto& binding : resolved_bindings_.value())
+                    ctx.frame->define(binding.target,
+                                      ctx.frame->get(binding.scratch),
+                                      binding.name);
+                return true;
+            }
+        }
+        return false;
+    }
+
     for (const auto& alternative : alternatives_)
     {
         Symbol_Table scratch_table{&ctx.symbols};
@@ -1,4 +1,5 @@
 #include <frost/ast/match-array.hpp>
+#include <frost/ast/resolver.hpp>
 
 namespace frst::ast
 {
@@ -51,12 +52,21 @@ bool Match_Array::do_try_match(Execution_Context ctx,
                     | std::views::drop(subpatterns_.size())
                     | std::ranges::to<Array>();
 
-        ctx.symbols.define(rest_->name.value(), Value::create(std::move(tail)));
+        ctx.define(rest_->name.value(), rest_slot_,
+                   Value::create(std::move(tail)));
     }
 
     return true;
 }
 
+void Match_Array::resolve(Resolver& resolver) const
+{
+    AST_Node::resolve(resolver);
+
+    if (rest_ && rest_->name)
+        rest_slot_ = resolver.define(rest_->name.value());
+}
+
 std::string Match_Array::do_node_label() const
 {
     if (rest_)
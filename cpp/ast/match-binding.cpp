@@ -1,4 +1,5 @@
 #include <frost/ast/match-binding.hpp>
+#include <frost/ast/resolver.hpp>
 
 namespace frst::ast::TC
 {
@@ -59,11 +60,17 @@ bool Match_Binding::do_try_match(Execution_Context ctx,
         return false;
 
     if (name_)
-        ctx.symbols.define(name_.value(), value);
+        ctx.define(name_.value(), slot_, value);
 
     return true;
 }
 
+void Match_Binding::resolve(Resolver& resolver) const
+{
+    if (name_)
+        slot_ = resolver.define(name_.value());
+}
+
 std::string Match_Binding::do_node_label() const
 {
     if (type_constraint_)
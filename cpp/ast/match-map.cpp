@@ -1,4 +1,5 @@
 #include <frost/ast/match-map.hpp>
+#include <frost/ast/resolver.hpp>
 
 namespace frst::ast
 {
@@ -56,11 +57,19 @@ bool Match_Map::do_try_match(Execution_Context ctx,
     }
 
     if (bind_whole_name_)
-        ctx.symbols.define(bind_whole_name_.value(), value);
+        ctx.define(bind_whole_name_.value(), bind_whole_slot_, value);
 
     return true;
 }
 
+void Match_Map::resolve(Resolver& resolver) const
+{
+    AST_Node::resolve(resolver);
+
+    if (bind_whole_name_)
+        bind_whole_slot_ = resolver.define(bind_whole_name_.value());
+}
+
 std::string Match_Map::do_node_label() const
 {
     return fmt::format("Match_Map{}",
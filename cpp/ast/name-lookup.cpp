@@ -1,4 +1,5 @@
 #include <frost/ast/name-lookup.hpp>
+#include <frost/ast/resolver.hpp>
 
 using namespace frst;
 
@@ -13,7 +14,12 @@ ast::Name_Lookup::Name_Lookup(const Source_Range& source_range,
 
 Value_Ptr ast::Name_Lookup::do_evaluate(Evaluation_Context ctx) const
 {
-    return ctx.symbols.lookup(name_);
+    return ctx.lookup(name_, slot_);
+}
+
+void ast::Name_Lookup::resolve(Resolver& resolver) const
+{
+    slot_ = resolver.use(name_);
 }
 
 std::generator<ast::AST_Node::Symbol_Action> ast::Name_Lookup::symbol_sequence()
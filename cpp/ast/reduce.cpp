@@ -5,6 +5,14 @@
 
 using namespace frst;
 
+namespace
+{
+std::string describe_reduce(const Callable& fn)
+{
+    return fmt::format("Reduce ({})", fn.name());
+}
+} // namespace
+
 ast::Reduce::Reduce(const Source_Range& source_range, Expression::Ptr structure,
                     Expression::Ptr operation,
                     std::optional<Expression::Ptr> init)
@@ -37,7 +45,7 @@ Value_Ptr ast::Reduce::do_evaluate(Evaluation_Context ctx) const
         return expr->evaluate(ctx);
     });
 
-    auto guard = make_frame_guard("Reduce ({})", fn->name());
+    auto guard = make_frame_guard<describe_reduce>(*fn);
 
     return Value::do_reduce(structure_val, fn, init);
 }
@@ -0,0 +1,64 @@
+#include <frost/ast/resolver.hpp>
+
+#include <ranges>
+
+using namespace frst;
+using frst::ast::Resolver;
+
+Resolver::Resolver(const std::vector<std::string>& captures)
+{
+    for (const auto& [i, name] : std::views::enumerate(captures))
+        captures_.insert_or_assign(
+            name, Frame_Slot{.region = Frame_Slot::Region::Capture,
+                             .index = static_cast<std::uint32_t>(i)});
+
+    push_scope();
+}
+
+std::optional<Frame_Slot> Resolver::use(const std::string& name) const
+{
+    for (const auto& scope : scopes_ | std::views::reverse)
+    {
+        if (const auto itr = scope.names.find(name); itr != scope.names.end())
+            return itr->second;
+    }
+
+    if (const auto itr = captures_.find(name); itr != captures_.end())
+        return itr->second;
+
+    return std::nullopt;
+}
+
+Frame_Slot Resolver::define(const std::string& name)
+{
+    auto& scope = scopes_.back();
+
+    if (const auto itr = scope.names.find(name); itr != scope.names.end())
+        return itr->second;
+
+    if (scope.reuse)
+    {
+        if (const auto itr = scope.reuse->find(name); itr != scope.reuse->end())
+        {
+            scope.names.insert_or_assign(name, itr->second);
+            return itr->second;
+        }
+    }
+
+    const Frame_Slot slot{.region = Frame_Slot::Region::Local,
+                          .index = local_count_++};
+    scope.names.insert_or_assign(name, slot);
+    return slot;
+}
+
+void Resolver::push_scope(const Scope_Bindings* reuse)
+{
+    scopes_.push_back(Scope{.names = {}, .reuse = reuse});
+}
+
+Resolver::Scope_Bindings Resolver::pop_scope()
+{
+    auto names = std::move(scopes_.back().names);
+    scopes_.pop_back();
+    return names;
+}
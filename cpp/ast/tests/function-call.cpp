@@ -6,6 +6,7 @@
 #include <frost/mock/mock-callable.hpp>
 #include <frost/mock/mock-expression.hpp>
 #include <frost/mock/mock-symbol-table.hpp>
+#include <frost/tail-call.hpp>
 #include <frost/value.hpp>
 
 #include <algorithm>
@@ -295,4 +296,60 @@ TEST_CASE("Function Call")
 
         CHECK_THROWS_WITH(node.evaluate(ctx), ContainsSubstring("boom"));
     }
+
+    SECTION("Call in tail position is left to the running closure")
+    {
+        auto fn_expr = std::make_unique<mock::Mock_Expression>();
+        auto* fn_ptr = fn_expr.get();
+
+        auto callable = mock::Mock_Callable::make();
+        auto fn_val = Value::create(Function{callable});
+        auto arg_val = Value::create(4_f);
+
+        REQUIRE_CALL(*fn_ptr, do_evaluate(_)).RETURN(fn_val);
+        FORBID_CALL(*callable, call(_));
+
+        std::vector<Expression::Ptr> args;
+        args.push_back(
+            std::make_unique<Literal>(AST_Node::no_range, arg_val));
+
+        ast::Function_Call node{AST_Node::no_range, std::move(fn_expr),
+                                std::move(args)};
+        node.mark_tail_position();
+        CHECK(node.tail_call());
+
+        CHECK_FALSE(node.evaluate(ctx));
+
+        auto tail_call = Tail_Call::take();
+        REQUIRE(tail_call);
+        CHECK(tail_call->callee == callable);
+        REQUIRE(tail_call->args.size() == 1);
+        CHECK(tail_call->args.at(0) == arg_val);
+        CHECK_FALSE(Tail_Call::take());
+    }
+
+    SECTION("Tail position passes through if branches")
+    {
+        auto consequent = std::make_unique<ast::Function_Call>(
+            AST_Node::no_range, std::make_unique<mock::Mock_Expression>(),
+            std::vector<Expression::Ptr>{});
+        auto alternate = std::make_unique<ast::Function_Call>(
+            AST_Node::no_range, std::make_unique<mock::Mock_Expression>(),
+            std::vector<Expression::Ptr>{});
+        auto condition = std::make_unique<ast::Function_Call>(
+            AST_Node::no_range, std::make_unique<mock::Mock_Expression>(),
+            std::vector<Expression::Ptr>{});
+
+        const auto* consequent_ptr = consequent.get();
+        const auto* alternate_ptr = alternate.get();
+        const auto* condition_ptr = condition.get();
+
+        ast::If node{AST_Node::no_range, std::move(condition),
+                     std::move(consequent), std::move(alternate)};
+        node.mark_tail_position();
+
+        CHECK(consequent_ptr->tail_call());
+        CHECK(alternate_ptr->tail_call());
+        CHECK_FALSE(condition_ptr->tail_call());
+    }
 }
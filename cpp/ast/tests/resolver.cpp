@@ -0,0 +1,286 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+
+#include <frost/testing/stringmaker-specializations.hpp>
+
+#include <frost/ast.hpp>
+#include <frost/frame.hpp>
+#include <frost/symbol-table.hpp>
+#include <frost/value.hpp>
+
+#include <memory>
+#include <vector>
+
+using namespace frst;
+using namespace frst::ast;
+using namespace std::literals;
+using Catch::Matchers::ContainsSubstring;
+
+namespace
+{
+
+Frame_Slot capture(std::uint32_t index)
+{
+    return {.region = Frame_Slot::Region::Capture, .index = index};
+}
+
+Frame_Slot local(std::uint32_t index)
+{
+    return {.region = Frame_Slot::Region::Local, .index = index};
+}
+
+Expression::Ptr lit(Int v)
+{
+    return std::make_unique<Literal>(AST_Node::no_range, Value::create(v));
+}
+
+Expression::Ptr name_lookup(std::string_view n)
+{
+    return std::make_unique<Name_Lookup>(AST_Node::no_range, std::string{n});
+}
+
+Statement::Ptr define(std::string n, Expression::Ptr expr)
+{
+    return std::make_unique<Define>(
+        AST_Node::no_range,
+        std::make_unique<Destructure_Binding>(AST_Node::no_range, std::move(n)),
+        std::move(expr), false);
+}
+
+Match_Pattern::Ptr match_binding(std::string n,
+                                 std::optional<Type_Constraint> tc = {})
+{
+    return std::make_unique<Match_Binding>(AST_Node::no_range, std::move(n),
+                                           tc);
+}
+
+} // namespace
+
+// =============================================================================
+// Resolver
+// =============================================================================
+
+TEST_CASE("Resolver: captures resolve to the capture region")
+{
+    Resolver resolver{{"a", "b"}};
+
+    CHECK(resolver.use("a") == capture(0));
+    CHECK(resolver.use("b") == capture(1));
+    CHECK_FALSE(resolver.use("c").has_value());
+    CHECK(resolver.local_count() == 0);
+}
+
+TEST_CASE("Resolver: definitions take consecutive local slots")
+{
+    Resolver resolver{{}};
+
+    CHECK(resolver.define("x") == local(0));
+    CHECK(resolver.define("y") == local(1));
+    CHECK(resolver.use("x") == local(0));
+    CHECK(resolver.use("y") == local(1));
+    CHECK(resolver.local_count() == 2);
+}
+
+TEST_CASE("Resolver: locals shadow captures")
+{
+    Resolver resolver{{"x"}};
+
+    CHECK(resolver.use("x") == capture(0));
+    resolver.define("x");
+    CHECK(resolver.use("x") == local(0));
+}
+
+TEST_CASE("Resolver: redefinition within a scope keeps its slot")
+{
+    Resolver resolver{{}};
+
+    CHECK(resolver.define("x") == local(0));
+    CHECK(resolver.define("x") == local(0));
+    CHECK(resolver.local_count() == 1);
+}
+
+TEST_CASE("Resolver: inner scopes shadow and are discarded on pop")
+{
+    Resolver resolver{{}};
+    resolver.define("x");
+
+    resolver.push_scope();
+    CHECK(resolver.define("x") == local(1));
+    CHECK(resolver.use("x") == local(1));
+    const auto popped = resolver.pop_scope();
+
+    CHECK(popped.at("x") == local(1));
+    CHECK(resolver.use("x") == local(0));
+
+    // Slots are never handed out twice within one frame
+    CHECK(resolver.define("y") == local(2));
+}
+
+TEST_CASE("Resolver: sibling scopes can share slots")
+{
+    Resolver resolver{{}};
+
+    resolver.push_scope();
+    resolver.define("x");
+    resolver.define("y");
+    const auto shared = resolver.pop_scope();
+
+    resolver.push_scope(&shared);
+    CHECK(resolver.define("y") == shared.at("y"));
+    CHECK(resolver.define("x") == shared.at("x"));
+    resolver.pop_scope();
+
+    CHECK(resolver.local_count() == 2);
+}
+
+// =============================================================================
+// Resolved nodes
+// =============================================================================
+
+TEST_CASE("Resolved Name_Lookup reads from the frame")
+{
+    auto node = name_lookup("x");
+
+    Resolver resolver{{"x"}};
+    node->resolve(resolver);
+
+    auto x_val = Value::create(7_f);
+    std::vector<Value_Ptr> captures{x_val};
+    Frame frame{captures, resolver.local_count()};
+
+    CHECK(node->evaluate({.symbols = Symbol_Table::sealed(), .frame = &frame})
+          == x_val);
+}
+
+TEST_CASE("Resolved Do_Block defines into the frame")
+{
+    std::vector<Statement::Ptr> body;
+    body.push_back(define("x", lit(2)));
+    body.push_back(name_lookup("x"));
+    auto node =
+        std::make_unique<Do_Block>(AST_Node::no_range, std::move(body));
+
+    Resolver resolver{{"x"}};
+    node->resolve(resolver);
+    REQUIRE(resolver.local_count() == 1);
+
+    std::vector<Value_Ptr> captures{Value::create(1_f)};
+    Frame frame{captures, resolver.local_count()};
+
+    auto result =
+        node->evaluate({.symbols = Symbol_Table::sealed(), .frame = &frame});
+    CHECK(result->get<Int>() == 2_f);
+    CHECK(frame.get(capture(0))->get<Int>() == 1_f);
+}
+
+TEST_CASE("Resolved redefinition is still an error")
+{
+    auto first = define("x", lit(1));
+    auto second = define("x", lit(2));
+
+    Resolver resolver{{}};
+    first->resolve(resolver);
+    second->resolve(resolver);
+
+    std::vector<Value_Ptr> captures;
+    Frame frame{captures, resolver.local_count()};
+    Execution_Context ctx{.symbols = Symbol_Table::sealed(), .frame = &frame};
+
+    first->execute(ctx);
+    CHECK_THROWS_WITH(second->execute(ctx),
+                      "Cannot define x as it is already defined");
+}
+
+TEST_CASE("Resolved Match arms bind into separate slots")
+{
+    std::vector<Match::Arm> arms;
+    arms.push_back({
+        .pattern = match_binding("x", Type_Constraint::String),
+        .guard = std::nullopt,
+        .result = lit(1),
+    });
+    arms.push_back({
+        .pattern = match_binding("x"),
+        .guard = std::nullopt,
+        .result = name_lookup("x"),
+    });
+    auto node = std::make_unique<Match>(AST_Node::no_range, lit(5),
+                                        std::move(arms));
+
+    Resolver resolver{{}};
+    node->resolve(resolver);
+    CHECK(resolver.local_count() == 2);
+
+    std::vector<Value_Ptr> captures;
+    Frame frame{captures, resolver.local_count()};
+
+    auto result =
+        node->evaluate({.symbols = Symbol_Table::sealed(), .frame = &frame});
+    CHECK(result->get<Int>() == 5_f);
+}
+
+TEST_CASE("Resolved Match_Alternative discards failed alternatives")
+{
+    std::vector<Match_Pattern::Ptr> first_elems;
+    first_elems.push_back(match_binding("x"));
+    first_elems.push_back(match_binding("y", Type_Constraint::String));
+
+    std::vector<Match_Pattern::Ptr> second_elems;
+    second_elems.push_back(match_binding("y"));
+    second_elems.push_back(match_binding("x"));
+
+    std::vector<Match_Pattern::Ptr> alternatives;
+    alternatives.push_back(std::make_unique<Match_Array>(
+        AST_Node::no_range, std::move(first_elems), std::nullopt));
+    alternatives.push_back(std::make_unique<Match_Array>(
+        AST_Node::no_range, std::move(second_elems), std::nullopt));
+    auto node = std::make_unique<Match_Alternative>(AST_Node::no_range,
+                                                    std::move(alternatives));
+
+    Resolver resolver{{}};
+    node->resolve(resolver);
+    const auto x_slot = resolver.use("x");
+    const auto y_slot = resolver.use("y");
+    REQUIRE(x_slot.has_value());
+    REQUIRE(y_slot.has_value());
+
+    std::vector<Value_Ptr> captures;
+    Frame frame{captures, resolver.local_count()};
+
+    auto a = Value::create(1_f);
+    auto b = Value::create(2_f);
+    CHECK(node->try_match(
+        {.symbols = Symbol_Table::sealed(), .frame = &frame},
+        Value::create(Array{a, b})));
+
+    CHECK(frame.get(y_slot.value()) == a);
+    CHECK(frame.get(x_slot.value()) == b);
+}
+
+// =============================================================================
+// Frame
+// =============================================================================
+
+TEST_CASE("Frame: unbound slots fail lookup")
+{
+    std::vector<Value_Ptr> captures;
+    Frame frame{captures, 1};
+
+    CHECK_FALSE(frame.get(local(0)));
+    CHECK_THROWS_WITH(frame.lookup(local(0), "x"),
+                      ContainsSubstring("Symbol x is not defined"));
+}
+
+TEST_CASE("Frame: spills past the inline capacity")
+{
+    constexpr std::size_t count = Frame::small_capacity * 2;
+
+    std::vector<Value_Ptr> captures;
+    Frame frame{captures, count};
+
+    for (std::uint32_t i = 0; i < count; ++i)
+        frame.define(local(i), Value::create(Int{i}), "x");
+
+    for (std::uint32_t i = 0; i < count; ++i)
+        CHECK(frame.get(local(i))->get<Int>() == Int{i});
+}
@@ -1,23 +1,51 @@
 #ifndef FROST_EXECUTION_CONTEXT_HPP
 #define FROST_EXECUTION_CONTEXT_HPP
 
+#include "frame.hpp"
 #include "symbol-table.hpp"
 
+#include <optional>
+
 namespace frst
 {
 
 struct Evaluation_Context
 {
     const Symbol_Table& symbols;
+
+    // The running closure's frame, if any
+    Frame* frame = nullptr;
+
+    // Look up a name through its resolved frame slot, if it has one
+    Value_Ptr lookup(const std::string& name,
+                     const std::optional<Frame_Slot>& slot) const
+    {
+        if (slot)
+            return frame->lookup(slot.value(), name);
+        return symbols.lookup(name);
+    }
 };
 
 struct Execution_Context
 {
     Symbol_Table& symbols;
 
+    // The running closure's frame, if any
+    Frame* frame = nullptr;
+
     Evaluation_Context as_eval() const
     {
-        return {.symbols = symbols};
+        return {.symbols = symbols, .frame = frame};
+    }
+
+    // Bind a name into its resolved frame slot, if it has one
+    void define(const std::string& name, const std::optional<Frame_Slot>& slot,
+                Value_Ptr value) const
+    {
+        if (slot)
+            frame->define(slot.value(), std::move(value), name);
+        else
+            symbols.define(name, std::move(value));
     }
 };
 
@@ -0,0 +1,118 @@
+#ifndef FROST_FRAME_HPP
+#define FROST_FRAME_HPP
+
+#include <frost/value.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+
+#include <fmt/format.h>
+
+namespace frst
+{
+
+//! @brief Resolved location of a name within a closure body
+//!
+//! Closures capture by value when they are created, so a running closure body
+//! only ever sees two regions: the values it captured, and its own locals
+//! (parameters, the self binding, and every definition in the body, including
+//! those in nested do-blocks and match arms).
+struct Frame_Slot
+{
+    enum class Region : std::uint8_t
+    {
+        Capture,
+        Local,
+    };
+
+    Region region;
+    std::uint32_t index;
+
+    friend bool operator==(const Frame_Slot&, const Frame_Slot&) = default;
+};
+
+//! @brief Flat, index-addressed storage for a single closure call
+class Frame
+{
+  public:
+    static constexpr std::size_t small_capacity = 8;
+
+    Frame(std::span<const Value_Ptr> captures, std::size_t local_count)
+        : captures_{captures}
+    {
+        if (local_count > small_capacity)
+        {
+            large_ = std::make_unique<Value_Ptr[]>(local_count);
+            locals_ = large_.get();
+        }
+        else
+        {
+            locals_ = small_.data();
+        }
+    }
+
+    Frame() = delete;
+    Frame(const Frame&) = delete;
+    Frame(Frame&&) = delete;
+    Frame& operator=(const Frame&) = delete;
+    Frame& operator=(Frame&&) = delete;
+    ~Frame() = default;
+
+    // Throws if the slot has not been bound yet
+    const Value_Ptr& lookup(Frame_Slot slot, std::string_view name) const
+    {
+        const auto& value = get(slot);
+        if (not value)
+            throw Frost_Unrecoverable_Error{
+                fmt::format("Symbol {} is not defined", name)};
+        return value;
+    }
+
+    // Empty if the slot has not been bound yet
+    const Value_Ptr& get(Frame_Slot slot) const
+    {
+        if (slot.region == Frame_Slot::Region::Capture)
+            return captures_[slot.index];
+        return locals_[slot.index];
+    }
+
+    // Bind a local slot, mirroring Symbol_Table::define
+    // Throws on redefinition error
+    void define(Frame_Slot slot, Value_Ptr value, std::string_view name)
+    {
+        if (slot.region != Frame_Slot::Region::Local)
+            THROW_UNREACHABLE;
+
+        auto& target = locals_[slot.index];
+        if (target)
+            throw Frost_Unrecoverable_Error{fmt::format(
+                "Cannot define {} as it is already defined", name)};
+        target = std::move(value);
+    }
+
+    // Bind a local slot without checking, for parameters
+    void set(std::uint32_t index, Value_Ptr value)
+    {
+        locals_[index] = std::move(value);
+    }
+
+    // Unbind a local slot, discarding a partial match
+    void reset(Frame_Slot slot)
+    {
+        if (slot.region == Frame_Slot::Region::Local)
+            locals_[slot.index].reset();
+    }
+
+  private:
+    std::span<const Value_Ptr> captures_;
+    std::array<Value_Ptr, small_capacity> small_{};
+    std::unique_ptr<Value_Ptr[]> large_;
+    Value_Ptr* locals_;
+};
+
+} // namespace frst
+
+#endif
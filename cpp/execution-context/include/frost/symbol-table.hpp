@@ -45,6 +45,11 @@ class Symbol_Table
 
     virtual void reserve(std::size_t size);
 
+    // A permanently empty table, standing in for the symbols of code whose
+    // names have all been resolved to frame slots ahead of time
+    // Defining into it is a bug
+    static Symbol_Table& sealed();
+
     bool empty() const;
     std::vector<std::string_view> names() const;
     std::vector<std::string_view> deep_names() const;
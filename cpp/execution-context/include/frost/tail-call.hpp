@@ -0,0 +1,48 @@
+#ifndef FROST_TAIL_CALL_HPP
+#define FROST_TAIL_CALL_HPP
+
+#include <frost/value.hpp>
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace frst
+{
+
+//! @brief A call made from tail position in a closure body
+//!
+//! Rather than making the call itself, the call site parks the callee and its
+//! arguments here, and produces an empty Value_Ptr in place of the result.
+//! The Closure::call running that body then takes it, and makes the call in
+//! place of its own, so a chain of tail calls runs in constant stack.
+struct Tail_Call
+{
+    Function callee;
+    std::vector<Value_Ptr> args;
+
+    // Park a call for the running closure to make
+    // Always produces an empty Value_Ptr, to be returned from the body as-is
+    static Value_Ptr defer(Function callee, std::vector<Value_Ptr> args)
+    {
+        pending().emplace(std::move(callee), std::move(args));
+        return nullptr;
+    }
+
+    // Take the call parked by the body that just returned, if any
+    static std::optional<Tail_Call> take()
+    {
+        return std::exchange(pending(), std::nullopt);
+    }
+
+  private:
+    static std::optional<Tail_Call>& pending()
+    {
+        static thread_local std::optional<Tail_Call> pending;
+        return pending;
+    }
+};
+
+} // namespace frst
+
+#endif
@@ -166,3 +166,29 @@ std::vector<std::string_view> Symbol_Table::deep_names() const
     }
     return result;
 }
+
+namespace frst
+{
+namespace
+{
+class Sealed_Symbol_Table final : public Symbol_Table
+{
+  public:
+    void define(const std::string&, Value_Ptr) final
+    {
+        THROW_UNREACHABLE;
+    }
+
+    void reserve(std::size_t) final
+    {
+        THROW_UNREACHABLE;
+    }
+};
+} // namespace
+
+Symbol_Table& Symbol_Table::sealed()
+{
+    static Sealed_Symbol_Table table;
+    return table;
+}
+} // namespace frst
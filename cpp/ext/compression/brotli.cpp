@@ -1,30 +1,167 @@
+#include "stream-codec.hpp"
+
 #include <frost/builtins-common.hpp>
 
 #include <brotli/decode.h>
 #include <brotli/encode.h>
 
 #include <array>
+#include <memory>
+#include <span>
 
 namespace frst::compression::brotli
 {
 
-BUILTIN(compress)
+namespace
 {
-    REQUIRE_ARGS("brotli.compress", TYPES(String),
-                 OPTIONAL(PARAM("quality", TYPES(Int))));
 
-    const auto& input = GET(0, String);
+int get_quality(std::string_view fn_name, builtin_args_t args)
+{
+    if (not HAS(1))
+        return BROTLI_DEFAULT_QUALITY;
+
+    auto quality = GET(1, Int);
+    if (quality < BROTLI_MIN_QUALITY || quality > BROTLI_MAX_QUALITY)
+        throw Frost_Recoverable_Error{
+            fmt::format("{}: quality must be between {} and {}", fn_name,
+                        BROTLI_MIN_QUALITY, BROTLI_MAX_QUALITY)};
+    return static_cast<int>(quality);
+}
+
+class Brotli_Encoder : public Encoder
+{
+  public:
+    Brotli_Encoder(std::string_view fn_name, int quality)
+        : fn_name_{fn_name}
+        , state_{BrotliEncoderCreateInstance(nullptr, nullptr, nullptr)}
+    {
+        if (not state_)
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: failed to create encoder", fn_name)};
+
+        BrotliEncoderSetParameter(state_, BROTLI_PARAM_QUALITY,
+                                  static_cast<uint32_t>(quality));
+    }
+
+    ~Brotli_Encoder() override
+    {
+        BrotliEncoderDestroyInstance(state_);
+    }
 
-    int quality = BROTLI_DEFAULT_QUALITY;
-    if (HAS(1))
+    void write(std::string_view in, std::string& out) override
+    {
+        run(in, BROTLI_OPERATION_PROCESS, out);
+    }
+
+    void flush(std::string& out) override
+    {
+        run({}, BROTLI_OPERATION_FLUSH, out);
+    }
+
+    void finish(std::string& out) override
+    {
+        run({}, BROTLI_OPERATION_FINISH, out);
+    }
+
+  private:
+    void run(std::string_view in, BrotliEncoderOperation op, std::string& out)
+    {
+        auto available_in = in.size();
+        auto* next_in = reinterpret_cast<const uint8_t*>(in.data());
+        std::array<uint8_t, 16384> buf;
+
+        do
+        {
+            auto available_out = buf.size();
+            auto* next_out = buf.data();
+
+            if (not BrotliEncoderCompressStream(state_, op, &available_in,
+                                                &next_in, &available_out,
+                                                &next_out, nullptr))
+            {
+                throw Frost_Recoverable_Error{
+                    fmt::format("{}: compression failed", fn_name_)};
+            }
+
+            out.append(reinterpret_cast<char*>(buf.data()),
+                       buf.size() - available_out);
+        } while (available_in > 0
+                 || BrotliEncoderHasMoreOutput(state_)
+                 || (op == BROTLI_OPERATION_FINISH
+                     && not BrotliEncoderIsFinished(state_)));
+    }
+
+    std::string_view fn_name_;
+    BrotliEncoderState* state_;
+};
+
+class Brotli_Decoder : public Decoder
+{
+  public:
+    explicit Brotli_Decoder(std::string_view fn_name)
+        : fn_name_{fn_name}
+        , state_{BrotliDecoderCreateInstance(nullptr, nullptr, nullptr)}
     {
-        quality = static_cast<int>(GET(1, Int));
-        if (quality < BROTLI_MIN_QUALITY || quality > BROTLI_MAX_QUALITY)
+        if (not state_)
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: failed to create decoder", fn_name)};
+    }
+
+    ~Brotli_Decoder() override
+    {
+        BrotliDecoderDestroyInstance(state_);
+    }
+
+    std::size_t decode(std::string_view& in, std::span<char> out,
+                       bool at_end) override
+    {
+        // As in decompress, anything after the end is ignored
+        if (ended_)
+        {
+            in = {};
+            return 0;
+        }
+
+        auto available_in = in.size();
+        auto* next_in = reinterpret_cast<const uint8_t*>(in.data());
+        auto available_out = out.size();
+        auto* next_out = reinterpret_cast<uint8_t*>(out.data());
+
+        auto result =
+            BrotliDecoderDecompressStream(state_, &available_in, &next_in,
+                                          &available_out, &next_out, nullptr);
+
+        if (result == BROTLI_DECODER_RESULT_ERROR)
             throw Frost_Recoverable_Error{fmt::format(
-                "brotli.compress: quality must be between {} and {}",
-                BROTLI_MIN_QUALITY, BROTLI_MAX_QUALITY)};
+                "{}: decompression failed ({})", fn_name_,
+                BrotliDecoderErrorString(BrotliDecoderGetErrorCode(state_)))};
+
+        ended_ = result == BROTLI_DECODER_RESULT_SUCCESS;
+        in.remove_prefix(in.size() - available_in);
+
+        auto produced = out.size() - available_out;
+        if (at_end && produced == 0 && not ended_)
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: truncated input", fn_name_)};
+        return produced;
     }
 
+  private:
+    std::string_view fn_name_;
+    bool ended_ = false;
+    BrotliDecoderState* state_;
+};
+
+} // namespace
+
+BUILTIN(compress)
+{
+    REQUIRE_ARGS("brotli.compress", TYPES(String),
+                 OPTIONAL(PARAM("quality", TYPES(Int))));
+
+    const auto& input = GET(0, String);
+    int quality = get_quality("brotli.compress", args);
+
     size_t output_size = BrotliEncoderMaxCompressedSize(input.size());
     if (output_size == 0)
         throw Frost_Recoverable_Error{"brotli.compress: input too large"};
@@ -93,4 +230,23 @@ BUILTIN(decompress)
     return Value::create(std::move(output));
 }
 
+BUILTIN(open_reader)
+{
+    REQUIRE_ARGS("brotli.open_reader", PARAM("source", TYPES(String, Map)));
+
+    return make_reader("brotli.open_reader", args.at(0),
+                       std::make_unique<Brotli_Decoder>("brotli.open_reader"));
+}
+
+BUILTIN(open_writer)
+{
+    REQUIRE_ARGS("brotli.open_writer", PARAM("target", TYPES(String, Map)),
+                 OPTIONAL(PARAM("quality", TYPES(Int))));
+
+    return make_writer(
+        "brotli.open_writer", args.at(0),
+        std::make_unique<Brotli_Encoder>(
+            "brotli.open_writer", get_quality("brotli.open_writer", args)));
+}
+
 } // namespace frst::compression::brotli
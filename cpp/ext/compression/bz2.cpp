@@ -1,28 +1,152 @@
+#include "stream-codec.hpp"
+
 #include <frost/builtins-common.hpp>
 
 #include <bzlib.h>
 
 #include <array>
+#include <memory>
+#include <span>
 
 namespace frst::compression::bz2
 {
 
-BUILTIN(compress)
+namespace
 {
-    REQUIRE_ARGS("bz2.compress", TYPES(String),
-                 OPTIONAL(PARAM("level", TYPES(Int))));
 
-    const auto& input = GET(0, String);
+int get_block_size(std::string_view fn_name, builtin_args_t args)
+{
+    if (not HAS(1))
+        return 9;
+
+    auto block_size = GET(1, Int);
+    if (block_size < 1 || block_size > 9)
+        throw Frost_Recoverable_Error{
+            fmt::format("{}: level must be between 1 and 9", fn_name)};
+    return static_cast<int>(block_size);
+}
+
+class Bz2_Encoder : public Encoder
+{
+  public:
+    Bz2_Encoder(std::string_view fn_name, int block_size)
+        : fn_name_{fn_name}
+    {
+        if (BZ2_bzCompressInit(&stream_, block_size, 0, 0) != BZ_OK)
+            throw Frost_Recoverable_Error{fmt::format(
+                "{}: failed to initialize compression stream", fn_name)};
+    }
+
+    ~Bz2_Encoder() override
+    {
+        BZ2_bzCompressEnd(&stream_);
+    }
+
+    void write(std::string_view in, std::string& out) override
+    {
+        run(in, BZ_RUN, BZ_RUN_OK, out);
+    }
+
+    void flush(std::string& out) override
+    {
+        run({}, BZ_FLUSH, BZ_RUN_OK, out);
+    }
+
+    void finish(std::string& out) override
+    {
+        run({}, BZ_FINISH, BZ_STREAM_END, out);
+    }
+
+  private:
+    // Running takes all of the input, and flushing or finishing goes on
+    // until bzip2 reports done_when
+    void run(std::string_view in, int action, int done_when, std::string& out)
+    {
+        stream_.next_in = const_cast<char*>(in.data());
+        stream_.avail_in = static_cast<unsigned int>(in.size());
+
+        std::array<char, 16384> buf;
+        int ret;
+        do
+        {
+            stream_.next_out = buf.data();
+            stream_.avail_out = static_cast<unsigned int>(buf.size());
+
+            ret = BZ2_bzCompress(&stream_, action);
+            if (ret < 0)
+                throw Frost_Recoverable_Error{fmt::format(
+                    "{}: compression failed (error {})", fn_name_, ret)};
+
+            out.append(buf.data(), buf.size() - stream_.avail_out);
+        } while (action == BZ_RUN ? stream_.avail_in > 0 : ret != done_when);
+    }
+
+    std::string_view fn_name_;
+    bz_stream stream_{};
+};
 
-    int block_size = 9;
-    if (HAS(1))
+class Bz2_Decoder : public Decoder
+{
+  public:
+    explicit Bz2_Decoder(std::string_view fn_name)
+        : fn_name_{fn_name}
+    {
+        if (BZ2_bzDecompressInit(&stream_, 0, 0) != BZ_OK)
+            throw Frost_Recoverable_Error{fmt::format(
+                "{}: failed to initialize decompression stream", fn_name)};
+    }
+
+    ~Bz2_Decoder() override
     {
-        block_size = static_cast<int>(GET(1, Int));
-        if (block_size < 1 || block_size > 9)
+        BZ2_bzDecompressEnd(&stream_);
+    }
+
+    std::size_t decode(std::string_view& in, std::span<char> out,
+                       bool at_end) override
+    {
+        // As in decompress, anything after the end is ignored
+        if (ended_)
+        {
+            in = {};
+            return 0;
+        }
+
+        stream_.next_in = const_cast<char*>(in.data());
+        stream_.avail_in = static_cast<unsigned int>(in.size());
+        stream_.next_out = out.data();
+        stream_.avail_out = static_cast<unsigned int>(out.size());
+
+        int ret = BZ2_bzDecompress(&stream_);
+        if (ret != BZ_OK && ret != BZ_STREAM_END)
+            throw Frost_Recoverable_Error{fmt::format(
+                "{}: decompression failed (error {})", fn_name_, ret)};
+
+        ended_ = ret == BZ_STREAM_END;
+        in.remove_prefix(in.size() - stream_.avail_in);
+
+        auto produced = out.size() - stream_.avail_out;
+        if (at_end && produced == 0 && not ended_)
             throw Frost_Recoverable_Error{
-                "bz2.compress: level must be between 1 and 9"};
+                fmt::format("{}: truncated input", fn_name_)};
+        return produced;
     }
 
+  private:
+    std::string_view fn_name_;
+    bool ended_ = false;
+    bz_stream stream_{};
+};
+
+} // namespace
+
+BUILTIN(compress)
+{
+    REQUIRE_ARGS("bz2.compress", TYPES(String),
+                 OPTIONAL(PARAM("level", TYPES(Int))));
+
+    const auto& input = GET(0, String);
+    int block_size = get_block_size("bz2.compress", args);
+
     // bz2 worst case: input size + 1% + 600 bytes
     // (round up to cover truncation)
     auto output_size = static_cast<unsigned int>(
@@ -80,4 +204,23 @@ BUILTIN(decompress)
     return Value::create(std::move(output));
 }
 
+BUILTIN(open_reader)
+{
+    REQUIRE_ARGS("bz2.open_reader", PARAM("source", TYPES(String, Map)));
+
+    return make_reader("bz2.open_reader", args.at(0),
+                       std::make_unique<Bz2_Decoder>("bz2.open_reader"));
+}
+
+BUILTIN(open_writer)
+{
+    REQUIRE_ARGS("bz2.open_writer", PARAM("target", TYPES(String, Map)),
+                 OPTIONAL(PARAM("level", TYPES(Int))));
+
+    return make_writer(
+        "bz2.open_writer", args.at(0),
+        std::make_unique<Bz2_Encoder>(
+            "bz2.open_writer", get_block_size("bz2.open_writer", args)));
+}
+
 } // namespace frst::compression::bz2
@@ -0,0 +1,58 @@
+#include "compress-options.hpp"
+
+#include <frost/builtins-common.hpp>
+
+namespace frst::compression
+{
+
+Compress_Options compress_options(std::string_view fn_name,
+                                  builtin_args_t args)
+{
+    Compress_Options result;
+
+    if (not HAS(1))
+        return result;
+
+    if (args.at(1)->is<Int>())
+    {
+        result.level = GET(1, Int);
+        return result;
+    }
+
+    for (const auto& [k_val, v_val] : GET(1, Map))
+    {
+        if (not k_val->is<String>())
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: option keys must be Strings, got {}", fn_name,
+                            k_val->type_name())};
+
+        const auto& key = k_val->raw_get<String>();
+
+        if (key == "level")
+        {
+            if (not v_val->is<Int>())
+                throw Frost_Recoverable_Error{
+                    fmt::format("{}: level option must be an Int", fn_name)};
+            result.level = v_val->raw_get<Int>();
+        }
+        else if (key == "threads")
+        {
+            if (not v_val->is<Int>())
+                throw Frost_Recoverable_Error{
+                    fmt::format("{}: threads option must be an Int", fn_name)};
+            result.threads = v_val->raw_get<Int>();
+            if (result.threads < 1)
+                throw Frost_Recoverable_Error{
+                    fmt::format("{}: threads must be at least 1", fn_name)};
+        }
+        else
+        {
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: unknown option '{}'", fn_name, key)};
+        }
+    }
+
+    return result;
+}
+
+} // namespace frst::compression
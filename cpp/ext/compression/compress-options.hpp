@@ -0,0 +1,26 @@
+#ifndef FROST_COMPRESSION_COMPRESS_OPTIONS_HPP
+#define FROST_COMPRESSION_COMPRESS_OPTIONS_HPP
+
+#include <frost/builtin.hpp>
+#include <frost/value.hpp>
+
+#include <optional>
+#include <string_view>
+
+namespace frst::compression
+{
+
+// What the optional second argument to compress asks for. It is either a
+// level on its own, or a Map with any of level and threads.
+struct Compress_Options
+{
+    std::optional<Int> level;
+    Int threads = 1;
+};
+
+Compress_Options compress_options(std::string_view fn_name,
+                                  builtin_args_t args);
+
+} // namespace frst::compression
+
+#endif
@@ -31,7 +31,7 @@
 #endif
 
 #ifdef FROST_HAVE_SNAPPY
-#define X_SNAPPY_ALGOS X(snappy)
+#define X_SNAPPY_ALGOS Y(snappy)
 #else
 #define X_SNAPPY_ALGOS
 #endif
@@ -42,6 +42,8 @@
 #define X_ZSTD_ALGOS
 #endif
 
+// X(algo) is a codec that can also stream; Y(algo) is one that can only
+// compress and decompress whole strings
 #define X_COMPRESSION_ALGOS                                                    \
     X_ZLIB_ALGOS X_BZ2_ALGOS X_XZ_ALGOS X_LZ4_ALGOS X_BROTLI_ALGOS             \
         X_SNAPPY_ALGOS X_ZSTD_ALGOS
@@ -51,26 +53,45 @@ namespace frst
 namespace compression
 {
 
-#define X(algo)                                                                \
+#define Y(algo)                                                                \
     namespace algo                                                             \
     {                                                                          \
     BUILTIN(compress);                                                         \
     BUILTIN(decompress);                                                       \
     }
 
+#define X(algo)                                                                \
+    Y(algo)                                                                    \
+    namespace algo                                                             \
+    {                                                                          \
+    BUILTIN(open_reader);                                                      \
+    BUILTIN(open_writer);                                                      \
+    }
+
 X_COMPRESSION_ALGOS
 
 #undef X
+#undef Y
 } // namespace compression
 
+#define Y(algo)                                                                \
+    {Value::create(String{#algo}),                                             \
+     Value::create(Value::trusted, Map{                                        \
+                                       NS_ENTRY(algo, compress),               \
+                                       NS_ENTRY(algo, decompress),             \
+                                   })},
+
 #define X(algo)                                                                \
     {Value::create(String{#algo}),                                             \
      Value::create(Value::trusted, Map{                                        \
                                        NS_ENTRY(algo, compress),               \
                                        NS_ENTRY(algo, decompress),             \
+                                       NS_ENTRY(algo, open_reader),            \
+                                       NS_ENTRY(algo, open_writer),            \
                                    })},
 
 REGISTER_EXTENSION(compression, X_COMPRESSION_ALGOS);
 
 #undef X
+#undef Y
 } // namespace frst
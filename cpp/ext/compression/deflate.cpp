@@ -17,4 +17,14 @@ BUILTIN(decompress)
     return zlib_common::decompress("deflate.decompress", args, -MAX_WBITS);
 }
 
+BUILTIN(open_reader)
+{
+    return zlib_common::open_reader("deflate.open_reader", args, -MAX_WBITS);
+}
+
+BUILTIN(open_writer)
+{
+    return zlib_common::open_writer("deflate.open_writer", args, -MAX_WBITS);
+}
+
 } // namespace frst::compression::deflate
@@ -18,4 +18,15 @@ BUILTIN(decompress)
                                    true);
 }
 
+BUILTIN(open_reader)
+{
+    return zlib_common::open_reader("gzip.open_reader", args, MAX_WBITS + 16,
+                                    true);
+}
+
+BUILTIN(open_writer)
+{
+    return zlib_common::open_writer("gzip.open_writer", args, MAX_WBITS + 16);
+}
+
 } // namespace frst::compression::gzip
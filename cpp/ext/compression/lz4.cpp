@@ -1,12 +1,174 @@
+#include "stream-codec.hpp"
+
 #include <frost/builtins-common.hpp>
 
 #include <lz4frame.h>
 
 #include <array>
+#include <memory>
+#include <span>
 
 namespace frst::compression::lz4
 {
 
+namespace
+{
+
+int get_level(std::string_view fn_name, builtin_args_t args)
+{
+    if (not HAS(1))
+        return 0;
+
+    auto level = static_cast<int>(GET(1, Int));
+    if (level > LZ4F_compressionLevel_max())
+        throw Frost_Recoverable_Error{
+            fmt::format("{}: level must be at most {}", fn_name,
+                        LZ4F_compressionLevel_max())};
+    return level;
+}
+
+class Lz4_Encoder : public Encoder
+{
+  public:
+    Lz4_Encoder(std::string_view fn_name, int level)
+        : fn_name_{fn_name}
+    {
+        prefs_.compressionLevel = level;
+        if (LZ4F_isError(
+                LZ4F_createCompressionContext(&cctx_, LZ4F_VERSION)))
+        {
+            throw Frost_Recoverable_Error{fmt::format(
+                "{}: failed to create compression context", fn_name)};
+        }
+    }
+
+    ~Lz4_Encoder() override
+    {
+        LZ4F_freeCompressionContext(cctx_);
+    }
+
+    void write(std::string_view in, std::string& out) override
+    {
+        begin(out);
+        if (in.empty())
+            return;
+
+        append(out, LZ4F_compressBound(in.size(), &prefs_),
+               [&](char* dst, size_t capacity) {
+                   return LZ4F_compressUpdate(cctx_, dst, capacity, in.data(),
+                                              in.size(), nullptr);
+               });
+    }
+
+    void flush(std::string& out) override
+    {
+        begin(out);
+        append(out, LZ4F_compressBound(0, &prefs_),
+               [&](char* dst, size_t capacity) {
+                   return LZ4F_flush(cctx_, dst, capacity, nullptr);
+               });
+    }
+
+    void finish(std::string& out) override
+    {
+        begin(out);
+        append(out, LZ4F_compressBound(0, &prefs_),
+               [&](char* dst, size_t capacity) {
+                   return LZ4F_compressEnd(cctx_, dst, capacity, nullptr);
+               });
+    }
+
+  private:
+    // The frame header goes out with the first output of any kind
+    void begin(std::string& out)
+    {
+        if (started_)
+            return;
+        started_ = true;
+
+        append(out, LZ4F_HEADER_SIZE_MAX, [&](char* dst, size_t capacity) {
+            return LZ4F_compressBegin(cctx_, dst, capacity, &prefs_);
+        });
+    }
+
+    // Makes room for up to bound bytes on the end of out, for lz4 to fill
+    void append(std::string& out, size_t bound, auto&& compress)
+    {
+        auto old_size = out.size();
+        out.resize(old_size + bound);
+
+        size_t written = compress(out.data() + old_size, bound);
+        if (LZ4F_isError(written))
+        {
+            out.resize(old_size);
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: compression failed ({})", fn_name_,
+                            LZ4F_getErrorName(written))};
+        }
+        out.resize(old_size + written);
+    }
+
+    std::string_view fn_name_;
+    LZ4F_preferences_t prefs_{};
+    LZ4F_cctx* cctx_ = nullptr;
+    bool started_ = false;
+};
+
+class Lz4_Decoder : public Decoder
+{
+  public:
+    explicit Lz4_Decoder(std::string_view fn_name)
+        : fn_name_{fn_name}
+    {
+        if (LZ4F_isError(
+                LZ4F_createDecompressionContext(&dctx_, LZ4F_VERSION)))
+        {
+            throw Frost_Recoverable_Error{fmt::format(
+                "{}: failed to create decompression context", fn_name)};
+        }
+    }
+
+    ~Lz4_Decoder() override
+    {
+        LZ4F_freeDecompressionContext(dctx_);
+    }
+
+    // Concatenated frames are decoded one after another, as in decompress
+    std::size_t decode(std::string_view& in, std::span<char> out,
+                       bool at_end) override
+    {
+        size_t produced = out.size();
+        size_t consumed = in.size();
+
+        size_t ret = LZ4F_decompress(dctx_, out.data(), &produced, in.data(),
+                                     &consumed, nullptr);
+        if (LZ4F_isError(ret))
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: decompression failed ({})", fn_name_,
+                            LZ4F_getErrorName(ret))};
+
+        in.remove_prefix(consumed);
+
+        // 0 means that a frame has just been decoded and flushed in full.
+        // Past that, the context waits for the next frame, so a call that
+        // does nothing says nothing about where the input ended.
+        if (consumed > 0 || produced > 0)
+            frame_done_ = ret == 0;
+
+        if (at_end && produced == 0 && not frame_done_)
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: truncated input", fn_name_)};
+        return produced;
+    }
+
+  private:
+    std::string_view fn_name_;
+    bool frame_done_ = false;
+    LZ4F_dctx* dctx_ = nullptr;
+};
+
+} // namespace
+
 BUILTIN(compress)
 {
     REQUIRE_ARGS("lz4.compress", TYPES(String),
@@ -16,15 +178,7 @@ BUILTIN(compress)
 
     LZ4F_preferences_t prefs{};
     prefs.frameInfo.contentSize = input.size();
-
-    if (HAS(1))
-    {
-        prefs.compressionLevel = static_cast<int>(GET(1, Int));
-        if (prefs.compressionLevel > LZ4F_compressionLevel_max())
-            throw Frost_Recoverable_Error{
-                fmt::format("lz4.compress: level must be at most {}",
-                            LZ4F_compressionLevel_max())};
-    }
+    prefs.compressionLevel = get_level("lz4.compress", args);
 
     size_t bound = LZ4F_compressFrameBound(input.size(), &prefs);
     std::string output(bound, '\0');
@@ -84,4 +238,23 @@ BUILTIN(decompress)
     return Value::create(std::move(output));
 }
 
+BUILTIN(open_reader)
+{
+    REQUIRE_ARGS("lz4.open_reader", PARAM("source", TYPES(String, Map)));
+
+    return make_reader("lz4.open_reader", args.at(0),
+                       std::make_unique<Lz4_Decoder>("lz4.open_reader"));
+}
+
+BUILTIN(open_writer)
+{
+    REQUIRE_ARGS("lz4.open_writer", PARAM("target", TYPES(String, Map)),
+                 OPTIONAL(PARAM("level", TYPES(Int))));
+
+    return make_writer(
+        "lz4.open_writer", args.at(0),
+        std::make_unique<Lz4_Encoder>("lz4.open_writer",
+                                      get_level("lz4.open_writer", args)));
+}
+
 } // namespace frst::compression::lz4
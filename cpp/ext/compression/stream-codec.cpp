@@ -0,0 +1,384 @@
+#include "stream-codec.hpp"
+
+#include <frost/builtins-common.hpp>
+#include <frost/streams.hpp>
+
+#include <array>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+
+namespace frst::compression
+{
+
+using namespace streams_detail;
+
+STRINGS(read_line, read_one, read_rest, read_some, eof, write, writeln, flush,
+        close, is_open);
+
+namespace
+{
+
+// How much is read from a source at a time, how much decompressed data a
+// reader holds at a time, and how much compressed data a writer collects
+// before passing it on
+constexpr std::size_t chunk_size = 64 * 1024;
+
+// The named method of an io reader or writer
+Function stream_method(std::string_view fn_name, std::string_view param,
+                       const Map& stream, const Value_Ptr& method)
+{
+    auto it = stream.find(method);
+    if (it == stream.end() || not it->second->is<Function>())
+        throw Frost_Recoverable_Error{
+            fmt::format("{}: {} must have a {} method", fn_name, param,
+                        method->raw_get<String>())};
+    return it->second->raw_get<Function>();
+}
+
+// Compressed input, a chunk at a time. An empty chunk is the end.
+using Source = std::function<std::string()>;
+
+Source open_source(std::string_view fn_name, const Value_Ptr& source)
+{
+    if (source->is<String>())
+    {
+        const auto& path = source->raw_get<String>();
+        auto file = std::make_shared<std::ifstream>(path, std::ios::binary);
+        if (not file->is_open())
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: failed to open file: {}", fn_name, path)};
+
+        return [file] {
+            std::string chunk(chunk_size, '\0');
+            file->read(chunk.data(), chunk.size());
+            chunk.resize(static_cast<std::size_t>(file->gcount()));
+            return chunk;
+        };
+    }
+
+    auto read_some = stream_method(fn_name, "source", source->raw_get<Map>(),
+                                   strings.read_some);
+    return [fn_name, read_some] {
+        auto got = read_some->call({Value::create(Int{chunk_size})});
+        if (not got->is<String>())
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: read_some must return a String, got {}",
+                            fn_name, got->type_name())};
+        return got->raw_get<String>();
+    };
+}
+
+// Where compressed output goes
+struct Sink
+{
+    std::function<void(std::string_view)> write;
+    std::function<void()> flush;
+    std::function<void()> close;
+};
+
+Sink open_sink(std::string_view fn_name, const Value_Ptr& target)
+{
+    if (target->is<String>())
+    {
+        const auto& path = target->raw_get<String>();
+        auto file = std::make_shared<std::ofstream>(
+            path, std::ios::binary | std::ios::trunc);
+        if (not file->is_open())
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: failed to open file: {}", fn_name, path)};
+
+        return {
+            .write =
+                [fn_name, file](std::string_view data) {
+                    if (not file->write(data.data(), data.size()))
+                        throw Frost_Recoverable_Error{fmt::format(
+                            "{}: failed to write to file", fn_name)};
+                },
+            .flush = [file] { file->flush(); },
+            .close = [file] { file->close(); },
+        };
+    }
+
+    const auto& methods = target->raw_get<Map>();
+    auto write = stream_method(fn_name, "target", methods, strings.write);
+
+    // The writer belongs to the caller, so it is flushed along with this one
+    // but never closed
+    Function flush;
+    if (auto it = methods.find(strings.flush);
+        it != methods.end() && it->second->is<Function>())
+    {
+        flush = it->second->raw_get<Function>();
+    }
+
+    return {
+        .write =
+            [write](std::string_view data) {
+                (void)write->call({Value::create(String{data})});
+            },
+        .flush =
+            [flush] {
+                if (flush)
+                    (void)flush->call({});
+            },
+        .close = [] {},
+    };
+}
+
+class Decompressing_Buf : public std::streambuf
+{
+  public:
+    Decompressing_Buf(std::string_view fn_name,
+                      std::unique_ptr<Decoder> decoder, Source source)
+        : fn_name_{fn_name}
+        , decoder_{std::move(decoder)}
+        , source_{std::move(source)}
+    {
+    }
+
+    void close()
+    {
+        decoder_.reset();
+        source_ = nullptr;
+        setg(nullptr, nullptr, nullptr);
+    }
+
+    bool is_open() const
+    {
+        return decoder_ != nullptr;
+    }
+
+  protected:
+    int_type underflow() override
+    {
+        if (not decoder_)
+            return traits_type::eof();
+
+        for (;;)
+        {
+            if (pending_.empty() && not source_done_)
+            {
+                input_ = source_();
+                pending_ = input_;
+                source_done_ = input_.empty();
+            }
+
+            auto before = pending_.size();
+            auto produced = decoder_->decode(pending_, buffer_, source_done_);
+            if (produced > 0)
+            {
+                setg(buffer_.data(), buffer_.data(), buffer_.data() + produced);
+                return traits_type::to_int_type(buffer_[0]);
+            }
+
+            if (pending_.size() == before)
+            {
+                if (not source_done_)
+                    throw Frost_Recoverable_Error{fmt::format(
+                        "{}: decompression made no progress", fn_name_)};
+                return traits_type::eof();
+            }
+        }
+    }
+
+  private:
+    std::string_view fn_name_;
+    std::unique_ptr<Decoder> decoder_;
+    Source source_;
+    bool source_done_ = false;
+    std::string input_;
+    std::string_view pending_;
+    std::array<char, chunk_size> buffer_;
+};
+
+class Decompressing_Stream : public std::istream
+{
+  public:
+    Decompressing_Stream(std::string_view fn_name,
+                         std::unique_ptr<Decoder> decoder, Source source)
+        : std::istream{nullptr}
+        , buf_{fn_name, std::move(decoder), std::move(source)}
+    {
+        rdbuf(&buf_);
+        // Otherwise a decompression error would only show as a failed read
+        exceptions(std::ios::badbit);
+    }
+
+    void close()
+    {
+        buf_.close();
+    }
+
+    bool is_open() const
+    {
+        return buf_.is_open();
+    }
+
+  private:
+    Decompressing_Buf buf_;
+};
+
+class Compressing_Buf : public std::streambuf
+{
+  public:
+    Compressing_Buf(std::string_view fn_name, std::unique_ptr<Encoder> encoder,
+                    Sink sink)
+        : fn_name_{fn_name}
+        , encoder_{std::move(encoder)}
+        , sink_{std::move(sink)}
+    {
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+    }
+
+    // A writer dropped without being closed is still closed, but any error
+    // in doing so can only be seen by closing it explicitly
+    ~Compressing_Buf() override
+    {
+        try
+        {
+            close();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void close()
+    {
+        if (not encoder_)
+            return;
+
+        // Taken first, so that a failure here is never retried
+        auto encoder = std::move(encoder_);
+        std::string_view rest{pbase(), pptr()};
+        setp(nullptr, nullptr);
+
+        encoder->write(rest, out_);
+        encoder->finish(out_);
+        send();
+        sink_.close();
+    }
+
+    bool is_open() const
+    {
+        return encoder_ != nullptr;
+    }
+
+  protected:
+    int_type overflow(int_type ch) override
+    {
+        if (not encoder_)
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: writer is closed", fn_name_)};
+
+        compress_pending();
+        if (not traits_type::eq_int_type(ch, traits_type::eof()))
+        {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override
+    {
+        if (not encoder_)
+            return 0;
+
+        compress_pending();
+        encoder_->flush(out_);
+        send();
+        sink_.flush();
+        return 0;
+    }
+
+  private:
+    void compress_pending()
+    {
+        encoder_->write({pbase(), pptr()}, out_);
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+        if (out_.size() >= chunk_size)
+            send();
+    }
+
+    void send()
+    {
+        if (out_.empty())
+            return;
+        sink_.write(out_);
+        out_.clear();
+    }
+
+    std::string_view fn_name_;
+    std::unique_ptr<Encoder> encoder_;
+    Sink sink_;
+    std::string out_;
+    std::array<char, chunk_size> buffer_;
+};
+
+class Compressing_Stream : public std::ostream
+{
+  public:
+    Compressing_Stream(std::string_view fn_name,
+                       std::unique_ptr<Encoder> encoder, Sink sink)
+        : std::ostream{nullptr}
+        , buf_{fn_name, std::move(encoder), std::move(sink)}
+    {
+        rdbuf(&buf_);
+        exceptions(std::ios::badbit);
+    }
+
+    void close()
+    {
+        buf_.close();
+    }
+
+    bool is_open() const
+    {
+        return buf_.is_open();
+    }
+
+  private:
+    Compressing_Buf buf_;
+};
+
+} // namespace
+
+Value_Ptr make_reader(std::string_view fn_name, const Value_Ptr& source,
+                      std::unique_ptr<Decoder> decoder)
+{
+    auto ls = std::make_shared<Locked_Stream<Decompressing_Stream>>();
+    ls->stream = std::make_shared<Decompressing_Stream>(
+        fn_name, std::move(decoder), open_source(fn_name, source));
+
+    return Value::create(Value::trusted, Map{
+                                             {strings.read_line, read_line(ls)},
+                                             {strings.read_one, read_one(ls)},
+                                             {strings.read_rest, read_rest(ls)},
+                                             {strings.read_some, read_some(ls)},
+                                             {strings.eof, eof(ls)},
+                                             {strings.close, close(ls)},
+                                             {strings.is_open, is_open(ls)},
+                                         });
+}
+
+Value_Ptr make_writer(std::string_view fn_name, const Value_Ptr& target,
+                      std::unique_ptr<Encoder> encoder)
+{
+    auto ls = std::make_shared<Locked_Stream<Compressing_Stream>>();
+    ls->stream = std::make_shared<Compressing_Stream>(
+        fn_name, std::move(encoder), open_sink(fn_name, target));
+
+    return Value::create(Value::trusted, Map{
+                                             {strings.write, write(ls)},
+                                             {strings.writeln, writeln(ls)},
+                                             {strings.flush, flush(ls)},
+                                             {strings.close, close(ls)},
+                                             {strings.is_open, is_open(ls)},
+                                         });
+}
+
+} // namespace frst::compression
@@ -0,0 +1,59 @@
+#ifndef FROST_COMPRESSION_STREAM_CODEC_HPP
+#define FROST_COMPRESSION_STREAM_CODEC_HPP
+
+#include <frost/value.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace frst::compression
+{
+
+//! @brief The decompressing half of a streaming codec
+class Decoder
+{
+  public:
+    virtual ~Decoder() = default;
+
+    // Decodes what it can of in into out, advancing in past the input it
+    // used, and returns how much of out it filled. at_end means that no
+    // input will follow in; from then on, returning 0 means that the data
+    // is fully decoded, and input that was cut short is an error.
+    virtual std::size_t decode(std::string_view& in, std::span<char> out,
+                               bool at_end) = 0;
+};
+
+//! @brief The compressing half of a streaming codec
+class Encoder
+{
+  public:
+    virtual ~Encoder() = default;
+
+    // Compresses all of in, appending whatever output is ready to out
+    virtual void write(std::string_view in, std::string& out) = 0;
+
+    // Appends everything needed to decode what was written so far, without
+    // ending the compressed stream
+    virtual void flush(std::string& out) = 0;
+
+    // Appends the rest of the compressed stream
+    virtual void finish(std::string& out) = 0;
+};
+
+// An io reader that decompresses source as it is read. source is either a
+// path to open, or an io reader with a read_some method.
+Value_Ptr make_reader(std::string_view fn_name, const Value_Ptr& source,
+                      std::unique_ptr<Decoder> decoder);
+
+// An io writer that compresses into target as it is written. target is
+// either a path to create or truncate, or an io writer with a write method.
+// The compressed stream is only complete once the writer is closed.
+Value_Ptr make_writer(std::string_view fn_name, const Value_Ptr& target,
+                      std::unique_ptr<Encoder> encoder);
+
+} // namespace frst::compression
+
+#endif
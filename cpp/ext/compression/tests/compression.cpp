@@ -1,9 +1,14 @@
 #include <catch2/catch_all.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 
+#include <frost/builtins-common.hpp>
 #include <frost/extensions-common.hpp>
 #include <frost/value.hpp>
 
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
 using namespace frst;
 using namespace std::literals;
 using Catch::Matchers::ContainsSubstring;
@@ -81,6 +86,96 @@ constexpr std::string_view all_algos[] = {
 #endif
 };
 
+// Every algorithm but snappy, whose format cannot be streamed
+constexpr std::string_view streaming_algos[] = {
+#ifdef FROST_HAVE_ZLIB
+    "deflate", "gzip", "zlib",
+#endif
+#ifdef FROST_HAVE_BZ2
+    "bz2",
+#endif
+#ifdef FROST_HAVE_XZ
+    "xz",
+#endif
+#ifdef FROST_HAVE_LZ4
+    "lz4",
+#endif
+#ifdef FROST_HAVE_BROTLI
+    "brotli",
+#endif
+#ifdef FROST_HAVE_ZSTD
+    "zstd",
+#endif
+};
+
+Value_Ptr call_method(const Value_Ptr& stream, const std::string& name,
+                      std::vector<Value_Ptr> args = {})
+{
+    REQUIRE(stream->is<Map>());
+    return lookup_fn(stream->raw_get<Map>(), name)->call(args);
+}
+
+// A writer that collects everything written to it
+Value_Ptr collecting_writer(std::shared_ptr<std::string> out)
+{
+    return Value::create(
+        Value::trusted,
+        Map{
+            {Value::create("write"s),
+             system_closure([out](builtin_args_t args) {
+                 *out += args.at(0)->raw_get<String>();
+                 return Value::null();
+             })},
+        });
+}
+
+// A reader that hands out data in pieces of at most step characters
+Value_Ptr chunked_reader(std::string data, std::size_t step)
+{
+    auto pos = std::make_shared<std::size_t>(0);
+    return Value::create(
+        Value::trusted,
+        Map{
+            {Value::create("read_some"s),
+             system_closure([data = std::move(data), step,
+                             pos](builtin_args_t args) {
+                 auto max =
+                     static_cast<std::size_t>(args.at(0)->raw_get<Int>());
+                 auto chunk = data.substr(*pos, std::min(step, max));
+                 *pos += chunk.size();
+                 return Value::create(String{std::move(chunk)});
+             })},
+        });
+}
+
+std::filesystem::path make_test_dir(std::string_view test_name)
+{
+    auto dir = std::filesystem::path{"./build/compression"} / test_name;
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+// The algorithms whose compress takes an options Map
+constexpr std::string_view threaded_algos[] = {
+#ifdef FROST_HAVE_ZLIB
+    "deflate", "gzip", "zlib",
+#endif
+#ifdef FROST_HAVE_XZ
+    "xz",
+#endif
+#ifdef FROST_HAVE_ZSTD
+    "zstd",
+#endif
+};
+
+Value_Ptr options(std::initializer_list<std::pair<std::string, Value_Ptr>> kv)
+{
+    Map map;
+    for (const auto& [k, v] : kv)
+        map.emplace(Value::create(String{k}), v);
+    return Value::create(Value::trusted, std::move(map));
+}
+
 #ifdef FROST_HAVE_ZLIB
 constexpr std::string_view zlib_algos[] = {"deflate", "gzip", "zlib"};
 #endif
@@ -272,6 +367,379 @@ TEST_CASE("ext::compression: corrupt input")
     }
 }
 
+// =============================================================================
+// Streaming (all algorithms but snappy)
+// =============================================================================
+
+TEST_CASE("ext::compression: streaming round-trip")
+{
+    auto mod = compression_module();
+
+    std::string expected;
+    for (int i = 0; i < 20000; ++i)
+        expected += "line " + std::to_string(i) + "\n";
+
+    for (auto name : streaming_algos)
+    {
+        DYNAMIC_SECTION(name)
+        {
+            auto algo = lookup_algo(mod, std::string{name});
+            auto open_reader = lookup_fn(algo, "open_reader");
+            auto open_writer = lookup_fn(algo, "open_writer");
+            auto decompress = lookup_fn(algo, "decompress");
+
+            auto out = std::make_shared<std::string>();
+            auto writer = call1(open_writer, collecting_writer(out));
+            for (int i = 0; i < 20000; ++i)
+            {
+                call_method(writer, "writeln",
+                            {Value::create("line " + std::to_string(i))});
+            }
+            CHECK(call_method(writer, "is_open")->raw_get<Bool>());
+            call_method(writer, "close");
+            CHECK(call_method(writer, "is_open")->raw_get<Bool>() == false);
+
+            SECTION("decompress reads what the writer wrote")
+            {
+                CHECK(call1(decompress, Value::create(String{*out}))
+                          ->raw_get<String>()
+                      == expected);
+            }
+
+            SECTION("the reader takes input a little at a time")
+            {
+                auto reader = call1(open_reader, chunked_reader(*out, 7));
+                CHECK(call_method(reader, "read_line")->raw_get<String>()
+                      == "line 0");
+                CHECK(call_method(reader, "read_line")->raw_get<String>()
+                      == "line 1");
+                CHECK(call_method(reader, "read_rest")->raw_get<String>()
+                      == expected.substr("line 0\nline 1\n"s.size()));
+                CHECK(call_method(reader, "read_one")->is<Null>());
+                CHECK(call_method(reader, "eof")->raw_get<Bool>());
+            }
+
+            SECTION("read_some hands out the decompressed data")
+            {
+                auto reader = call1(open_reader, chunked_reader(*out, 4096));
+                std::string got;
+                for (;;)
+                {
+                    auto chunk = call_method(reader, "read_some",
+                                             {Value::create(1000_f)})
+                                     ->raw_get<String>();
+                    if (chunk.empty())
+                        break;
+                    CHECK(chunk.size() <= 1000);
+                    got += chunk;
+                }
+                CHECK(got == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("ext::compression: streaming reads what compress wrote")
+{
+    auto mod = compression_module();
+
+    for (auto name : streaming_algos)
+    {
+        DYNAMIC_SECTION(name)
+        {
+            auto algo = lookup_algo(mod, std::string{name});
+            auto compress = lookup_fn(algo, "compress");
+            auto open_reader = lookup_fn(algo, "open_reader");
+
+            auto compressed = call1(compress, Value::create("a\nb\nc"s));
+            auto reader = call1(
+                open_reader,
+                chunked_reader(compressed->raw_get<String>(), 3));
+            CHECK(call_method(reader, "read_rest")->raw_get<String>()
+                  == "a\nb\nc");
+
+            auto empty = call1(compress, Value::create(""s));
+            reader = call1(open_reader,
+                           chunked_reader(empty->raw_get<String>(), 3));
+            CHECK(call_method(reader, "read_rest")->raw_get<String>()
+                  == "");
+        }
+    }
+}
+
+TEST_CASE("ext::compression: streaming flush makes data readable")
+{
+    auto mod = compression_module();
+
+    for (auto name : streaming_algos)
+    {
+        DYNAMIC_SECTION(name)
+        {
+            auto algo = lookup_algo(mod, std::string{name});
+            auto open_reader = lookup_fn(algo, "open_reader");
+            auto open_writer = lookup_fn(algo, "open_writer");
+
+            auto out = std::make_shared<std::string>();
+            auto writer = call1(open_writer, collecting_writer(out));
+            call_method(writer, "writeln", {Value::create("first"s)});
+            call_method(writer, "flush");
+
+            auto reader = call1(open_reader, chunked_reader(*out, 5));
+            CHECK(call_method(reader, "read_line")->raw_get<String>()
+                  == "first");
+
+            call_method(writer, "close");
+        }
+    }
+}
+
+TEST_CASE("ext::compression: streaming through a file")
+{
+    auto mod = compression_module();
+    auto dir = make_test_dir("streaming_file");
+
+    for (auto name : streaming_algos)
+    {
+        DYNAMIC_SECTION(name)
+        {
+            auto algo = lookup_algo(mod, std::string{name});
+            auto open_reader = lookup_fn(algo, "open_reader");
+            auto open_writer = lookup_fn(algo, "open_writer");
+            auto decompress = lookup_fn(algo, "decompress");
+
+            auto path = dir / (std::string{name} + ".log");
+            auto path_value = Value::create(String{path.string()});
+
+            auto writer = call1(open_writer, path_value);
+            for (int i = 0; i < 5000; ++i)
+            {
+                call_method(writer, "writeln",
+                            {Value::create("entry " + std::to_string(i))});
+            }
+            call_method(writer, "close");
+
+            auto reader = call1(open_reader, path_value);
+            for (int i = 0; i < 5000; ++i)
+            {
+                REQUIRE(call_method(reader, "read_line")->raw_get<String>()
+                        == "entry " + std::to_string(i));
+            }
+            CHECK(call_method(reader, "read_line")->raw_get<String>() == "");
+            CHECK(call_method(reader, "eof")->raw_get<Bool>());
+            call_method(reader, "close");
+            CHECK(call_method(reader, "is_open")->raw_get<Bool>() == false);
+
+            // The file holds an ordinary compressed stream
+            std::ifstream file{path, std::ios::binary};
+            std::string contents{std::istreambuf_iterator<char>{file}, {}};
+            auto whole = call1(decompress, Value::create(String{contents}))
+                             ->raw_get<String>();
+            CHECK(whole.starts_with("entry 0\nentry 1\n"));
+            CHECK(whole.ends_with("entry 4999\n"));
+
+            std::filesystem::remove(path);
+
+            auto missing = Value::create(String{(dir / "missing").string()});
+            CHECK_THROWS_WITH(call1(open_reader, missing),
+                              ContainsSubstring("failed to open file"));
+
+            auto no_dir =
+                Value::create(String{(dir / "no-such-dir" / "out").string()});
+            CHECK_THROWS_WITH(call1(open_writer, no_dir),
+                              ContainsSubstring("failed to open file"));
+        }
+    }
+}
+
+TEST_CASE("ext::compression: streaming errors")
+{
+    auto mod = compression_module();
+
+    for (auto name : streaming_algos)
+    {
+        DYNAMIC_SECTION(name)
+        {
+            auto algo = lookup_algo(mod, std::string{name});
+            auto compress = lookup_fn(algo, "compress");
+            auto open_reader = lookup_fn(algo, "open_reader");
+            auto open_writer = lookup_fn(algo, "open_writer");
+
+            SECTION("truncated input")
+            {
+                std::string text;
+                for (int i = 0; i < 1000; ++i)
+                    text += std::to_string(i * 7919) + " ";
+                auto data =
+                    call1(compress, Value::create(String{text}))
+                        ->raw_get<String>();
+                auto reader = call1(
+                    open_reader,
+                    chunked_reader(data.substr(0, data.size() / 2), 64));
+                CHECK_THROWS_AS(call_method(reader, "read_rest"),
+                                Frost_User_Error);
+            }
+
+            SECTION("corrupt input")
+            {
+                auto reader = call1(
+                    open_reader, chunked_reader("not compressed data", 64));
+                CHECK_THROWS_AS(call_method(reader, "read_rest"),
+                                Frost_User_Error);
+            }
+
+            SECTION("writing after close")
+            {
+                auto out = std::make_shared<std::string>();
+                auto writer = call1(open_writer, collecting_writer(out));
+                call_method(writer, "close");
+                CHECK_THROWS_WITH(
+                    call_method(writer, "write", {Value::create("x"s)}),
+                    ContainsSubstring("writer is closed"));
+            }
+
+            SECTION("source and target must be streams or paths")
+            {
+                CHECK_THROWS(call1(open_reader, Value::create(1_f)));
+                CHECK_THROWS(call1(open_writer, Value::create(1_f)));
+                CHECK_THROWS_WITH(
+                    call1(open_reader,
+                          Value::create(Value::trusted, Map{})),
+                    ContainsSubstring("must have a read_some method"));
+                CHECK_THROWS_WITH(
+                    call1(open_writer,
+                          Value::create(Value::trusted, Map{})),
+                    ContainsSubstring("must have a write method"));
+            }
+        }
+    }
+}
+
+// =============================================================================
+// Multithreaded compression
+// =============================================================================
+
+TEST_CASE("ext::compression: threaded round-trip")
+{
+    auto mod = compression_module();
+
+    // Enough for a good number of blocks or jobs, and varied enough that
+    // each one has something to do
+    std::string input;
+    for (int i = 0; input.size() < 3 * 1024 * 1024; ++i)
+        input += "record " + std::to_string(i * 2654435761u % 1000003) + "\n";
+
+    for (auto name : threaded_algos)
+    {
+        DYNAMIC_SECTION(name)
+        {
+            auto algo = lookup_algo(mod, std::string{name});
+            auto compress = lookup_fn(algo, "compress");
+            auto decompress = lookup_fn(algo, "decompress");
+
+            for (Int threads : {1_f, 2_f, 4_f, 64_f})
+            {
+                auto compressed =
+                    call2(compress, Value::create(String{input}),
+                          options({{"threads", Value::create(threads)}}));
+                CHECK(call1(decompress, compressed)->raw_get<String>()
+                      == input);
+            }
+
+            auto compressed = call2(compress, Value::create(String{input}),
+                                    options({{"level", Value::create(1_f)},
+                                             {"threads", Value::create(3_f)}}));
+            CHECK(call1(decompress, compressed)->raw_get<String>() == input);
+
+            // Too small to split, which still has to come out right
+            compressed = call2(compress, Value::create("small"s),
+                               options({{"threads", Value::create(4_f)}}));
+            CHECK(call1(decompress, compressed)->raw_get<String>() == "small");
+        }
+    }
+}
+
+TEST_CASE("ext::compression: compress options")
+{
+    auto mod = compression_module();
+
+    for (auto name : threaded_algos)
+    {
+        DYNAMIC_SECTION(name)
+        {
+            auto algo = lookup_algo(mod, std::string{name});
+            auto compress = lookup_fn(algo, "compress");
+            auto decompress = lookup_fn(algo, "decompress");
+            auto input = Value::create("aaaaaaaaaa"s);
+
+            auto compressed = call2(compress, input,
+                                    options({{"level", Value::create(1_f)}}));
+            CHECK(call1(decompress, compressed)->raw_get<String>()
+                  == "aaaaaaaaaa");
+
+            CHECK_THROWS_WITH(
+                call2(compress, input,
+                      options({{"threads", Value::create(0_f)}})),
+                ContainsSubstring("threads must be at least 1"));
+            CHECK_THROWS_WITH(
+                call2(compress, input,
+                      options({{"threads", Value::create("4"s)}})),
+                ContainsSubstring("threads option must be an Int"));
+            CHECK_THROWS_WITH(
+                call2(compress, input,
+                      options({{"level", Value::create(1.5)}})),
+                ContainsSubstring("level option must be an Int"));
+            CHECK_THROWS_WITH(
+                call2(compress, input,
+                      options({{"workers", Value::create(2_f)}})),
+                ContainsSubstring("unknown option 'workers'"));
+            CHECK_THROWS_WITH(
+                call2(compress, input,
+                      options({{"level", Value::create(1000000_f)}})),
+                ContainsSubstring("level must be"));
+        }
+    }
+}
+
+#ifdef FROST_HAVE_ZLIB
+TEST_CASE("ext::compression: threaded gzip is a single standard stream")
+{
+    auto mod = compression_module();
+    auto algo = lookup_algo(mod, "gzip");
+    auto compress = lookup_fn(algo, "compress");
+    auto open_reader = lookup_fn(algo, "open_reader");
+
+    std::string input;
+    for (int i = 0; input.size() < 1024 * 1024; ++i)
+        input += std::to_string(i) + ",";
+
+    auto compressed =
+        call2(compress, Value::create(String{input}),
+              options({{"threads", Value::create(4_f)}}))
+            ->raw_get<String>();
+
+    // One member, with the header and trailer that zlib itself would write
+    REQUIRE(compressed.size() > 18);
+    CHECK(compressed.substr(0, 4) == "\x1f\x8b\x08\x00"s);
+    auto isize = compressed.substr(compressed.size() - 4);
+    CHECK(static_cast<unsigned char>(isize[0])
+              + (static_cast<unsigned char>(isize[1]) << 8)
+              + (static_cast<unsigned char>(isize[2]) << 16)
+              + (static_cast<std::size_t>(static_cast<unsigned char>(isize[3]))
+                 << 24)
+          == input.size());
+
+    auto reader = call1(open_reader, chunked_reader(compressed, 4096));
+    CHECK(call_method(reader, "read_rest")->raw_get<String>() == input);
+
+    // Far more threads than there are blocks or cores is no different
+    auto many =
+        call2(compress, Value::create(String{input}),
+              options({{"threads", Value::create(100000_f)}}))
+            ->raw_get<String>();
+    CHECK(many == compressed);
+}
+#endif
+
 // =============================================================================
 // zlib-family (deflate, glib, zlib-wrapped)
 // =============================================================================
@@ -351,6 +819,22 @@ TEST_CASE("ext::compression: concatenated gzip streams")
 
     CHECK(result->raw_get<String>() == "hello world");
 }
+
+TEST_CASE("ext::compression: gzip reader reads concatenated streams")
+{
+    auto mod = compression_module();
+    auto compress = lookup_fn(lookup_algo(mod, "gzip"), "compress");
+    auto open_reader = lookup_fn(lookup_algo(mod, "gzip"), "open_reader");
+
+    auto a = call1(compress, Value::create("hello "s));
+    auto b = call1(compress, Value::create("world"s));
+
+    auto reader = call1(
+        open_reader,
+        chunked_reader(a->raw_get<String>() + b->raw_get<String>(), 5));
+    CHECK(call_method(reader, "read_rest")->raw_get<String>()
+          == "hello world");
+}
 #endif
 
 // =============================================================================
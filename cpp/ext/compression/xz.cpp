@@ -1,27 +1,217 @@
+#include "compress-options.hpp"
+#include "stream-codec.hpp"
+
 #include <frost/builtins-common.hpp>
 
 #include <lzma.h>
 
+#include <algorithm>
 #include <array>
+#include <memory>
+#include <span>
 
 namespace frst::compression::xz
 {
 
+namespace
+{
+
+uint32_t get_preset(std::string_view fn_name, std::optional<Int> level)
+{
+    if (not level)
+        return LZMA_PRESET_DEFAULT;
+
+    if (*level < 0 || *level > 9)
+        throw Frost_Recoverable_Error{
+            fmt::format("{}: level must be between 0 and 9", fn_name)};
+    return static_cast<uint32_t>(*level);
+}
+
+// liblzma's multithreaded encoder cuts the input into independent blocks,
+// three times the dictionary size by default, and compresses them in
+// parallel. Input smaller than one block gains nothing from it.
+std::string compress_threaded(const String& input, uint32_t preset,
+                              uint32_t threads)
+{
+    lzma_mt mt{};
+    mt.threads = threads;
+    mt.preset = preset;
+    mt.check = LZMA_CHECK_CRC64;
+
+    lzma_stream stream = LZMA_STREAM_INIT;
+    if (lzma_stream_encoder_mt(&stream, &mt) != LZMA_OK)
+        throw Frost_Recoverable_Error{
+            "xz.compress: failed to initialize encoder"};
+
+    stream.next_in = reinterpret_cast<const uint8_t*>(input.data());
+    stream.avail_in = input.size();
+
+    // Each block has a header of its own, so the bound for a single block
+    // is only a first guess
+    std::string output(lzma_stream_buffer_bound(input.size()), '\0');
+
+    for (;;)
+    {
+        stream.next_out =
+            reinterpret_cast<uint8_t*>(output.data()) + stream.total_out;
+        stream.avail_out = output.size() - stream.total_out;
+
+        lzma_ret ret = lzma_code(&stream, LZMA_FINISH);
+        if (ret == LZMA_STREAM_END)
+            break;
+
+        if (ret != LZMA_OK)
+        {
+            lzma_end(&stream);
+            throw Frost_Recoverable_Error{
+                fmt::format("xz.compress: compression failed (error {})",
+                            static_cast<int>(ret))};
+        }
+
+        if (stream.avail_out == 0)
+            output.resize(output.size() * 2);
+    }
+
+    output.resize(stream.total_out);
+    lzma_end(&stream);
+    return output;
+}
+
+class Xz_Encoder : public Encoder
+{
+  public:
+    Xz_Encoder(std::string_view fn_name, uint32_t preset)
+        : fn_name_{fn_name}
+    {
+        if (lzma_easy_encoder(&stream_, preset, LZMA_CHECK_CRC64) != LZMA_OK)
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: failed to initialize encoder", fn_name)};
+    }
+
+    ~Xz_Encoder() override
+    {
+        lzma_end(&stream_);
+    }
+
+    void write(std::string_view in, std::string& out) override
+    {
+        run(in, LZMA_RUN, out);
+    }
+
+    void flush(std::string& out) override
+    {
+        run({}, LZMA_SYNC_FLUSH, out);
+    }
+
+    void finish(std::string& out) override
+    {
+        run({}, LZMA_FINISH, out);
+    }
+
+  private:
+    void run(std::string_view in, lzma_action action, std::string& out)
+    {
+        stream_.next_in = reinterpret_cast<const uint8_t*>(in.data());
+        stream_.avail_in = in.size();
+
+        std::array<uint8_t, 16384> buf;
+        lzma_ret ret;
+        do
+        {
+            stream_.next_out = buf.data();
+            stream_.avail_out = buf.size();
+
+            ret = lzma_code(&stream_, action);
+            if (ret != LZMA_OK && ret != LZMA_STREAM_END)
+                throw Frost_Recoverable_Error{
+                    fmt::format("{}: compression failed (error {})", fn_name_,
+                                static_cast<int>(ret))};
+
+            out.append(reinterpret_cast<char*>(buf.data()),
+                       buf.size() - stream_.avail_out);
+        } while (action == LZMA_RUN ? stream_.avail_out == 0
+                                    : ret != LZMA_STREAM_END);
+    }
+
+    std::string_view fn_name_;
+    lzma_stream stream_ = LZMA_STREAM_INIT;
+};
+
+class Xz_Decoder : public Decoder
+{
+  public:
+    explicit Xz_Decoder(std::string_view fn_name)
+        : fn_name_{fn_name}
+    {
+        if (lzma_auto_decoder(&stream_, UINT64_MAX, LZMA_CONCATENATED)
+            != LZMA_OK)
+        {
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: failed to initialize decoder", fn_name)};
+        }
+    }
+
+    ~Xz_Decoder() override
+    {
+        lzma_end(&stream_);
+    }
+
+    // Concatenated streams only end once the decoder is told that the input
+    // has, so until then the end is never reported
+    std::size_t decode(std::string_view& in, std::span<char> out,
+                       bool at_end) override
+    {
+        if (ended_)
+            return 0;
+
+        stream_.next_in = reinterpret_cast<const uint8_t*>(in.data());
+        stream_.avail_in = in.size();
+        stream_.next_out = reinterpret_cast<uint8_t*>(out.data());
+        stream_.avail_out = out.size();
+
+        lzma_ret ret = lzma_code(&stream_, at_end ? LZMA_FINISH : LZMA_RUN);
+        in.remove_prefix(in.size() - stream_.avail_in);
+        auto produced = out.size() - stream_.avail_out;
+
+        if (ret == LZMA_STREAM_END)
+            ended_ = true;
+        else if (ret == LZMA_BUF_ERROR && at_end)
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: truncated input", fn_name_)};
+        else if (ret != LZMA_OK)
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: decompression failed (error {})", fn_name_,
+                            static_cast<int>(ret))};
+
+        if (at_end && produced == 0 && not ended_)
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: truncated input", fn_name_)};
+        return produced;
+    }
+
+  private:
+    std::string_view fn_name_;
+    bool ended_ = false;
+    lzma_stream stream_ = LZMA_STREAM_INIT;
+};
+
+} // namespace
+
 BUILTIN(compress)
 {
     REQUIRE_ARGS("xz.compress", TYPES(String),
-                 OPTIONAL(PARAM("level", TYPES(Int))));
+                 OPTIONAL(PARAM("level or options", TYPES(Int, Map))));
 
     const auto& input = GET(0, String);
+    auto options = compress_options("xz.compress", args);
+    uint32_t preset = get_preset("xz.compress", options.level);
 
-    uint32_t preset = LZMA_PRESET_DEFAULT;
-    if (HAS(1))
+    if (options.threads > 1)
     {
-        auto level = GET(1, Int);
-        if (level < 0 || level > 9)
-            throw Frost_Recoverable_Error{
-                "xz.compress: level must be between 0 and 9"};
-        preset = static_cast<uint32_t>(level);
+        return Value::create(compress_threaded(
+            input, preset,
+            static_cast<uint32_t>(
+                std::min<Int>(options.threads, LZMA_THREADS_MAX))));
     }
 
     size_t bound = lzma_stream_buffer_bound(input.size());
@@ -83,4 +273,24 @@ BUILTIN(decompress)
     return Value::create(std::move(output));
 }
 
+BUILTIN(open_reader)
+{
+    REQUIRE_ARGS("xz.open_reader", PARAM("source", TYPES(String, Map)));
+
+    return make_reader("xz.open_reader", args.at(0),
+                       std::make_unique<Xz_Decoder>("xz.open_reader"));
+}
+
+BUILTIN(open_writer)
+{
+    REQUIRE_ARGS("xz.open_writer", PARAM("target", TYPES(String, Map)),
+                 OPTIONAL(PARAM("level", TYPES(Int))));
+
+    auto options = compress_options("xz.open_writer", args);
+    return make_writer(
+        "xz.open_writer", args.at(0),
+        std::make_unique<Xz_Encoder>(
+            "xz.open_writer", get_preset("xz.open_writer", options.level)));
+}
+
 } // namespace frst::compression::xz
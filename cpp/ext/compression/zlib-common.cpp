@@ -1,28 +1,363 @@
 #include "zlib-common.hpp"
+#include "compress-options.hpp"
+#include "stream-codec.hpp"
 
 #include <frost/builtins-common.hpp>
+#include <frost/thread-pool.hpp>
 
 #include <zlib.h>
 
+#include <algorithm>
 #include <array>
+#include <memory>
+#include <span>
+#include <vector>
 
 namespace frst::compression::zlib_common
 {
 
+namespace
+{
+
+int get_level(std::string_view fn_name, std::optional<Int> level)
+{
+    if (not level)
+        return Z_DEFAULT_COMPRESSION;
+
+    if (*level < -1 || *level > 9)
+        throw Frost_Recoverable_Error{
+            fmt::format("{}: level must be between -1 and 9", fn_name)};
+    return static_cast<int>(*level);
+}
+
+// With threads, the input is compressed in blocks of this size at once, as
+// pigz does
+constexpr std::size_t parallel_block_size = 128 * 1024;
+
+// How far back a deflate stream can refer, and so how much of the input
+// before a block primes the compressor for it
+constexpr std::size_t window_size = 32 * 1024;
+
+// Compresses one block of a parallel stream to raw deflate data. Every block
+// but the last ends with a sync flush, which leaves it on a byte boundary
+// and not marked final, so that the blocks can simply be joined.
+std::string deflate_block(std::string_view fn_name, int level,
+                          std::string_view history, std::string_view block,
+                          bool last)
+{
+    z_stream stream{};
+    if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8,
+                     Z_DEFAULT_STRATEGY)
+        != Z_OK)
+    {
+        throw Frost_Recoverable_Error{
+            fmt::format("{}: failed to initialize deflate stream", fn_name)};
+    }
+
+    if (not history.empty())
+    {
+        deflateSetDictionary(&stream,
+                             reinterpret_cast<const Bytef*>(history.data()),
+                             static_cast<uInt>(history.size()));
+    }
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block.data()));
+    stream.avail_in = static_cast<uInt>(block.size());
+
+    std::string output(deflateBound(&stream, stream.avail_in), '\0');
+    int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+
+    // deflateBound does not allow for the flush, so there may be a little
+    // left over to make room for
+    int ret;
+    for (;;)
+    {
+        stream.next_out =
+            reinterpret_cast<Bytef*>(output.data()) + stream.total_out;
+        stream.avail_out = static_cast<uInt>(output.size() - stream.total_out);
+
+        ret = deflate(&stream, flush);
+        if (ret == Z_STREAM_ERROR)
+            break;
+        if (last ? ret == Z_STREAM_END : stream.avail_out > 0)
+            break;
+
+        output.resize(output.size() * 2);
+    }
+    deflateEnd(&stream);
+
+    if (ret == Z_STREAM_ERROR)
+        throw Frost_Recoverable_Error{
+            fmt::format("{}: compression failed", fn_name)};
+
+    output.resize(stream.total_out);
+    return output;
+}
+
+void append_le32(std::string& out, uLong value)
+{
+    for (int shift = 0; shift < 32; shift += 8)
+        out.push_back(static_cast<char>((value >> shift) & 0xff));
+}
+
+void append_be32(std::string& out, uLong value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(static_cast<char>((value >> shift) & 0xff));
+}
+
+// Compresses input over up to threads threads, in the format that
+// window_bits selects, the way pigz does. Each block is deflated on its own,
+// primed with the window before it, and the check values of the blocks are
+// combined afterwards. The result decodes like any other stream of its
+// format, though it may be a little larger.
+std::string compress_parallel(std::string_view fn_name, const String& input,
+                              int level, int window_bits, Int threads)
+{
+    const bool gzip = window_bits > MAX_WBITS;
+    const bool raw = window_bits < 0;
+
+    const auto block_count =
+        (input.size() + parallel_block_size - 1) / parallel_block_size;
+    std::vector<std::string> blocks(block_count);
+    std::vector<uLong> checks(block_count);
+
+    auto block_at = [&](std::size_t i) {
+        return std::string_view{input}.substr(i * parallel_block_size,
+                                              parallel_block_size);
+    };
+
+    // Runs on the shared pool, which has a worker per hardware thread, and
+    // never on more threads than that. Splitting the blocks into one chunk
+    // per thread keeps it to that many at once, the calling thread among
+    // them.
+    auto& pool = Thread_Pool::shared();
+    auto workers = std::min(
+        {static_cast<std::size_t>(threads), pool.size(), block_count});
+    auto chunk_size = (block_count + workers - 1) / workers;
+    pool.for_chunks(block_count, chunk_size, [&](std::size_t begin,
+                                                 std::size_t end) {
+        for (auto i = begin; i < end; ++i)
+        {
+            auto start = i * parallel_block_size;
+            auto history_start = start - std::min(start, window_size);
+            auto history = std::string_view{input}.substr(
+                history_start, start - history_start);
+            auto block = block_at(i);
+
+            blocks[i] = deflate_block(fn_name, level, history, block,
+                                      i + 1 == block_count);
+
+            auto data = reinterpret_cast<const Bytef*>(block.data());
+            auto size = static_cast<uInt>(block.size());
+            if (gzip)
+                checks[i] = crc32(crc32(0, nullptr, 0), data, size);
+            else if (not raw)
+                checks[i] = adler32(adler32(0, nullptr, 0), data, size);
+        }
+    });
+
+    std::size_t total = 0;
+    for (const auto& block : blocks)
+        total += block.size();
+
+    std::string output;
+    output.reserve(total + 18);
+
+    // The headers are the ones deflate itself would write
+    const int effective_level = level == Z_DEFAULT_COMPRESSION ? 6 : level;
+    if (gzip)
+    {
+        const char extra_flags = effective_level == 9  ? 2
+                                 : effective_level < 2 ? 4
+                                                       : 0;
+        output.append({'\x1f', '\x8b', Z_DEFLATED, 0, 0, 0, 0, 0,
+                       extra_flags, 3});
+    }
+    else if (not raw)
+    {
+        const unsigned level_flags = effective_level < 2   ? 0
+                                     : effective_level < 6 ? 1
+                                     : effective_level == 6 ? 2
+                                                            : 3;
+        unsigned header = (Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8;
+        header |= level_flags << 6;
+        header += 31 - header % 31;
+        output.push_back(static_cast<char>(header >> 8));
+        output.push_back(static_cast<char>(header & 0xff));
+    }
+
+    for (const auto& block : blocks)
+        output += block;
+
+    if (gzip)
+    {
+        uLong crc = crc32(0, nullptr, 0);
+        for (std::size_t i = 0; i < block_count; ++i)
+        {
+            crc = crc32_combine(crc, checks[i],
+                                static_cast<z_off_t>(block_at(i).size()));
+        }
+        append_le32(output, crc);
+        append_le32(output, static_cast<uLong>(input.size() & 0xffffffff));
+    }
+    else if (not raw)
+    {
+        uLong adler = adler32(0, nullptr, 0);
+        for (std::size_t i = 0; i < block_count; ++i)
+        {
+            adler = adler32_combine(adler, checks[i],
+                                    static_cast<z_off_t>(block_at(i).size()));
+        }
+        append_be32(output, adler);
+    }
+
+    return output;
+}
+
+class Deflate_Encoder : public Encoder
+{
+  public:
+    Deflate_Encoder(std::string_view fn_name, int level, int window_bits)
+        : fn_name_{fn_name}
+    {
+        if (deflateInit2(&stream_, level, Z_DEFLATED, window_bits, 8,
+                         Z_DEFAULT_STRATEGY)
+            != Z_OK)
+        {
+            throw Frost_Recoverable_Error{fmt::format(
+                "{}: failed to initialize deflate stream", fn_name)};
+        }
+    }
+
+    ~Deflate_Encoder() override
+    {
+        deflateEnd(&stream_);
+    }
+
+    void write(std::string_view in, std::string& out) override
+    {
+        run(in, Z_NO_FLUSH, out);
+    }
+
+    void flush(std::string& out) override
+    {
+        run({}, Z_SYNC_FLUSH, out);
+    }
+
+    void finish(std::string& out) override
+    {
+        run({}, Z_FINISH, out);
+    }
+
+  private:
+    void run(std::string_view in, int mode, std::string& out)
+    {
+        stream_.next_in =
+            reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+        stream_.avail_in = static_cast<uInt>(in.size());
+
+        std::array<Bytef, 16384> buf;
+        int ret;
+        do
+        {
+            stream_.next_out = buf.data();
+            stream_.avail_out = static_cast<uInt>(buf.size());
+
+            ret = deflate(&stream_, mode);
+            if (ret == Z_STREAM_ERROR)
+                throw Frost_Recoverable_Error{
+                    fmt::format("{}: compression failed", fn_name_)};
+
+            out.append(reinterpret_cast<char*>(buf.data()),
+                       buf.size() - stream_.avail_out);
+        } while (stream_.avail_out == 0
+                 || (mode == Z_FINISH && ret != Z_STREAM_END));
+    }
+
+    std::string_view fn_name_;
+    z_stream stream_{};
+};
+
+class Inflate_Decoder : public Decoder
+{
+  public:
+    Inflate_Decoder(std::string_view fn_name, int window_bits,
+                    bool allow_concat)
+        : fn_name_{fn_name}
+        , allow_concat_{allow_concat}
+    {
+        if (inflateInit2(&stream_, window_bits) != Z_OK)
+            throw Frost_Recoverable_Error{fmt::format(
+                "{}: failed to initialize inflate stream", fn_name)};
+    }
+
+    ~Inflate_Decoder() override
+    {
+        ::inflateEnd(&stream_);
+    }
+
+    std::size_t decode(std::string_view& in, std::span<char> out,
+                       bool at_end) override
+    {
+        if (ended_)
+        {
+            // As in decompress, anything after the end is ignored unless
+            // it may be another stream
+            if (in.empty() || not allow_concat_)
+            {
+                in = {};
+                return 0;
+            }
+            ::inflateReset(&stream_);
+            ended_ = false;
+        }
+
+        stream_.next_in =
+            reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+        stream_.avail_in = static_cast<uInt>(in.size());
+        stream_.next_out = reinterpret_cast<Bytef*>(out.data());
+        stream_.avail_out = static_cast<uInt>(out.size());
+
+        int ret = ::inflate(&stream_, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: decompression failed ({})", fn_name_,
+                            stream_.msg ? stream_.msg : "unknown error")};
+
+        ended_ = ret == Z_STREAM_END;
+        in.remove_prefix(in.size() - stream_.avail_in);
+
+        auto produced = out.size() - stream_.avail_out;
+        if (at_end && produced == 0 && not ended_)
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: truncated input", fn_name_)};
+        return produced;
+    }
+
+  private:
+    std::string_view fn_name_;
+    bool allow_concat_;
+    bool ended_ = false;
+    z_stream stream_{};
+};
+
+} // namespace
+
 Value_Ptr compress(std::string_view fn_name, builtin_args_t args,
                    int window_bits)
 {
-    REQUIRE_ARGS(fn_name, TYPES(String), OPTIONAL(PARAM("level", TYPES(Int))));
+    REQUIRE_ARGS(fn_name, TYPES(String),
+                 OPTIONAL(PARAM("level or options", TYPES(Int, Map))));
 
     const auto& input = GET(0, String);
+    auto options = compress_options(fn_name, args);
+    int level = get_level(fn_name, options.level);
 
-    int level = Z_DEFAULT_COMPRESSION;
-    if (HAS(1))
+    if (options.threads > 1 && input.size() > parallel_block_size)
     {
-        level = static_cast<int>(GET(1, Int));
-        if (level < -1 || level > 9)
-            throw Frost_Recoverable_Error{
-                fmt::format("{}: level must be between -1 and 9", fn_name)};
+        return Value::create(compress_parallel(fn_name, input, level,
+                                               window_bits, options.threads));
     }
 
     z_stream stream{};
@@ -102,4 +437,27 @@ Value_Ptr decompress(std::string_view fn_name, builtin_args_t args,
     return Value::create(std::move(output));
 }
 
+Value_Ptr open_reader(std::string_view fn_name, builtin_args_t args,
+                      int window_bits, bool allow_concat)
+{
+    REQUIRE_ARGS(fn_name, PARAM("source", TYPES(String, Map)));
+
+    return make_reader(fn_name, args.at(0),
+                       std::make_unique<Inflate_Decoder>(fn_name, window_bits,
+                                                         allow_concat));
+}
+
+Value_Ptr open_writer(std::string_view fn_name, builtin_args_t args,
+                      int window_bits)
+{
+    REQUIRE_ARGS(fn_name, PARAM("target", TYPES(String, Map)),
+                 OPTIONAL(PARAM("level", TYPES(Int))));
+
+    auto options = compress_options(fn_name, args);
+    return make_writer(fn_name, args.at(0),
+                       std::make_unique<Deflate_Encoder>(
+                           fn_name, get_level(fn_name, options.level),
+                           window_bits));
+}
+
 } // namespace frst::compression::zlib_common
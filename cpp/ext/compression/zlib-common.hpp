@@ -15,6 +15,12 @@ Value_Ptr compress(std::string_view fn_name, builtin_args_t args,
 Value_Ptr decompress(std::string_view fn_name, builtin_args_t args,
                      int window_bits, bool allow_concat = false);
 
+Value_Ptr open_reader(std::string_view fn_name, builtin_args_t args,
+                      int window_bits, bool allow_concat = false);
+
+Value_Ptr open_writer(std::string_view fn_name, builtin_args_t args,
+                      int window_bits);
+
 } // namespace frst::compression::zlib_common
 
 #endif
@@ -17,4 +17,14 @@ BUILTIN(decompress)
     return zlib_common::decompress("zlib.decompress", args, MAX_WBITS);
 }
 
+BUILTIN(open_reader)
+{
+    return zlib_common::open_reader("zlib.open_reader", args, MAX_WBITS);
+}
+
+BUILTIN(open_writer)
+{
+    return zlib_common::open_writer("zlib.open_writer", args, MAX_WBITS);
+}
+
 } // namespace frst::compression::zlib
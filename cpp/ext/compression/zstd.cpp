@@ -1,33 +1,187 @@
+#include "compress-options.hpp"
 #include "decompress-limits.hpp"
+#include "stream-codec.hpp"
 
 #include <frost/builtins-common.hpp>
 
 #include <zstd.h>
 
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <span>
+
 namespace frst::compression::zstd
 {
 
+namespace
+{
+
+int get_level(std::string_view fn_name, std::optional<Int> level)
+{
+    if (not level)
+        return ZSTD_defaultCLevel();
+
+    if (*level < ZSTD_minCLevel() || *level > ZSTD_maxCLevel())
+        throw Frost_Recoverable_Error{
+            fmt::format("{}: level must be between {} and {}", fn_name,
+                        ZSTD_minCLevel(), ZSTD_maxCLevel())};
+    return static_cast<int>(*level);
+}
+
+class Zstd_Encoder : public Encoder
+{
+  public:
+    Zstd_Encoder(std::string_view fn_name, int level)
+        : fn_name_{fn_name}
+        , cctx_{ZSTD_createCCtx()}
+    {
+        if (not cctx_)
+            throw Frost_Recoverable_Error{fmt::format(
+                "{}: failed to create compression context", fn_name)};
+
+        ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel, level);
+    }
+
+    ~Zstd_Encoder() override
+    {
+        ZSTD_freeCCtx(cctx_);
+    }
+
+    void write(std::string_view in, std::string& out) override
+    {
+        run(in, ZSTD_e_continue, out);
+    }
+
+    void flush(std::string& out) override
+    {
+        run({}, ZSTD_e_flush, out);
+    }
+
+    void finish(std::string& out) override
+    {
+        run({}, ZSTD_e_end, out);
+    }
+
+  private:
+    void run(std::string_view in, ZSTD_EndDirective mode, std::string& out)
+    {
+        ZSTD_inBuffer in_buf{in.data(), in.size(), 0};
+        std::array<char, 16384> buf;
+
+        // Continuing only has to take all of the input, where flushing and
+        // ending have to write out everything the context holds
+        for (;;)
+        {
+            ZSTD_outBuffer out_buf{buf.data(), buf.size(), 0};
+            size_t remaining =
+                ZSTD_compressStream2(cctx_, &out_buf, &in_buf, mode);
+
+            if (ZSTD_isError(remaining))
+                throw Frost_Recoverable_Error{
+                    fmt::format("{}: compression failed ({})", fn_name_,
+                                ZSTD_getErrorName(remaining))};
+
+            out.append(buf.data(), out_buf.pos);
+
+            if (mode == ZSTD_e_continue ? in_buf.pos == in_buf.size
+                                        : remaining == 0)
+                return;
+        }
+    }
+
+    std::string_view fn_name_;
+    ZSTD_CCtx* cctx_;
+};
+
+class Zstd_Decoder : public Decoder
+{
+  public:
+    explicit Zstd_Decoder(std::string_view fn_name)
+        : fn_name_{fn_name}
+        , dstream_{ZSTD_createDStream()}
+    {
+        if (not dstream_)
+            throw Frost_Recoverable_Error{fmt::format(
+                "{}: failed to create decompression stream", fn_name)};
+    }
+
+    ~Zstd_Decoder() override
+    {
+        ZSTD_freeDStream(dstream_);
+    }
+
+    // Concatenated frames are decoded one after another, as in decompress
+    std::size_t decode(std::string_view& in, std::span<char> out,
+                       bool at_end) override
+    {
+        ZSTD_inBuffer in_buf{in.data(), in.size(), 0};
+        ZSTD_outBuffer out_buf{out.data(), out.size(), 0};
+
+        size_t ret = ZSTD_decompressStream(dstream_, &out_buf, &in_buf);
+        if (ZSTD_isError(ret))
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: decompression failed ({})", fn_name_,
+                            ZSTD_getErrorName(ret))};
+
+        in.remove_prefix(in_buf.pos);
+
+        // 0 means that a frame has just been decoded and flushed in full.
+        // Past that, the stream waits for the next frame, so a call that
+        // does nothing says nothing about where the input ended.
+        if (in_buf.pos > 0 || out_buf.pos > 0)
+            frame_done_ = ret == 0;
+
+        if (at_end && out_buf.pos == 0 && not frame_done_)
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: truncated input", fn_name_)};
+        return out_buf.pos;
+    }
+
+  private:
+    std::string_view fn_name_;
+    bool frame_done_ = false;
+    ZSTD_DStream* dstream_;
+};
+
+} // namespace
+
 BUILTIN(compress)
 {
     REQUIRE_ARGS("zstd.compress", TYPES(String),
-                 OPTIONAL(PARAM("level", TYPES(Int))));
+                 OPTIONAL(PARAM("level or options", TYPES(Int, Map))));
 
     const auto& input = GET(0, String);
+    auto options = compress_options("zstd.compress", args);
+    int level = get_level("zstd.compress", options.level);
+
+    std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx{
+        ZSTD_createCCtx(), &ZSTD_freeCCtx};
+    if (not cctx)
+        throw Frost_Recoverable_Error{
+            "zstd.compress: failed to create compression context"};
+
+    ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_compressionLevel, level);
 
-    int level = ZSTD_defaultCLevel();
-    if (HAS(1))
+    // zstd splits the input into jobs for its own worker threads. A zstd
+    // built without them has no room for any, and compresses on the calling
+    // thread as if threads were 1.
+    if (options.threads > 1)
     {
-        level = static_cast<int>(GET(1, Int));
-        if (level < ZSTD_minCLevel() || level > ZSTD_maxCLevel())
-            throw Frost_Recoverable_Error{
-                fmt::format("zstd.compress: level must be between {} and {}",
-                            ZSTD_minCLevel(), ZSTD_maxCLevel())};
+        auto bounds = ZSTD_cParam_getBounds(ZSTD_c_nbWorkers);
+        if (not ZSTD_isError(bounds.error) && bounds.upperBound > 0)
+        {
+            ZSTD_CCtx_setParameter(
+                cctx.get(), ZSTD_c_nbWorkers,
+                static_cast<int>(
+                    std::min<Int>(options.threads, bounds.upperBound)));
+        }
     }
 
     std::string output(ZSTD_compressBound(input.size()), '\0');
 
-    size_t result = ZSTD_compress(output.data(), output.size(), input.data(),
-                                  input.size(), level);
+    size_t result = ZSTD_compress2(cctx.get(), output.data(), output.size(),
+                                   input.data(), input.size());
 
     if (ZSTD_isError(result))
         throw Frost_Recoverable_Error{
@@ -100,4 +254,24 @@ BUILTIN(decompress)
     return Value::create(std::move(output));
 }
 
+BUILTIN(open_reader)
+{
+    REQUIRE_ARGS("zstd.open_reader", PARAM("source", TYPES(String, Map)));
+
+    return make_reader("zstd.open_reader", args.at(0),
+                       std::make_unique<Zstd_Decoder>("zstd.open_reader"));
+}
+
+BUILTIN(open_writer)
+{
+    REQUIRE_ARGS("zstd.open_writer", PARAM("target", TYPES(String, Map)),
+                 OPTIONAL(PARAM("level", TYPES(Int))));
+
+    auto options = compress_options("zstd.open_writer", args);
+    return make_writer(
+        "zstd.open_writer", args.at(0),
+        std::make_unique<Zstd_Encoder>(
+            "zstd.open_writer", get_level("zstd.open_writer", options.level)));
+}
+
 } // namespace frst::compression::zstd
@@ -0,0 +1,142 @@
+#include "connection-pool.hpp"
+
+#include <boost/asio/as_tuple.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+#include <algorithm>
+#include <deque>
+
+namespace frst::http
+{
+
+Connection_Key Connection_Key::for_request(const Outgoing_Request& req)
+{
+    return {
+        .host = req.uri.host,
+        .port = req.uri.port,
+        .tls = req.uri.tls,
+        .verify_tls = req.verify_tls,
+        .ca_file = req.ca_file,
+        .ca_path = req.ca_path,
+        .use_system_ca = req.use_system_ca,
+    };
+}
+
+struct Connection_Pool::Slot::Host
+{
+    struct Waiter
+    {
+        explicit Waiter(boost::asio::any_io_executor ex)
+            : timer{std::move(ex)}
+        {
+        }
+
+        boost::asio::steady_timer timer;
+        bool granted = false;
+    };
+
+    std::mutex mutex;
+    std::size_t in_use = 0;
+    std::deque<std::shared_ptr<Waiter>> waiters;
+};
+
+Connection_Pool::Slot::Slot(std::shared_ptr<Host> host)
+    : host_{std::move(host)}
+{
+}
+
+Connection_Pool::Slot::~Slot()
+{
+    if (not host_)
+        return;
+
+    std::lock_guard lock{host_->mutex};
+    if (host_->waiters.empty())
+    {
+        --host_->in_use;
+        return;
+    }
+
+    auto waiter = std::move(host_->waiters.front());
+    host_->waiters.pop_front();
+    waiter->granted = true;
+
+    // The timer is only touched from its request's own strand
+    boost::asio::post(waiter->timer.get_executor(),
+                      [waiter] { waiter->timer.cancel(); });
+}
+
+boost::asio::awaitable<Connection_Pool::Slot> Connection_Pool::acquire_slot(
+    const Connection_Key& key)
+{
+    std::shared_ptr<Slot::Host> host;
+    {
+        std::lock_guard lock{mutex_};
+        if (auto it = hosts_.find(key); it != hosts_.end())
+            host = it->second.lock();
+
+        if (not host)
+        {
+            // Forget every key no request holds a slot for any more
+            std::erase_if(hosts_, [](const auto& entry) {
+                return entry.second.expired();
+            });
+            host = std::make_shared<Slot::Host>();
+            hosts_.insert_or_assign(key, host);
+        }
+    }
+
+    auto waiter = std::make_shared<Slot::Host::Waiter>(
+        co_await boost::asio::this_coro::executor);
+    {
+        std::lock_guard lock{host->mutex};
+        if (host->in_use < max_connections_per_host)
+        {
+            ++host->in_use;
+            co_return Slot{std::move(host)};
+        }
+
+        waiter->timer.expires_at(boost::asio::steady_timer::time_point::max());
+        host->waiters.push_back(waiter);
+    }
+
+    // Nothing else runs on the request's strand until the wait has begun, so
+    // a slot handed over in the meantime still ends it
+    auto [_] = co_await waiter->timer.async_wait(
+        boost::asio::as_tuple(boost::asio::use_awaitable));
+
+    std::lock_guard lock{host->mutex};
+    if (waiter->granted)
+        co_return Slot{std::move(host)};
+
+    std::erase(host->waiters, waiter);
+    throw boost::system::system_error{boost::asio::error::operation_aborted};
+}
+
+Client_Runtime& Client_Runtime::shared()
+{
+    // Requests mostly wait on the network, so a few threads go a long way
+    static Client_Runtime runtime{
+        std::clamp(std::thread::hardware_concurrency(), 1u, 4u)};
+    return runtime;
+}
+
+Client_Runtime::Client_Runtime(std::size_t thread_count)
+{
+    threads_.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; ++i)
+        threads_.emplace_back([this] { ioc_.run(); });
+}
+
+Client_Runtime::~Client_Runtime()
+{
+    // Requests still in flight at exit are abandoned
+    work_.reset();
+    ioc_.stop();
+    threads_.clear();
+}
+
+} // namespace frst::http
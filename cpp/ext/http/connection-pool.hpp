@@ -0,0 +1,218 @@
+#ifndef FROST_EXT_HTTP_CONNECTION_POOL_HPP
+#define FROST_EXT_HTTP_CONNECTION_POOL_HPP
+
+#include "request.hpp"
+
+#include <frost/thread-pool.hpp>
+
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/beast/core/stream_traits.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+
+#include <chrono>
+#include <compare>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace frst::http
+{
+
+//! @brief Everything that decides whether a connection can serve a request
+//!
+//! Requests with different TLS settings never share a connection, even to
+//! the same host and port.
+struct Connection_Key
+{
+    std::string host;
+    std::uint16_t port;
+    bool tls;
+    bool verify_tls;
+    std::optional<std::string> ca_file;
+    std::optional<std::string> ca_path;
+    bool use_system_ca;
+
+    static Connection_Key for_request(const Outgoing_Request& req);
+
+    auto operator<=>(const Connection_Key&) const = default;
+};
+
+template <bool use_ssl>
+struct Connection
+{
+    using Stream = std::conditional_t<
+        use_ssl, boost::asio::ssl::stream<boost::beast::tcp_stream>,
+        boost::beast::tcp_stream>;
+
+    // The stream refers to the context, so it is kept alongside
+    std::shared_ptr<boost::asio::ssl::context> ssl_ctx;
+    Stream stream;
+    std::chrono::steady_clock::time_point idle_since;
+};
+
+//! @brief Open connections left idle by finished requests, for reuse
+//!
+//! A connection is only ever used by one request at a time: checkout()
+//! takes it out of the pool, and release() puts it back once its response
+//! has been read in full. Idle connections past idle_timeout are closed
+//! instead of reused, and at most max_idle_per_host are kept for each key.
+//!
+//! No more than max_connections_per_host requests for one key are in flight
+//! at once. Each holds a Slot from acquire_slot() while it uses a connection,
+//! and the rest wait for one to be given back.
+class Connection_Pool
+{
+  public:
+    static constexpr auto idle_timeout = std::chrono::seconds{15};
+    static constexpr std::size_t max_idle_per_host = 16;
+    static constexpr std::size_t max_connections_per_host = 16;
+
+    //! @brief A request's leave to use a connection for its key
+    //!
+    //! Given back on destruction, straight to the request that has waited
+    //! longest for the same key, if any has.
+    class Slot
+    {
+      public:
+        Slot(Slot&&) noexcept = default;
+        Slot& operator=(Slot&&) = delete;
+        ~Slot();
+
+      private:
+        friend class Connection_Pool;
+        struct Host;
+
+        explicit Slot(std::shared_ptr<Host> host);
+
+        std::shared_ptr<Host> host_;
+    };
+
+    // Waits for a slot for key. Throws if the request is cancelled first.
+    boost::asio::awaitable<Slot> acquire_slot(const Connection_Key& key);
+
+    template <bool use_ssl>
+    using Connection_Ptr = std::unique_ptr<Connection<use_ssl>>;
+
+    // An idle connection for key, or null if there is none to reuse
+    template <bool use_ssl>
+    Connection_Ptr<use_ssl> checkout(const Connection_Key& key)
+    {
+        const auto now = std::chrono::steady_clock::now();
+
+        std::lock_guard lock{mutex_};
+        auto it = idle<use_ssl>().find(key);
+        if (it == idle<use_ssl>().end())
+            return nullptr;
+
+        // The most recently used connection is the least likely to have
+        // been closed by the server
+        auto& connections = it->second;
+        while (not connections.empty())
+        {
+            auto conn = std::move(connections.back());
+            connections.pop_back();
+
+            if (now - conn->idle_since < idle_timeout
+                && boost::beast::get_lowest_layer(conn->stream)
+                       .socket()
+                       .is_open())
+            {
+                return conn;
+            }
+        }
+
+        idle<use_ssl>().erase(it);
+        return nullptr;
+    }
+
+    template <bool use_ssl>
+    void release(const Connection_Key& key, Connection_Ptr<use_ssl> conn)
+    {
+        conn->idle_since = std::chrono::steady_clock::now();
+
+        std::lock_guard lock{mutex_};
+        auto& connections = idle<use_ssl>()[key];
+        if (connections.size() < max_idle_per_host)
+            connections.push_back(std::move(conn));
+    }
+
+  private:
+    template <bool use_ssl>
+    using Idle_Connections =
+        std::map<Connection_Key, std::vector<Connection_Ptr<use_ssl>>>;
+
+    template <bool use_ssl>
+    Idle_Connections<use_ssl>& idle()
+    {
+        if constexpr (use_ssl)
+            return idle_tls_;
+        else
+            return idle_plain_;
+    }
+
+    std::mutex mutex_;
+    Idle_Connections<false> idle_plain_;
+    Idle_Connections<true> idle_tls_;
+
+    // Held by the slots and waiting requests for each key, so that a slot
+    // given back at exit never reaches into a pool already destroyed
+    std::map<Connection_Key, std::weak_ptr<Slot::Host>> hosts_;
+};
+
+//! @brief The I/O threads and connections shared by every HTTP request
+//!
+//! Each request runs on a strand of its own, so a single request is never
+//! worked on by two threads at once.
+class Client_Runtime
+{
+  public:
+    static Client_Runtime& shared();
+
+    ~Client_Runtime();
+
+    boost::asio::strand<boost::asio::io_context::executor_type> make_strand()
+    {
+        return boost::asio::make_strand(ioc_);
+    }
+
+    Connection_Pool& connections()
+    {
+        return connections_;
+    }
+
+    // Where streamed bodies are handed to their sinks, off the I/O threads
+    Thread_Pool& sink_threads()
+    {
+        return sink_threads_;
+    }
+
+  private:
+    explicit Client_Runtime(std::size_t thread_count);
+
+    boost::asio::io_context ioc_;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+        work_ = boost::asio::make_work_guard(ioc_);
+
+    // Idle connections are tied to ioc_, so must go before it
+    Connection_Pool connections_;
+
+    std::vector<std::jthread> threads_;
+
+    // Sinks may block, so there are a few even on one core. Their jobs wake
+    // requests on ioc_, so must be done with before it goes.
+    Thread_Pool sink_threads_{4};
+};
+
+} // namespace frst::http
+
+#endif
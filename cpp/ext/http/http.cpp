@@ -9,6 +9,7 @@
 #include <boost/url.hpp>
 
 #include "request.hpp"
+#include "server.hpp"
 
 namespace frst
 {
@@ -23,6 +24,21 @@ BUILTIN(request)
     return do_http_request(GET(0, Map));
 }
 
+BUILTIN(request_all)
+{
+    REQUIRE_ARGS("http.request_all", PARAM("requests", TYPES(Array)),
+                 OPTIONAL(PARAM("options", TYPES(Map))));
+
+    return do_http_request_all(GET(0, Array), HAS(1) ? GET(1, Map) : Map{});
+}
+
+BUILTIN(serve)
+{
+    REQUIRE_ARGS("http.serve", TYPES(Map));
+
+    return do_http_serve(GET(0, Map));
+}
+
 BUILTIN(parse_url)
 {
     REQUIRE_ARGS("http.parse_url", TYPES(String));
@@ -120,6 +136,7 @@ BUILTIN(build_url)
 
 } // namespace http
 
-REGISTER_EXTENSION(http, ENTRY(request), ENTRY(parse_url), ENTRY(build_url));
+REGISTER_EXTENSION(http, ENTRY(request), ENTRY(request_all), ENTRY(serve),
+                   ENTRY(parse_url), ENTRY(build_url));
 
 } // namespace frst
@@ -1,11 +1,13 @@
 #include "request.hpp"
 
+#include "connection-pool.hpp"
+
 #include <boost/asio/ssl/host_name_verification.hpp>
 #include <boost/asio/use_awaitable.hpp>
 #include <boost/beast/core/stream_traits.hpp>
-#include <boost/scope_exit.hpp>
 
 #include <frost/builtins-common.hpp>
+#include <frost/thread-pool.hpp>
 #include <frost/value.hpp>
 
 #include <boost/algorithm/string.hpp>
@@ -21,7 +23,16 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <future>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <string_view>
+#include <vector>
 
 namespace frst::http
 {
@@ -64,203 +75,669 @@ asio::awaitable<std::expected<void, Request_Result::Error>> do_ssl_handshake(
     co_return std::expected<void, Error>{};
 }
 
-template <bool use_ssl>
-asio::awaitable<Request_Result> run_http_request(Outgoing_Request req,
-                                                 std::string& phase)
+std::shared_ptr<asio::ssl::context> make_ssl_context(
+    const Outgoing_Request& req)
 {
-    using R = Request_Result;
-    using Error = R::Error;
+    auto ctx =
+        std::make_shared<asio::ssl::context>(asio::ssl::context::tls_client);
 
-    auto ex = co_await asio::this_coro::executor;
-    auto resolver = asio::ip::tcp::resolver{ex};
+    if (req.use_system_ca)
+        ctx->set_default_verify_paths();
 
-    auto ssl_ctx = [&] -> std::optional<asio::ssl::context> {
-        if constexpr (not use_ssl)
-            return std::nullopt;
-        else
-        {
-            auto ctx = asio::ssl::context{asio::ssl::context::tls_client};
+    if (req.ca_file)
+        ctx->load_verify_file(req.ca_file.value());
 
-            if (req.use_system_ca)
-                ctx.set_default_verify_paths();
+    if (req.ca_path)
+        ctx->add_verify_path(req.ca_path.value());
 
-            if (req.ca_file)
-                ctx.load_verify_file(req.ca_file.value());
+    if (req.verify_tls)
+        ctx->set_verify_mode(asio::ssl::verify_peer);
+    else
+        ctx->set_verify_mode(asio::ssl::verify_none);
 
-            if (req.ca_path)
-                ctx.add_verify_path(req.ca_path.value());
+    return ctx;
+}
 
-            if (req.verify_tls)
-            {
-                ctx.set_verify_mode(asio::ssl::verify_peer);
-            }
-            else
-                ctx.set_verify_mode(asio::ssl::verify_none);
+template <bool use_ssl>
+using Connection_Result =
+    std::expected<Connection_Pool::Connection_Ptr<use_ssl>,
+                  Request_Result::Error>;
 
-            return ctx;
-        }
-    }();
+// Resolve, connect to and (with TLS) handshake with the request's host
+template <bool use_ssl>
+asio::awaitable<Connection_Result<use_ssl>> open_connection(
+    const Outgoing_Request& req, std::string& phase)
+{
+    using Error = Request_Result::Error;
 
-    if (use_ssl && !ssl_ctx)
-        THROW_UNREACHABLE;
+    auto ex = co_await asio::this_coro::executor;
+    auto resolver = asio::ip::tcp::resolver{ex};
 
-    auto stream = [&] {
+    auto conn = [&] {
         if constexpr (not use_ssl)
-            return beast::tcp_stream{ex};
+            return std::make_unique<Connection<false>>(nullptr,
+                                                       beast::tcp_stream{ex});
         else
         {
-            auto stream =
-                asio::ssl::stream<beast::tcp_stream>{ex, ssl_ctx.value()};
+            auto ssl_ctx = make_ssl_context(req);
+            auto stream = asio::ssl::stream<beast::tcp_stream>{ex, *ssl_ctx};
 
             if (req.verify_tls)
                 stream.set_verify_callback(
                     asio::ssl::host_name_verification(req.uri.host));
 
-            return stream;
+            return std::make_unique<Connection<true>>(std::move(ssl_ctx),
+                                                      std::move(stream));
         }
     }();
 
-    try
-    {
-        phase = "DNS";
-        auto [err, resolve_result] = co_await resolver.async_resolve(
-            req.uri.host, std::to_string(req.uri.port),
-            asio::as_tuple(asio::use_awaitable));
+    auto& stream = conn->stream;
+
+    phase = "DNS";
+    auto [err, resolve_result] = co_await resolver.async_resolve(
+        req.uri.host, std::to_string(req.uri.port),
+        asio::as_tuple(asio::use_awaitable));
+
+    if (err)
+        co_return std::unexpected{Error{
+            .category = "DNS lookup",
+            .message = err.message(),
+            .phase = phase,
+        }};
 
-        if (err)
-            co_return std::unexpected{Request_Result::Error{
-                .category = "DNS lookup",
-                .message = err.message(),
+    if constexpr (use_ssl)
+    {
+        phase = "SNI";
+        if (!SSL_set_tlsext_host_name(stream.native_handle(),
+                                      req.uri.host.c_str()))
+            // TODO: Properly get the error message from openssl
+            co_return std::unexpected{Error{
+                .category = "Server Name Identification",
+                .message = "failed to set SNI",
                 .phase = phase,
             }};
+    }
+
+    beast::get_lowest_layer(stream).expires_never();
 
-        if constexpr (use_ssl)
+    phase = "connect";
+    auto [connect_err, _] =
+        co_await beast::get_lowest_layer(stream).async_connect(
+            resolve_result, asio::as_tuple(asio::use_awaitable));
+
+    if (connect_err)
+        co_return std::unexpected{Error{
+            .category = "connect",
+            .message = connect_err.message(),
+            .phase = phase,
+        }};
+
+    if constexpr (use_ssl)
+    {
+        auto ssl_result = co_await do_ssl_handshake(stream, phase);
+        if (not ssl_result.has_value())
+            co_return std::unexpected{ssl_result.error()};
+    }
+
+    co_return std::move(conn);
+}
+
+// What came back for a request, with the body unset if it was streamed
+struct Received
+{
+    beast::http::response_header<> head;
+    std::optional<std::string> body;
+    bool keep_alive;
+};
+
+using Receive_Result = std::expected<Received, Request_Result::Error>;
+
+// Whether ec is how a connection the server has already closed fails
+bool is_closed_connection(const system::error_code& ec)
+{
+    return ec == beast::http::error::end_of_stream
+           || ec == asio::error::eof
+           || ec == asio::error::connection_reset
+           || ec == asio::error::broken_pipe;
+}
+
+// Requests that have the same effect however many times they are sent
+bool is_idempotent(beast::http::verb method)
+{
+    using enum beast::http::verb;
+    return method == get
+           || method == head
+           || method == put
+           || method == delete_
+           || method == options
+           || method == trace;
+}
+
+// When a request times out. Moving the deadline wakes the watchdog to look
+// again, so it may be moved either way, but only from the request's strand.
+class Request_Deadline
+{
+  public:
+    Request_Deadline(asio::any_io_executor ex,
+                     std::chrono::milliseconds timeout)
+        : timeout_{timeout}
+        , timer_{std::move(ex)}
+    {
+        timer_.expires_after(timeout_);
+    }
+
+    // One whole timeout from now
+    void restart()
+    {
+        timer_.expires_after(timeout_);
+    }
+
+    // Never, until restarted
+    void pause()
+    {
+        timer_.expires_at(asio::steady_timer::time_point::max());
+    }
+
+    // Completes once the deadline has passed, or the wait is cancelled
+    asio::awaitable<void> expired()
+    {
+        while (true)
         {
-            phase = "SNI";
-            if (!SSL_set_tlsext_host_name(stream.native_handle(),
-                                          req.uri.host.c_str()))
-                // TODO: Properly get the error message from openssl
-                co_return std::unexpected{Error{
-                    .category = "Server Name Identification",
-                    .message = "failed to set SNI",
-                    .phase = phase,
-                }};
+            auto [ec] =
+                co_await timer_.async_wait(asio::as_tuple(asio::use_awaitable));
+            if (not ec)
+                co_return;
+
+            auto state = co_await asio::this_coro::cancellation_state;
+            if (state.cancelled() != asio::cancellation_type::none)
+                co_return;
+        }
+    }
+
+  private:
+    std::chrono::milliseconds timeout_;
+    asio::steady_timer timer_;
+};
+
+constexpr std::size_t body_chunk_size = 64 * 1024;
+
+// Runs a request's body sink on the runtime's sink threads, so that a slow or
+// blocking sink, such as an on_chunk Function, never holds up the I/O threads
+// every request shares. At most max_queued chunks wait for the sink, and the
+// request reads no more until one of them has been taken. A sink only has a
+// thread while it has chunks waiting, so a few threads serve every request.
+//
+// close() must be awaited before the request completes. It waits out a write
+// already under way, so the sink is never called after the request is over.
+class Sink_Runner
+{
+  public:
+    static constexpr std::size_t max_queued = 16;
+
+    Sink_Runner(std::function<Body_Sink()> open_sink, Thread_Pool& threads,
+                asio::any_io_executor ex)
+        : state_{std::make_shared<State>(std::move(open_sink), threads,
+                                         std::move(ex))}
+    {
+    }
+
+    Sink_Runner(const Sink_Runner&) = delete;
+    Sink_Runner& operator=(const Sink_Runner&) = delete;
+
+    // Only reached without close() when the request itself was destroyed, as
+    // at exit. What is queued is dropped, and the request is not woken again.
+    ~Sink_Runner()
+    {
+        std::lock_guard lock{state_->mutex};
+        state_->abandoned = true;
+        state_->waiting = false;
+        state_->chunks.clear();
+    }
+
+    // Rethrows the sink's error once it has failed
+    asio::awaitable<void> write(std::string chunk)
+    {
+        co_await wait_until([&] {
+            return state_->chunks.size() < max_queued || state_->error;
+        });
+
+        std::lock_guard lock{state_->mutex};
+        if (state_->error)
+            std::rethrow_exception(state_->error);
+        state_->chunks.push_back(std::move(chunk));
+        state_->schedule();
+    }
+
+    // Waits for every chunk to be written and the sink to be finished
+    asio::awaitable<void> finish()
+    {
+        {
+            std::lock_guard lock{state_->mutex};
+            state_->finishing = true;
+            state_->schedule();
         }
 
-        beast::get_lowest_layer(stream).expires_never();
+        co_await wait_until([&] { return not state_->running; });
 
-        phase = "connect";
-        auto [connect_err, _] =
-            co_await beast::get_lowest_layer(stream).async_connect(
-                resolve_result, asio::as_tuple(asio::use_awaitable));
+        std::lock_guard lock{state_->mutex};
+        if (state_->error)
+            std::rethrow_exception(state_->error);
+    }
 
-        if (connect_err)
-            co_return std::unexpected{Error{
-                .category = "connect",
-                .message = connect_err.message(),
-                .phase = phase,
-            }};
+    // Drops whatever is still queued, and waits for the write under way.
+    // This runs even once the request has been cancelled.
+    asio::awaitable<void> close()
+    {
+        co_await asio::this_coro::reset_cancellation_state();
 
-        auto maybe_ssl_result = co_await [&] {
-            if constexpr (use_ssl)
-            {
-                return do_ssl_handshake(stream, phase);
-            }
-            else
+        {
+            std::lock_guard lock{state_->mutex};
+            state_->abandoned = true;
+            state_->chunks.clear();
+        }
+
+        co_await wait_until([&] { return not state_->running; });
+    }
+
+  private:
+    struct State : std::enable_shared_from_this<State>
+    {
+        State(std::function<Body_Sink()> open_sink, Thread_Pool& threads,
+              asio::any_io_executor ex)
+            : open_sink{std::move(open_sink)}
+            , threads{&threads}
+            , wakeup{std::move(ex)}
+        {
+        }
+
+        // Called with mutex held
+        void schedule()
+        {
+            const bool work = not chunks.empty() || (finishing && not finished);
+            if (running || abandoned || error || not work)
+                return;
+
+            running = true;
+            threads->post([self = shared_from_this()] { self->drain(); });
+        }
+
+        // Writes what is queued, on a sink thread, until there is no more
+        void drain()
+        {
+            std::unique_lock lock{mutex};
+            while (not abandoned && not error)
             {
-                return [] -> asio::awaitable<std::expected<void, Error>> {
-                    co_return std::expected<void, Error>{};
-                }();
+                if (chunks.empty() && (not finishing || finished))
+                    break;
+
+                std::optional<std::string> chunk;
+                if (not chunks.empty())
+                {
+                    chunk = std::move(chunks.front());
+                    chunks.pop_front();
+                    wake_request();
+                }
+                lock.unlock();
+
+                std::exception_ptr failure;
+                try
+                {
+                    if (not sink)
+                        sink = open_sink();
+                    if (chunk)
+                        sink->write(*chunk);
+                    else
+                        sink->finish();
+                }
+                catch (...)
+                {
+                    failure = std::current_exception();
+                }
+
+                lock.lock();
+                if (failure)
+                    error = failure;
+                else if (not chunk)
+                    finished = true;
             }
-        }();
 
-        if (not maybe_ssl_result.has_value())
-            co_return std::unexpected{maybe_ssl_result.error()};
+            running = false;
+            wake_request();
+        }
+
+        // Called with mutex held. The timer is only touched from the
+        // request's own strand.
+        void wake_request()
+        {
+            if (not waiting)
+                return;
+
+            asio::post(wakeup.get_executor(), [self = shared_from_this()] {
+                self->wakeup.cancel();
+            });
+        }
+
+        // Only used by the one drain() running at a time
+        std::function<Body_Sink()> open_sink;
+        std::optional<Body_Sink> sink;
+
+        Thread_Pool* threads;
+
+        std::mutex mutex;
+        std::deque<std::string> chunks;
+        bool finishing = false;
+        bool finished = false;
+        bool abandoned = false;
+        bool running = false;
+        bool waiting = false;
+        std::exception_ptr error;
 
-        phase = "send HTTP request";
+        asio::steady_timer wakeup;
+    };
 
-        urls::url url;
-        url.set_path(req.uri.path);
-        auto params = url.params();
-        for (const auto& qparam : req.uri.query_parameters)
+    // Nothing else runs on the strand between checking pred and starting to
+    // wait, so a wake_request posted after the check always ends the wait
+    template <typename Pred>
+    asio::awaitable<void> wait_until(Pred pred)
+    {
+        while (true)
         {
-            if (qparam.value)
-                params.append({qparam.key, qparam.value.value()});
-            else
-                params.append({qparam.key, urls::no_value});
+            {
+                std::lock_guard lock{state_->mutex};
+                state_->waiting = not pred();
+                if (not state_->waiting)
+                    co_return;
+            }
+
+            state_->wakeup.expires_at(asio::steady_timer::time_point::max());
+            auto [_] = co_await state_->wakeup.async_wait(
+                asio::as_tuple(asio::use_awaitable));
         }
+    }
 
-        beast::http::request<beast::http::string_body> request{
-            req.method, url.encoded_target(), 11};
+    std::shared_ptr<State> state_;
+};
 
-        request.set(beast::http::field::user_agent,
-                    "Frost HTTP Client " FROST_VERSION);
+// Hand the body to sink as it arrives. Once the head has arrived, the
+// deadline restarts with each read, so only a stalled body times out.
+template <typename Stream, typename Parser>
+asio::awaitable<std::optional<Request_Result::Error>> stream_body(
+    Stream& stream, beast::flat_buffer& buf, Parser& parser,
+    const Outgoing_Request& req, std::string& phase,
+    Request_Deadline& deadline, Sink_Runner& sink)
+{
+    using Error = Request_Result::Error;
 
-        if (req.body)
+    try
+    {
+        while (not parser.is_done())
         {
-            request.body() = std::move(req.body).value();
-            request.prepare_payload();
+            std::string chunk(body_chunk_size, '\0');
+            auto& body = parser.get().body();
+            body.data = chunk.data();
+            body.size = chunk.size();
+
+            deadline.restart();
+
+            // need_buffer only means the chunk is full
+            auto [read_err, _] = co_await http::async_read(
+                stream, buf, parser, asio::as_tuple(asio::use_awaitable));
+
+            if (read_err && read_err != beast::http::error::need_buffer)
+                co_return Error{
+                    .category = "IO",
+                    .message = read_err.message(),
+                    .phase = phase,
+                };
+
+            // Time spent waiting on the sink is not the server's to answer for
+            deadline.pause();
+
+            chunk.resize(chunk.size() - parser.get().body().size);
+            if (not chunk.empty())
+                co_await sink.write(std::move(chunk));
         }
 
-        std::string host_header = req.uri.host;
-        if (not is_default_port(use_ssl, req.uri.port))
-            host_header = fmt::format("{}:{}", host_header, req.uri.port);
+        co_await sink.finish();
+    }
+    catch (const std::exception& e)
+    {
+        co_return Error{
+            .category = "body",
+            .message = e.what(),
+            .phase = phase,
+        };
+    }
 
-        request.set(beast::http::field::host, host_header);
+    co_return std::nullopt;
+}
 
-        for (const auto& header : req.headers)
-            request.insert(header.key, header.value);
+// Read the body a chunk at a time into the request's sink, so that only a
+// few chunks of it are ever held in memory
+template <typename Stream>
+asio::awaitable<Receive_Result> receive_streamed(Stream& stream,
+                                                 beast::flat_buffer& buf,
+                                                 const Outgoing_Request& req,
+                                                 std::string& phase,
+                                                 bool& stale,
+                                                 Request_Deadline& deadline)
+{
+    beast::http::response_parser<beast::http::buffer_body> parser;
+    parser.skip(req.method == beast::http::verb::head);
+    parser.body_limit(std::numeric_limits<std::uint64_t>::max());
 
-        auto [send_err, _] = co_await beast::http::async_write(
-            stream, request, asio::as_tuple(asio::use_awaitable));
+    auto [head_err, _] = co_await http::async_read_header(
+        stream, buf, parser, asio::as_tuple(asio::use_awaitable));
 
-        if (send_err)
-            co_return std::unexpected{Error{
-                .category = "IO",
-                .message = send_err.message(),
-                .phase = phase,
-            }};
+    if (head_err)
+    {
+        stale = is_closed_connection(head_err) && not parser.got_some();
+        co_return std::unexpected{Request_Result::Error{
+            .category = "IO",
+            .message = head_err.message(),
+            .phase = phase,
+        }};
+    }
 
-        phase = "receive HTTP response";
-        beast::flat_buffer resp_buf;
+    Sink_Runner sink{req.open_body_sink,
+                     Client_Runtime::shared().sink_threads(),
+                     co_await asio::this_coro::executor};
 
-        beast::http::response_parser<beast::http::dynamic_body> parser;
-        parser.skip(req.method == beast::http::verb::head);
+    auto failure = co_await stream_body(stream, buf, parser, req, phase,
+                                        deadline, sink);
 
-        auto [recv_err, _] = co_await http::async_read(
-            stream, resp_buf, parser, asio::as_tuple(asio::use_awaitable));
+    // However the body ended, the sink is done with before the request is
+    co_await sink.close();
 
-        if (recv_err)
-            co_return std::unexpected{Error{
-                .category = "IO",
-                .message = recv_err.message(),
-                .phase = phase,
-            }};
+    if (failure)
+        co_return std::unexpected{std::move(failure).value()};
+
+    // Whatever is left to do on the connection gets a timeout of its own
+    deadline.restart();
+
+    auto resp = parser.release();
+    const bool keep_alive = resp.keep_alive();
+    co_return Received{std::move(resp.base()), std::nullopt, keep_alive};
+}
+
+// Send the request over stream, and read the whole response. On failure,
+// stale says whether the connection was found closed before any of the
+// response arrived.
+template <typename Stream>
+asio::awaitable<Receive_Result> exchange(
+    Stream& stream, const beast::http::request<beast::http::string_body>& msg,
+    const Outgoing_Request& req, std::string& phase, bool& stale,
+    Request_Deadline& deadline)
+{
+    using Error = Request_Result::Error;
+
+    stale = false;
+
+    phase = "send HTTP request";
+    auto [send_err, _] = co_await beast::http::async_write(
+        stream, msg, asio::as_tuple(asio::use_awaitable));
+
+    if (send_err)
+    {
+        stale = is_closed_connection(send_err);
+        co_return std::unexpected{Error{
+            .category = "IO",
+            .message = send_err.message(),
+            .phase = phase,
+        }};
+    }
+
+    phase = "receive HTTP response";
+    beast::flat_buffer resp_buf;
+
+    if (req.open_body_sink)
+        co_return co_await receive_streamed(stream, resp_buf, req, phase,
+                                            stale, deadline);
+
+    beast::http::response_parser<beast::http::dynamic_body> parser;
+    parser.skip(req.method == beast::http::verb::head);
+
+    auto [recv_err, _] = co_await http::async_read(
+        stream, resp_buf, parser, asio::as_tuple(asio::use_awaitable));
+
+    if (recv_err)
+    {
+        stale = is_closed_connection(recv_err) && not parser.got_some();
+        co_return std::unexpected{Error{
+            .category = "IO",
+            .message = recv_err.message(),
+            .phase = phase,
+        }};
+    }
+
+    auto resp = parser.release();
+    const bool keep_alive = resp.keep_alive();
+    auto body = beast::buffers_to_string(resp.body().data());
+    co_return Received{std::move(resp.base()), std::move(body), keep_alive};
+}
+
+template <bool use_ssl>
+asio::awaitable<void> close_connection(Connection<use_ssl>& conn,
+                                       std::string& phase)
+{
+    if constexpr (use_ssl)
+    {
+        phase = "SSL shutdown";
+        auto [_] = co_await conn.stream.async_shutdown(
+            asio::as_tuple(asio::use_awaitable));
+        // ignore a failure here;
+        // I got my result, so everything is _fine_ here too.
+    }
+
+    phase = "close";
+    system::error_code close_err;
+    shutdown_socket(beast::get_lowest_layer(conn.stream).socket(), close_err);
+
+    // ignore a graceless close; I got my result, so everything is _fine_.
+}
 
-        auto resp = parser.release();
+beast::http::request<beast::http::string_body> build_request(
+    Outgoing_Request& req)
+{
+    urls::url url;
+    url.set_path(req.uri.path);
+    auto params = url.params();
+    for (const auto& qparam : req.uri.query_parameters)
+    {
+        if (qparam.value)
+            params.append({qparam.key, qparam.value.value()});
+        else
+            params.append({qparam.key, urls::no_value});
+    }
+
+    beast::http::request<beast::http::string_body> request{
+        req.method, url.encoded_target(), 11};
+
+    request.set(beast::http::field::user_agent,
+                "Frost HTTP Client " FROST_VERSION);
+
+    if (req.body)
+    {
+        request.body() = std::move(req.body).value();
+        request.prepare_payload();
+    }
+
+    std::string host_header = req.uri.host;
+    if (not is_default_port(req.uri.tls, req.uri.port))
+        host_header = fmt::format("{}:{}", host_header, req.uri.port);
+
+    request.set(beast::http::field::host, host_header);
+
+    for (const auto& header : req.headers)
+        request.insert(header.key, header.value);
 
-        if constexpr (use_ssl)
+    return request;
+}
+
+template <bool use_ssl>
+asio::awaitable<Request_Result> run_http_request(Outgoing_Request req,
+                                                 std::string& phase,
+                                                 Request_Deadline& deadline)
+{
+    using R = Request_Result;
+    using Error = R::Error;
+
+    auto& pool = Client_Runtime::shared().connections();
+    const auto key = Connection_Key::for_request(req);
+
+    try
+    {
+        // Given back once the connection is back in the pool or closed
+        const auto slot = co_await pool.acquire_slot(key);
+
+        auto conn = pool.checkout<use_ssl>(key);
+        bool reused = conn != nullptr;
+
+        const auto request = build_request(req);
+
+        Receive_Result resp;
+        while (true)
         {
-            phase = "SSL shutdown";
-            auto [_] = co_await stream.async_shutdown(
-                asio::as_tuple(asio::use_awaitable));
-            // ignore a failure here;
-            // I got my result, so everything is _fine_ here too.
+            if (not conn)
+            {
+                auto opened = co_await open_connection<use_ssl>(req, phase);
+                if (not opened.has_value())
+                    co_return std::unexpected{std::move(opened).error()};
+                conn = std::move(opened).value();
+            }
+
+            bool stale = false;
+            resp = co_await exchange(conn->stream, request, req, phase, stale,
+                                     deadline);
+
+            // The server may have closed an idle connection just as it was
+            // taken from the pool, so that gets one more try on a new one.
+            // The server may also have acted on the request before closing,
+            // so only a request that is safe to repeat is tried again.
+            if (resp.has_value()
+                || not reused
+                || not stale
+                || not is_idempotent(req.method))
+                break;
+            conn.reset();
+            reused = false;
         }
 
-        phase = "close";
-        system::error_code close_err;
-        shutdown_socket(beast::get_lowest_layer(stream).socket(), close_err);
+        if (not resp.has_value())
+            co_return std::unexpected{std::move(resp).error()};
 
-        // ignore a graceless close; I got my result, so everything is _fine_.
+        if (resp->keep_alive)
+            pool.release<use_ssl>(key, std::move(conn));
+        else
+            co_await close_connection(*conn, phase);
 
         R::Reply reply;
-        reply.code = resp.result_int();
-        for (const auto& field : resp.base())
+        reply.code = resp->head.result_int();
+        for (const auto& field : resp->head)
         {
             reply.headers.emplace_back(field.name_string(), field.value());
         }
-        reply.body = beast::buffers_to_string(resp.body().data());
+        reply.body = std::move(resp->body);
 
         co_return reply;
     }
@@ -274,37 +751,29 @@ asio::awaitable<Request_Result> run_http_request(Outgoing_Request req,
     }
 }
 
-asio::awaitable<Request_Result> run_request(Outgoing_Request req,
-                                            std::atomic<bool>& ready)
+asio::awaitable<Request_Result> run_request(Outgoing_Request req)
 {
     using R = Request_Result;
     using Error = R::Error;
 
-    BOOST_SCOPE_EXIT_ALL(&)
-    {
-        // Either success or fail is considered "result ready"
-        // at the Frost user level
-        // *Even a timeout* is "result ready"
-        ready = true;
-    };
-
     auto ex = co_await asio::this_coro::executor;
 
-    asio::steady_timer timeout_timer{ex};
-    timeout_timer.expires_after(req.timeout);
+    // A streamed body moves the deadline on as it arrives
+    Request_Deadline deadline{ex, req.timeout};
 
     std::string phase = "begin";
 
     auto do_request = [&] -> asio::awaitable<Request_Result> {
         if (req.uri.tls)
-            co_return co_await run_http_request<true>(std::move(req), phase);
-        co_return co_await run_http_request<false>(std::move(req), phase);
+            co_return co_await run_http_request<true>(std::move(req), phase,
+                                                      deadline);
+        co_return co_await run_http_request<false>(std::move(req), phase,
+                                                   deadline);
     };
 
     auto [order, _, except, result] =
         co_await asio::experimental::make_parallel_group(
-            asio::co_spawn(ex, timeout_timer.async_wait(asio::use_awaitable),
-                           asio::deferred),
+            asio::co_spawn(ex, deadline.expired(), asio::deferred),
             asio::co_spawn(ex, do_request(), asio::deferred))
             .async_wait(asio::experimental::wait_for_one(), asio::deferred);
 
@@ -330,6 +799,40 @@ asio::awaitable<Request_Result> run_request(Outgoing_Request req,
     }
 }
 
+Value_Ptr headers_to_value(std::vector<Header> headers)
+{
+    for (auto& [key, _] : headers)
+        boost::algorithm::to_lower(key); // normalize
+
+    std::ranges::stable_sort(headers, {}, &Header::key);
+
+    Map headers_out;
+
+    for (auto group : headers
+                          | std::views::chunk_by([](const auto& a,
+                                                    const auto& b) {
+                                return a.key == b.key;
+                            }))
+    {
+        auto values = group
+                      | std::views::transform(&Header::value)
+                      | std::views::as_rvalue
+                      | std::views::transform(BOOST_HOF_LIFT(Value::create))
+                      | std::ranges::to<std::vector<Value_Ptr>>();
+
+        Value_Ptr header_map_value;
+        if (values.size() == 1)
+            header_map_value = values.at(0);
+        else
+            header_map_value = Value::create(std::move(values));
+
+        headers_out.emplace(Value::create(std::move(group.front().key)),
+                            std::move(header_map_value));
+    }
+
+    return Value::create(Value::trusted, std::move(headers_out));
+}
+
 Value_Ptr request_result_to_value(Request_Result&& request_result)
 {
     STRINGS(ok, error, category, message, phase, response, code, headers, body);
@@ -341,41 +844,12 @@ Value_Ptr request_result_to_value(Request_Result&& request_result)
         auto& resp = request_result.result.value();
         Map response_map{
             {strings.code, Value::create(Int{resp.code})},
-            {strings.body, Value::create(std::move(resp.body))},
+            {strings.body, resp.body ? Value::create(std::move(*resp.body))
+                                     : Value::null()},
         };
 
-        for (auto& [key, _] : resp.headers)
-            boost::algorithm::to_lower(key); // normalize
-
-        std::ranges::stable_sort(resp.headers, {}, &Header::key);
-
-        Map headers_out;
-
-        for (auto group :
-             resp.headers
-                 | std::views::chunk_by([](const auto& a, const auto& b) {
-                       return a.key == b.key;
-                   }))
-        {
-            auto values = group
-                          | std::views::transform(&Header::value)
-                          | std::views::as_rvalue
-                          | std::views::transform(BOOST_HOF_LIFT(Value::create))
-                          | std::ranges::to<std::vector<Value_Ptr>>();
-
-            Value_Ptr header_map_value;
-            if (values.size() == 1)
-                header_map_value = values.at(0);
-            else
-                header_map_value = Value::create(std::move(values));
-
-            headers_out.emplace(Value::create(std::move(group.front().key)),
-                                std::move(header_map_value));
-        }
-
-        response_map.emplace(
-            strings.headers,
-            Value::create(Value::trusted, std::move(headers_out)));
+        response_map.emplace(strings.headers,
+                             headers_to_value(std::move(resp.headers)));
 
         top.emplace(strings.response,
                     Value::create(Value::trusted, std::move(response_map)));
@@ -397,23 +871,190 @@ Value_Ptr request_result_to_value(Request_Result&& request_result)
     return Value::create(Value::trusted, std::move(top));
 }
 
-using Request_Task = async::Task<Request_Result, request_result_to_value>;
+using Request_Task = async::Future<Request_Result, request_result_to_value>;
 
 std::shared_ptr<Request_Task> async_do_http_request(Outgoing_Request&& request)
 {
     auto task = std::make_shared<Request_Task>();
 
-    task->future = asio::co_spawn(
-        task->ioc, run_request(std::move(request), task->complete),
-        asio::use_future);
+    std::promise<Request_Result> promise;
+    task->future = promise.get_future();
 
-    task->worker = std::jthread([&ioc = task->ioc] {
-        ioc.run();
-    });
+    // The task is held until the request is done, even if its script has
+    // dropped it by then
+    auto on_done = [task, promise = std::move(promise)](
+                       std::exception_ptr error,
+                       Request_Result result) mutable {
+        if (error)
+            promise.set_exception(error);
+        else
+            promise.set_value(std::move(result));
+
+        // Either success or fail is considered "result ready"
+        // at the Frost user level
+        // *Even a timeout* is "result ready"
+        task->complete = true;
+    };
+
+    asio::co_spawn(Client_Runtime::shared().make_strand(),
+                   run_request(std::move(request)), std::move(on_done));
 
     return task;
 }
 
+namespace
+{
+
+struct Batch_Options
+{
+    std::size_t concurrency = 8;
+    Int retries = 0;
+    std::chrono::milliseconds backoff{100};
+    bool retry_any_method = false;
+};
+
+// The longest wait between retries, however many there have been
+constexpr std::chrono::milliseconds max_backoff{60'000};
+
+// Whether a failed request may have reached the server before it failed
+bool may_have_been_sent(const Request_Result::Error& err)
+{
+    static constexpr std::array<std::string_view, 5> unsent_phases{
+        "begin", "DNS", "SNI", "connect", "SSL"};
+    return not std::ranges::contains(unsent_phases, err.phase);
+}
+
+// Failures the same request might not hit a moment later. A request the
+// server may have acted on is only sent again if doing so is harmless, or
+// the caller has said it is.
+bool should_retry(const Outgoing_Request& req, const Request_Result& result,
+                  const Batch_Options& options)
+{
+    const bool repeatable =
+        options.retry_any_method || is_idempotent(req.method);
+
+    if (not result.result.has_value())
+    {
+        const auto& err = result.result.error();
+
+        // A sink that failed would only fail again
+        if (err.category == "body")
+            return false;
+        return repeatable || not may_have_been_sent(err);
+    }
+
+    const auto code = result.result->code;
+    return repeatable
+           && (code == 429 || code == 502 || code == 503 || code == 504);
+}
+
+asio::awaitable<Request_Result> run_with_retries(const Outgoing_Request& req,
+                                                 const Batch_Options& options)
+{
+    auto backoff = options.backoff;
+    for (Int attempt = 0;; ++attempt)
+    {
+        auto result = co_await run_request(req);
+        if (attempt == options.retries
+            || not should_retry(req, result, options))
+            co_return result;
+
+        asio::steady_timer timer{co_await asio::this_coro::executor, backoff};
+        co_await timer.async_wait(asio::use_awaitable);
+        backoff = std::min(backoff * 2, max_backoff);
+    }
+}
+
+Value_Ptr batch_results_to_value(std::vector<Request_Result>&& results)
+{
+    return Value::create(results
+                         | std::views::as_rvalue
+                         | std::views::transform(request_result_to_value)
+                         | std::ranges::to<Array>());
+}
+
+using Batch_Task =
+    async::Future<std::vector<Request_Result>, batch_results_to_value>;
+
+// Shared by the workers of one request_all. Each worker takes the next
+// request not yet started, so no more than one per worker is ever in flight.
+struct Batch
+{
+    std::vector<Outgoing_Request> requests;
+    Batch_Options options;
+    std::shared_ptr<Batch_Task> task;
+
+    std::vector<Request_Result> results =
+        std::vector<Request_Result>(requests.size());
+    std::atomic<std::size_t> next = 0;
+    std::atomic<std::size_t> running = 0;
+    std::promise<std::vector<Request_Result>> promise;
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    void finish_worker(std::exception_ptr worker_error)
+    {
+        if (worker_error)
+        {
+            std::lock_guard lock{error_mutex};
+            if (not error)
+                error = worker_error;
+        }
+
+        if (--running > 0)
+            return;
+
+        if (error)
+            promise.set_exception(error);
+        else
+            promise.set_value(std::move(results));
+        task->complete = true;
+    }
+};
+
+asio::awaitable<void> run_batch_worker(std::shared_ptr<Batch> batch)
+{
+    for (auto i = batch->next++; i < batch->requests.size();
+         i = batch->next++)
+    {
+        batch->results[i] =
+            co_await run_with_retries(batch->requests[i], batch->options);
+    }
+}
+
+} // namespace
+
+std::shared_ptr<Batch_Task> async_do_http_requests(
+    std::vector<Outgoing_Request>&& requests, const Batch_Options& options)
+{
+    auto batch = std::make_shared<Batch>(std::move(requests), options,
+                                         std::make_shared<Batch_Task>());
+    batch->task->future = batch->promise.get_future();
+
+    const auto workers =
+        std::min(options.concurrency, batch->requests.size());
+    if (workers == 0)
+    {
+        batch->promise.set_value({});
+        batch->task->complete = true;
+        return batch->task;
+    }
+
+    // Set before any worker starts, so that none can see it reach 0 early
+    batch->running = workers;
+    for (std::size_t i = 0; i < workers; ++i)
+    {
+        asio::co_spawn(Client_Runtime::shared().make_strand(),
+                       run_batch_worker(batch),
+                       [batch](std::exception_ptr error) {
+                           batch->finish_worker(std::move(error));
+                       });
+    }
+
+    return batch->task;
+}
+
 namespace
 {
 // lil helper for optional::or_else :)
@@ -576,13 +1217,13 @@ Outgoing_Request::URI parse_uri(const Value_Ptr& uri_spec_val)
     return uri;
 }
 
-namespace
-{
-
-std::vector<Header> parse_headers(const Value_Ptr& headers_spec)
+std::vector<Header> parse_headers(const Value_Ptr& headers_spec,
+                                  std::string_view fn_name,
+                                  std::string_view managed_by)
 {
     if (not headers_spec->is<Map>())
-        throw Frost_Recoverable_Error{"http.request: headers must be a Map"};
+        throw Frost_Recoverable_Error{
+            fmt::format("{}: headers must be a Map", fn_name)};
 
     const auto& headers = headers_spec->raw_get<Map>();
 
@@ -596,9 +1237,9 @@ std::vector<Header> parse_headers(const Value_Ptr& headers_spec)
         if (not k_val->is<String>())
         {
             throw Frost_Recoverable_Error{
-                fmt::format("http.request: headers Map keys must be "
+                fmt::format("{}: headers Map keys must be "
                             "Strings, got {}",
-                            k_val->type_name())};
+                            fn_name, k_val->type_name())};
         }
 
         const auto& key = k_val->raw_get<String>();
@@ -607,9 +1248,9 @@ std::vector<Header> parse_headers(const Value_Ptr& headers_spec)
                                     return boost::iequals(key, forbidden);
                                 }))
         {
-            throw Frost_Recoverable_Error{fmt::format(
-                "http.request: header '{}' is managed by the HTTP client",
-                key)};
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: header '{}' is managed by {}", fn_name,
+                            key, managed_by)};
         }
 
         if (v_val->is<String>())
@@ -624,16 +1265,16 @@ std::vector<Header> parse_headers(const Value_Ptr& headers_spec)
                 result.emplace_back(
                     key, val->get<String>()
                              .or_else(thrower(fmt::format(
-                                 "http.request: headers Array values "
+                                 "{}: headers Array values "
                                  "must be Strings, got {}",
-                                 val->type_name())))
+                                 fn_name, val->type_name())))
                              .value());
             }
         }
         else
         {
             throw Frost_Recoverable_Error{
-                fmt::format("http.request: headers got unexpected value: {}",
+                fmt::format("{}: headers got unexpected value: {}", fn_name,
                             v_val->to_internal_string())};
         }
     }
@@ -641,6 +1282,71 @@ std::vector<Header> parse_headers(const Value_Ptr& headers_spec)
     return result;
 }
 
+namespace
+{
+
+std::function<Body_Sink()> file_sink(std::string path)
+{
+    return [path = std::move(path)] {
+        auto file = std::make_shared<std::ofstream>(
+            path, std::ios::binary | std::ios::trunc);
+        if (not file->is_open())
+            throw Frost_Recoverable_Error{
+                fmt::format("failed to open body_file: {}", path)};
+
+        const auto check = [file, path] {
+            if (not *file)
+                throw Frost_Recoverable_Error{
+                    fmt::format("failed to write body_file: {}", path)};
+        };
+
+        return Body_Sink{
+            .write =
+                [file, check](std::string_view chunk) {
+                    file->write(chunk.data(),
+                                static_cast<std::streamsize>(chunk.size()));
+                    check();
+                },
+            .finish =
+                [file, check] {
+                    file->close();
+                    check();
+                },
+        };
+    };
+}
+
+// Each chunk goes to a Function, or to the write method of an io writer
+std::function<Body_Sink()> callback_sink(const Value_Ptr& target)
+{
+    auto fn = [&] {
+        if (target->is<Function>())
+            return target->raw_get<Function>();
+
+        if (target->is<Map>())
+        {
+            const auto& methods = target->raw_get<Map>();
+            auto it = methods.find(Value::create(String{"write"}));
+            if (it != methods.end() && it->second->is<Function>())
+                return it->second->raw_get<Function>();
+        }
+
+        throw Frost_Recoverable_Error{
+            fmt::format("http.request: on_chunk must be a Function or a "
+                        "writer with a write method, got {}",
+                        target->type_name())};
+    }();
+
+    return [fn = std::move(fn)] {
+        return Body_Sink{
+            .write =
+                [fn](std::string_view chunk) {
+                    (void)fn->call({Value::create(String{chunk})});
+                },
+        };
+    };
+}
+
 beast::http::verb parse_method(const Value_Ptr& method_spec)
 {
     std::string method =
@@ -687,7 +1393,8 @@ Outgoing_Request parse_request(const Map& request_spec)
         }
         else if (key == "headers")
         {
-            request.headers = parse_headers(v_val);
+            request.headers =
+                parse_headers(v_val, "http.request", "the HTTP client");
         }
         else if (key == "method")
         {
@@ -736,6 +1443,22 @@ Outgoing_Request parse_request(const Map& request_spec)
                     .or_else(thrower("http.request: ca_path must be a String"))
                     .value();
         }
+        else if (key == "body_file" || key == "on_chunk")
+        {
+            if (request.open_body_sink)
+                throw Frost_Recoverable_Error{
+                    "http.request: only one of body_file and on_chunk may be "
+                    "given"};
+
+            if (key == "body_file")
+                request.open_body_sink = file_sink(
+                    v_val->get<String>()
+                        .or_else(thrower(
+                            "http.request: body_file must be a String"))
+                        .value());
+            else
+                request.open_body_sink = callback_sink(v_val);
+        }
         else if (key == "use_system_ca")
         {
             request.use_system_ca =
@@ -767,23 +1490,85 @@ Value_Ptr do_http_request(const Map& request_spec)
     std::shared_ptr<Request_Task> task =
         async_do_http_request(std::move(request));
 
-    STRINGS(get, is_ready);
+    return async::make_future_value(std::move(task), "http.request");
+}
+
+namespace
+{
+
+Batch_Options parse_batch_options(const Map& options_spec)
+{
+    Batch_Options options;
+
+    for (const auto& [k_val, v_val] : options_spec)
+    {
+        if (not k_val->is<String>())
+        {
+            throw Frost_Recoverable_Error{
+                fmt::format("http.request_all: unexpected option: {}",
+                            k_val->to_internal_string({.in_structure = true}))};
+        }
+
+        const auto& key = k_val->raw_get<String>();
 
-    auto get = system_closure([task](builtin_args_t args) {
-        REQUIRE_NULLARY("http.request.get");
-        return task->get();
-    });
+        const auto get_int = [&](Int min,
+                                 Int max = std::numeric_limits<Int>::max()) {
+            auto value = v_val->get<Int>()
+                             .or_else(thrower<Int>(fmt::format(
+                                 "http.request_all: {} must be an Int", key)))
+                             .value();
+            if (value < min)
+                throw Frost_Recoverable_Error{fmt::format(
+                    "http.request_all: {} must be at least {}", key, min)};
+            if (value > max)
+                throw Frost_Recoverable_Error{fmt::format(
+                    "http.request_all: {} must be at most {}", key, max)};
+            return value;
+        };
 
-    auto is_ready = system_closure([task](builtin_args_t args) {
-        REQUIRE_NULLARY("http.request.is_ready");
-        return task->is_ready();
-    });
+        if (key == "concurrency")
+            options.concurrency = static_cast<std::size_t>(get_int(1));
+        else if (key == "retries")
+            options.retries = get_int(0);
+        else if (key == "backoff_ms")
+            options.backoff =
+                std::chrono::milliseconds{get_int(0, max_backoff.count())};
+        else if (key == "retry_any_method")
+            options.retry_any_method =
+                v_val->get<Bool>()
+                    .or_else(thrower<Bool>(
+                        "http.request_all: retry_any_method must be a Bool"))
+                    .value();
+        else
+            throw Frost_Recoverable_Error{fmt::format(
+                "http.request_all: got unexpected option: {}", key)};
+    }
+
+    return options;
+}
+
+} // namespace
+
+Value_Ptr do_http_request_all(const Array& request_specs,
+                              const Map& options_spec)
+{
+    auto options = parse_batch_options(options_spec);
+
+    // Every spec is checked before any request is sent
+    std::vector<Outgoing_Request> requests;
+    requests.reserve(request_specs.size());
+    for (const auto& spec : request_specs)
+    {
+        if (not spec->is<Map>())
+            throw Frost_Recoverable_Error{fmt::format(
+                "http.request_all: requests must be Maps, got {}",
+                spec->type_name())};
+        requests.push_back(parse_request(spec->raw_get<Map>()));
+    }
 
-    return Value::create(Value::trusted,
-                         Map{
-                             {strings.get, std::move(get)},
-                             {strings.is_ready, std::move(is_ready)},
-                         });
+    return async::make_future_value(
+        async_do_http_requests(std::move(requests), options),
+        "http.request_all");
 }
 
 } // namespace frst::http
@@ -7,7 +7,11 @@
 
 #include <chrono>
 #include <expected>
+#include <functional>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <boost/asio/io_context.hpp>
 #include <boost/beast/http/verb.hpp>
@@ -21,6 +25,13 @@ struct Header
     std::string value;
 };
 
+// Where a streamed response body goes, one piece at a time as it arrives
+struct Body_Sink
+{
+    std::function<void(std::string_view)> write;
+    std::function<void()> finish = [] {};
+};
+
 struct Outgoing_Request
 {
     struct URI
@@ -48,6 +59,10 @@ struct Outgoing_Request
     std::optional<std::string> ca_file;
     std::optional<std::string> ca_path;
     bool use_system_ca = true;
+
+    // Set to stream the response body rather than collect it. Called once
+    // the response head has arrived; a request is never retried after that.
+    std::function<Body_Sink()> open_body_sink;
 };
 
 struct Request_Result
@@ -63,7 +78,7 @@ struct Request_Result
     {
         std::uint32_t code;
         std::vector<Header> headers;
-        std::string body;
+        std::optional<std::string> body; // unset when the body was streamed
     };
 
     // result.has_value() == ok at top-level of Frost result map
@@ -71,7 +86,20 @@ struct Request_Result
 };
 
 Outgoing_Request::URI parse_uri(const Value_Ptr& uri_spec_val);
+
+// Headers as a Frost Map, from lowercased names to a String, or an Array of
+// Strings for repeated headers
+Value_Ptr headers_to_value(std::vector<Header> headers);
+
+// The reverse of headers_to_value. Host, Content-Length and
+// Transfer-Encoding are rejected, as managed_by sets them itself. Errors are
+// reported as coming from fn_name.
+std::vector<Header> parse_headers(const Value_Ptr& headers_spec,
+                                  std::string_view fn_name,
+                                  std::string_view managed_by);
 Value_Ptr do_http_request(const Map& request_spec);
+Value_Ptr do_http_request_all(const Array& request_specs,
+                              const Map& options_spec);
 } // namespace frst::http
 
 #endif
@@ -0,0 +1,617 @@
+#include "server.hpp"
+
+#include "request.hpp"
+
+#include <frost/builtins-common.hpp>
+#include <frost/thread-pool.hpp>
+#include <frost/value.hpp>
+
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <boost/url.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <thread>
+#include <vector>
+
+namespace frst::http
+{
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace system = boost::system;
+namespace urls = boost::urls;
+using tcp = asio::ip::tcp;
+
+namespace
+{
+
+using Incoming_Request = beast::http::request<beast::http::string_body>;
+using Outgoing_Response = beast::http::response<beast::http::string_body>;
+
+// Idle keep-alive connections are closed after this long
+constexpr auto idle_timeout = std::chrono::seconds{30};
+
+struct Server_Config
+{
+    std::string host = "127.0.0.1";
+    std::uint16_t port = 0;
+    Function handler;
+    std::optional<Function> on_error;
+    std::size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    std::optional<std::size_t> queue_limit;
+};
+
+Server_Config parse_server_config(const Map& config_spec)
+{
+    Server_Config config;
+
+    // required fields checklist
+    bool port_read = false;
+    bool handler_read = false;
+
+    for (const auto& [k_val, v_val] : config_spec)
+    {
+        if (not k_val->is<String>())
+        {
+            throw Frost_Recoverable_Error{
+                fmt::format("http.serve: unexpected key: {}",
+                            k_val->to_internal_string({.in_structure = true}))};
+        }
+
+        const auto& key = k_val->raw_get<String>();
+
+        const auto get_int = [&](Int min, Int max) {
+            if (not v_val->is<Int>())
+                throw Frost_Recoverable_Error{
+                    fmt::format("http.serve: {} must be an Int", key)};
+
+            const auto value = v_val->raw_get<Int>();
+            if (value < min || value > max)
+                throw Frost_Recoverable_Error{
+                    fmt::format("http.serve: {} value {} is out of range",
+                                key, value)};
+            return value;
+        };
+
+        if (key == "port")
+        {
+            port_read = true;
+            config.port = static_cast<std::uint16_t>(
+                get_int(0, std::numeric_limits<std::uint16_t>::max()));
+        }
+        else if (key == "handler")
+        {
+            if (not v_val->is<Function>())
+                throw Frost_Recoverable_Error{
+                    "http.serve: handler must be a Function"};
+            handler_read = true;
+            config.handler = v_val->raw_get<Function>();
+        }
+        else if (key == "on_error")
+        {
+            if (not v_val->is<Function>())
+                throw Frost_Recoverable_Error{
+                    "http.serve: on_error must be a Function"};
+            config.on_error = v_val->raw_get<Function>();
+        }
+        else if (key == "host")
+        {
+            if (not v_val->is<String>())
+                throw Frost_Recoverable_Error{
+                    "http.serve: host must be a String"};
+            config.host = v_val->raw_get<String>();
+        }
+        else if (key == "workers")
+        {
+            config.workers = static_cast<std::size_t>(get_int(1, 1024));
+        }
+        else if (key == "queue_limit")
+        {
+            config.queue_limit = static_cast<std::size_t>(
+                get_int(1, std::numeric_limits<Int>::max()));
+        }
+        else
+        {
+            throw Frost_Recoverable_Error{
+                fmt::format("http.serve: got unexpected key: {}", key)};
+        }
+    }
+
+    if (not port_read)
+        throw Frost_Recoverable_Error{
+            "http.serve: missing required field: port"};
+
+    if (not handler_read)
+        throw Frost_Recoverable_Error{
+            "http.serve: missing required field: handler"};
+
+    return config;
+}
+
+// The request as a Map of the same shape http.request takes
+Value_Ptr request_to_value(Incoming_Request& req, const tcp::endpoint& local)
+{
+    STRINGS(method, uri, host, port, path, query, tls, headers, body);
+
+    std::string host = local.address().to_string();
+    if (auto host_field = req.find(beast::http::field::host);
+        host_field != req.end())
+    {
+        auto authority = urls::parse_authority(host_field->value());
+        if (authority.has_value())
+            host = std::string{authority->host_address()};
+    }
+
+    Map uri_map{
+        {strings.host, Value::create(std::move(host))},
+        {strings.port, Value::create(Int{local.port()})},
+        {strings.tls, Value::create(false)},
+    };
+
+    if (auto target = urls::parse_origin_form(req.target());
+        target.has_value())
+    {
+        uri_map.emplace(strings.path,
+                        Value::create(std::string{target->path()}));
+
+        // Repeated parameters become an Array, as http.request takes them
+        std::map<std::string, std::vector<std::optional<std::string>>> params;
+        for (const auto& param : target->params())
+        {
+            params[param.key].push_back(
+                param.has_value ? std::optional{param.value} : std::nullopt);
+        }
+
+        Map query_map;
+        for (auto& [key, values] : params)
+        {
+            Value_Ptr value;
+            if (values.size() == 1)
+                value = values.front() ? Value::create(std::move(*values[0]))
+                                       : Value::null();
+            else
+                value = Value::create(
+                    values
+                    | std::views::transform([](auto& value) {
+                          return Value::create(std::move(value).value_or(""));
+                      })
+                    | std::ranges::to<Array>());
+
+            query_map.emplace(Value::create(std::string{key}),
+                              std::move(value));
+        }
+
+        if (not query_map.empty())
+        {
+            uri_map.emplace(strings.query, Value::create(Value::trusted,
+                                                         std::move(query_map)));
+        }
+    }
+    else
+    {
+        uri_map.emplace(strings.path,
+                        Value::create(std::string{req.target()}));
+    }
+
+    std::vector<Header> headers;
+    for (const auto& field : req)
+        headers.emplace_back(field.name_string(), field.value());
+
+    return Value::create(
+        Value::trusted,
+        Map{
+            {strings.method, Value::create(std::string{req.method_string()})},
+            {strings.uri, Value::create(Value::trusted, std::move(uri_map))},
+            {strings.headers, headers_to_value(std::move(headers))},
+            {strings.body, Value::create(std::move(req.body()))},
+        });
+}
+
+Outgoing_Response plain_response(unsigned code, std::string body,
+                                 unsigned version, bool keep_alive)
+{
+    Outgoing_Response resp{static_cast<beast::http::status>(code), version};
+    resp.set(beast::http::field::content_type, "text/plain; charset=utf-8");
+    resp.body() = std::move(body);
+    resp.keep_alive(keep_alive);
+    resp.prepare_payload();
+    return resp;
+}
+
+// A handler replies with a Map of the same shape as http.request's response,
+// a String to send with code 200, or null to send nothing with code 204
+Outgoing_Response reply_to_response(const Value_Ptr& reply, unsigned version,
+                                    bool keep_alive)
+{
+    if (reply->is<Null>())
+    {
+        Outgoing_Response resp{beast::http::status::no_content, version};
+        resp.keep_alive(keep_alive);
+        return resp;
+    }
+
+    if (reply->is<String>())
+        return plain_response(200, reply->raw_get<String>(), version,
+                              keep_alive);
+
+    if (not reply->is<Map>())
+        throw Frost_Recoverable_Error{
+            fmt::format("http.serve: handler must return a Map, String or "
+                        "null, got {}",
+                        reply->type_name())};
+
+    Int code = 200;
+    std::vector<Header> headers;
+    std::string body;
+
+    for (const auto& [k_val, v_val] : reply->raw_get<Map>())
+    {
+        const auto key = k_val->get<String>().value_or("");
+
+        if (key == "code")
+        {
+            if (not v_val->is<Int>() || v_val->raw_get<Int>() < 100
+                || v_val->raw_get<Int>() > 599)
+            {
+                throw Frost_Recoverable_Error{
+                    "http.serve: reply code must be an Int from 100 to 599"};
+            }
+            code = v_val->raw_get<Int>();
+        }
+        else if (key == "headers")
+        {
+            headers = parse_headers(v_val, "http.serve", "the HTTP server");
+        }
+        else if (key == "body")
+        {
+            if (not v_val->is<String>())
+                throw Frost_Recoverable_Error{
+                    "http.serve: reply body must be a String"};
+            body = v_val->raw_get<String>();
+        }
+        else
+        {
+            throw Frost_Recoverable_Error{
+                fmt::format("http.serve: unexpected key in reply: {}",
+                            k_val->to_internal_string({.in_structure = true}))};
+        }
+    }
+
+    Outgoing_Response resp{static_cast<beast::http::status>(code), version};
+    for (const auto& header : headers)
+        resp.insert(header.key, header.value);
+    resp.body() = std::move(body);
+    resp.keep_alive(keep_alive);
+    resp.prepare_payload();
+    return resp;
+}
+
+// Requests that can't be parsed get an answer; any other read error means
+// the connection is gone
+std::optional<unsigned> read_error_code(const system::error_code& ec)
+{
+    if (ec == beast::http::error::body_limit)
+        return 413;
+
+    if (ec != beast::http::error::end_of_stream
+        && ec.category()
+               == beast::http::make_error_code(beast::http::error::need_more)
+                      .category())
+    {
+        return 400;
+    }
+
+    return std::nullopt;
+}
+
+//! @brief An HTTP server running a Frost function for every request
+//!
+//! One thread does all the network I/O, and hands each request to a pool of
+//! workers to run the handler. When queue_limit requests are already waiting
+//! for or being handled by a worker, further requests get a 503 straight
+//! away rather than queueing without bound.
+class Server
+{
+  public:
+    explicit Server(Server_Config config)
+        : shared_{std::make_shared<Shared>(std::move(config.handler),
+                                           std::move(config.on_error))}
+        , queue_limit_{config.queue_limit.value_or(config.workers * 16)}
+        , acceptor_{shared_->ioc}
+        , workers_{config.workers}
+    {
+        try
+        {
+            const tcp::endpoint endpoint{asio::ip::make_address(config.host),
+                                         config.port};
+            acceptor_.open(endpoint.protocol());
+            acceptor_.set_option(asio::socket_base::reuse_address{true});
+            acceptor_.bind(endpoint);
+            acceptor_.listen();
+        }
+        catch (const system::system_error& e)
+        {
+            throw Frost_Recoverable_Error{
+                fmt::format("http.serve: failed to listen on {}:{}: {}",
+                            config.host, config.port, e.code().message())};
+        }
+
+        port_ = acceptor_.local_endpoint().port();
+
+        asio::co_spawn(shared_->ioc, accept_connections(), asio::detached);
+        io_thread_ = std::jthread{[this] { shared_->ioc.run(); }};
+    }
+
+    ~Server()
+    {
+        stop();
+    }
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    std::uint16_t port() const
+    {
+        return port_;
+    }
+
+    // Stop accepting and drop every open connection. Handlers already
+    // running are left to finish.
+    void stop()
+    {
+        {
+            std::lock_guard lock{stop_mutex_};
+            if (stopped_)
+                return;
+            stopped_ = true;
+        }
+
+        shared_->ioc.stop();
+        if (io_thread_.joinable())
+            io_thread_.join();
+
+        stopped_cv_.notify_all();
+    }
+
+    void wait()
+    {
+        std::unique_lock lock{stop_mutex_};
+        stopped_cv_.wait(lock, [&] { return stopped_; });
+    }
+
+  private:
+    asio::awaitable<void> accept_connections()
+    {
+        while (true)
+        {
+            auto [err, socket] = co_await acceptor_.async_accept(
+                asio::as_tuple(asio::use_awaitable));
+
+            if (err == asio::error::operation_aborted)
+                co_return;
+            if (err)
+                continue;
+
+            asio::co_spawn(
+                shared_->ioc,
+                serve_connection(beast::tcp_stream{std::move(socket)}),
+                asio::detached);
+        }
+    }
+
+    asio::awaitable<void> serve_connection(beast::tcp_stream stream)
+    {
+        system::error_code ec;
+        const auto local = stream.socket().local_endpoint(ec);
+        if (ec)
+            co_return;
+
+        beast::flat_buffer buf;
+        while (true)
+        {
+            beast::http::request_parser<beast::http::string_body> parser;
+
+            stream.expires_after(idle_timeout);
+            auto [read_err, _] = co_await beast::http::async_read(
+                stream, buf, parser, asio::as_tuple(asio::use_awaitable));
+
+            if (read_err)
+            {
+                if (auto code = read_error_code(read_err))
+                {
+                    auto resp = plain_response(
+                        *code,
+                        *code == 413 ? "Payload Too Large\n" : "Bad Request\n",
+                        11, false);
+                    co_await beast::http::async_write(
+                        stream, resp, asio::as_tuple(asio::use_awaitable));
+                }
+                break;
+            }
+
+            auto req = parser.release();
+            const bool keep_alive = req.keep_alive();
+
+            // Handlers take as long as they take
+            stream.expires_never();
+            auto resp = co_await respond(std::move(req), local);
+
+            stream.expires_after(idle_timeout);
+            auto [write_err, _] = co_await beast::http::async_write(
+                stream, resp, asio::as_tuple(asio::use_awaitable));
+
+            if (write_err || not keep_alive || resp.need_eof())
+                break;
+        }
+
+        stream.socket().shutdown(tcp::socket::shutdown_send, ec);
+    }
+
+    asio::awaitable<Outgoing_Response> respond(Incoming_Request req,
+                                               tcp::endpoint local)
+    {
+        const auto version = req.version();
+        const bool keep_alive = req.keep_alive();
+
+        if (shared_->queued++ >= queue_limit_)
+        {
+            --shared_->queued;
+            co_return plain_response(503, "Service Unavailable\n", version,
+                                     keep_alive);
+        }
+
+        // The worker posts the response back, to resume this coroutine on
+        // the I/O thread
+        auto run_on_worker = [&](auto handler) {
+            auto work = asio::make_work_guard(asio::get_associated_executor(
+                handler, shared_->ioc.get_executor()));
+
+            workers_.post([shared = shared_, req = std::move(req), local,
+                           handler = std::move(handler),
+                           work = std::move(work)]() mutable {
+                auto resp = shared->run_handler(req, local);
+                --shared->queued;
+
+                asio::post(work.get_executor(),
+                           [handler = std::move(handler),
+                            resp = std::move(resp)]() mutable {
+                               std::move(handler)(std::move(resp));
+                           });
+                work.reset();
+            });
+        };
+
+        co_return co_await asio::async_initiate<
+            decltype(asio::use_awaitable), void(Outgoing_Response)>(
+            std::move(run_on_worker), asio::use_awaitable);
+    }
+
+    // What the workers' jobs use. A handler that drops the last reference
+    // to the server destroys it on that handler's own worker, so each job
+    // keeps this alive itself, as thread_pool's spawn keeps its pool alive
+    struct Shared
+    {
+        Shared(Function handler, std::optional<Function> on_error)
+            : handler{std::move(handler)}
+            , on_error{std::move(on_error)}
+        {
+        }
+
+        Outgoing_Response run_handler(Incoming_Request& req,
+                                      const tcp::endpoint& local)
+        {
+            const auto version = req.version();
+            const bool keep_alive = req.keep_alive();
+
+            Value_Ptr request = Value::null();
+            try
+            {
+                request = request_to_value(req, local);
+                return reply_to_response(handler->call({request}), version,
+                                         keep_alive);
+            }
+            catch (const std::exception& e)
+            {
+                return error_response(e.what(), request, version, keep_alive);
+            }
+        }
+
+        // A handler that failed is answered by on_error if there is one,
+        // and otherwise with a bare 500, as is an on_error that fails in
+        // turn. What went wrong goes to on_error and to stderr, never to the
+        // client.
+        Outgoing_Response error_response(std::string_view error,
+                                         const Value_Ptr& request,
+                                         unsigned version, bool keep_alive)
+        {
+            if (on_error)
+            {
+                try
+                {
+                    return reply_to_response(
+                        (*on_error)->call(
+                            {Value::create(String{error}), request}),
+                        version, keep_alive);
+                }
+                catch (const std::exception& e)
+                {
+                    fmt::println(stderr, "http.serve: on_error failed: {}",
+                                 e.what());
+                    return plain_response(500, "Internal Server Error\n",
+                                          version, keep_alive);
+                }
+            }
+
+            fmt::println(stderr, "http.serve: handler failed: {}", error);
+            return plain_response(500, "Internal Server Error\n", version,
+                                  keep_alive);
+        }
+
+        Function handler;
+        std::optional<Function> on_error;
+        std::atomic<std::size_t> queued = 0;
+        asio::io_context ioc;
+    };
+
+    std::shared_ptr<Shared> shared_;
+    std::size_t queue_limit_;
+
+    // Handlers still queued when the server is destroyed run before any of
+    // the members above go
+    tcp::acceptor acceptor_;
+    std::uint16_t port_ = 0;
+    Thread_Pool workers_;
+    std::jthread io_thread_;
+
+    std::mutex stop_mutex_;
+    std::condition_variable stopped_cv_;
+    bool stopped_ = false;
+};
+
+} // namespace
+
+Value_Ptr do_http_serve(const Map& config_spec)
+{
+    auto server = std::make_shared<Server>(parse_server_config(config_spec));
+
+    STRINGS(port, stop, wait);
+
+    auto port = system_closure([server](builtin_args_t args) {
+        REQUIRE_NULLARY("http.serve.port");
+        return Value::create(Int{server->port()});
+    });
+
+    auto stop = system_closure([server](builtin_args_t args) {
+        REQUIRE_NULLARY("http.serve.stop");
+        server->stop();
+        return Value::null();
+    });
+
+    auto wait = system_closure([server](builtin_args_t args) {
+        REQUIRE_NULLARY("http.serve.wait");
+        server->wait();
+        return Value::null();
+    });
+
+    return Value::create(Value::trusted,
+                         Map{
+                             {strings.port, std::move(port)},
+                             {strings.stop, std::move(stop)},
+                             {strings.wait, std::move(wait)},
+                         });
+}
+
+} // namespace frst::http
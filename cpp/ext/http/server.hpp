@@ -0,0 +1,15 @@
+#ifndef FROST_EXT_HTTP_SERVER_HPP
+#define FROST_EXT_HTTP_SERVER_HPP
+
+#include <frost/value.hpp>
+
+namespace frst::http
+{
+
+// Start serving HTTP as configured by config_spec, and get a Map to control
+// the server with
+Value_Ptr do_http_serve(const Map& config_spec);
+
+} // namespace frst::http
+
+#endif
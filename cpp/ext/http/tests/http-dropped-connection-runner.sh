@@ -0,0 +1,38 @@
+#!/usr/bin/env sh
+set -eu
+
+FROST_BIN=$1
+SCRIPT=$2
+
+case "$(printf '%s' "${FROST_SKIP_HTTP_TESTS:-}" | tr '[:lower:]' '[:upper:]')" in
+  1|ON|TRUE|YES)
+    echo "FROST_SKIP_HTTP_TESTS set; skipping"
+    exit 77
+    ;;
+esac
+
+if ! command -v python3 >/dev/null 2>&1; then
+  echo "python3 not available; skipping"
+  exit 77
+fi
+
+PORT_FILE=$(mktemp)
+python3 "$(dirname "$0")/http-dropping-server.py" >"$PORT_FILE" &
+SERVER_PID=$!
+trap 'kill "$SERVER_PID" 2>/dev/null || true; rm -f "$PORT_FILE"' EXIT
+
+# Wait for the server to report the port it is listening on
+for _ in $(seq 50); do
+  if [ -s "$PORT_FILE" ]; then
+    break
+  fi
+  sleep 0.1
+done
+
+PORT=$(head -n 1 "$PORT_FILE")
+if [ -z "$PORT" ]; then
+  echo "dropping server did not start"
+  exit 1
+fi
+
+DROP_SERVER_PORT="$PORT" "$FROST_BIN" "$SCRIPT"
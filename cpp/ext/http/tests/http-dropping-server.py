@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""A keep-alive HTTP server that hangs up on some requests without replying.
+
+A request for a path under /drop is read and then answered by closing the
+connection, unless it is the first request on that connection. A request
+for a path under /unavailable gets a 503 reply, and one under /slow is
+answered after a short wait. GET /count/<path> replies with how many
+requests for <path> have come in, and GET /peak with the most /slow
+requests that were ever being answered at once. The port is printed on the
+first line of output once the server is listening.
+"""
+
+import socket
+import sys
+import threading
+import time
+
+counts = {}
+counts_lock = threading.Lock()
+
+slow_active = 0
+slow_peak = 0
+
+
+def read_request(conn, buf):
+    while b"\r\n\r\n" not in buf:
+        data = conn.recv(4096)
+        if not data:
+            return None, buf
+        buf += data
+
+    head, _, buf = buf.partition(b"\r\n\r\n")
+    lines = head.decode("latin-1").split("\r\n")
+    method, path, _ = lines[0].split(" ", 2)
+
+    length = 0
+    for line in lines[1:]:
+        name, _, value = line.partition(":")
+        if name.strip().lower() == "content-length":
+            length = int(value.strip())
+
+    while len(buf) < length:
+        data = conn.recv(4096)
+        if not data:
+            return None, buf
+        buf += data
+
+    return (method, path), buf[length:]
+
+
+def reply(conn, body, status=b"200 OK"):
+    body = body.encode()
+    conn.sendall(
+        b"HTTP/1.1 %s\r\nContent-Length: %d\r\n\r\n%s"
+        % (status, len(body), body)
+    )
+
+
+def answer_slowly(conn):
+    global slow_active, slow_peak
+
+    with counts_lock:
+        slow_active += 1
+        slow_peak = max(slow_peak, slow_active)
+
+    time.sleep(0.2)
+
+    with counts_lock:
+        slow_active -= 1
+    reply(conn, "ok")
+
+
+def serve(conn):
+    with conn:
+        buf = b""
+        first = True
+        while True:
+            request, buf = read_request(conn, buf)
+            if request is None:
+                return
+
+            _, path = request
+            with counts_lock:
+                counts[path] = counts.get(path, 0) + 1
+
+            if path.startswith("/count/"):
+                with counts_lock:
+                    seen = counts.get(path[len("/count"):], 0)
+                reply(conn, str(seen))
+            elif path.startswith("/drop") and not first:
+                conn.shutdown(socket.SHUT_RDWR)
+                return
+            elif path == "/peak":
+                with counts_lock:
+                    peak = slow_peak
+                reply(conn, str(peak))
+            elif path.startswith("/slow"):
+                answer_slowly(conn)
+            elif path.startswith("/unavailable"):
+                reply(conn, "try later", b"503 Service Unavailable")
+            else:
+                reply(conn, "ok")
+
+            first = False
+
+
+def main():
+    listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    listener.bind(("127.0.0.1", 0))
+    listener.listen()
+
+    print(listener.getsockname()[1], flush=True)
+
+    while True:
+        conn, _ = listener.accept()
+        threading.Thread(target=serve, args=(conn,), daemon=True).start()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
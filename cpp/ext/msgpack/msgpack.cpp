@@ -1,5 +1,6 @@
 #include <frost/data-builtin.hpp>
 #include <frost/extensions-common.hpp>
+#include <frost/map-builder.hpp>
 
 #include <msgpack.hpp>
 
@@ -98,7 +99,8 @@ Value_Ptr decode_object(const ::msgpack::object& obj)
     }
 
     case ::msgpack::type::MAP: {
-        Map result;
+        Map_Builder result;
+        result.reserve(obj.via.map.size);
         for (uint32_t i = 0; i < obj.via.map.size; ++i)
         {
             auto& kv = obj.via.map.ptr[i];
@@ -108,9 +110,9 @@ Value_Ptr decode_object(const ::msgpack::object& obj)
                     fmt::format("msgpack.decode: unsupported map key type {}. "
                                 "Frost map keys must be non-null primitives",
                                 key->type_name())};
-            result.try_emplace(std::move(key), decode_object(kv.val));
+            result.add(std::move(key), decode_object(kv.val));
         }
-        return Value::create(Value::trusted, std::move(result));
+        return Value::create(Value::trusted, std::move(result).build());
     }
 
     case ::msgpack::type::EXT:
@@ -2,6 +2,10 @@
 
 #include <extensions.h>
 
+#include <algorithm>
+#include <ranges>
+#include <vector>
+
 namespace frst::sqlite
 {
 
@@ -49,6 +53,16 @@ void Connection::close()
     std::lock_guard lock{mutex_};
     require_open_();
 
+    // A running statement is part way through its rows, and is stepped
+    // again as soon as the callback that called this returns
+    if (std::ranges::any_of(statements_ | std::views::values,
+                            [](const Stmt_Ptr& stmt) { return not stmt; }))
+    {
+        throw Frost_Recoverable_Error{
+            "cannot close connection while a prepared statement is running"};
+    }
+
+    statements_.clear();
     conn_.reset();
 }
 
@@ -77,6 +91,98 @@ Value_Ptr value_to_frost(sqlite3_value* val)
     }
 }
 
+Value_Ptr column_to_frost(sqlite3_stmt* s, int i)
+{
+    switch (sqlite3_column_type(s, i))
+    {
+    case SQLITE_INTEGER:
+        return Value::create(Int{sqlite3_column_int64(s, i)});
+    case SQLITE_FLOAT:
+        return Value::create(sqlite3_column_double(s, i));
+    case SQLITE_TEXT:
+        return Value::create(String{
+            reinterpret_cast<const char*>(sqlite3_column_text(s, i)),
+            static_cast<std::size_t>(sqlite3_column_bytes(s, i)),
+        });
+    case SQLITE_BLOB:
+        return Value::create(make_blob(Value::create(String{
+            static_cast<const char*>(sqlite3_column_blob(s, i)),
+            static_cast<std::size_t>(sqlite3_column_bytes(s, i)),
+        })));
+    case SQLITE_NULL:
+        return Value::null();
+    default:
+        THROW_UNREACHABLE;
+    }
+}
+
+//! @brief The result columns of a statement, named once for all its rows
+//!
+//! keys holds the column names in Map order, so the Map for each row is
+//! built straight from them rather than by inserting one column at a time.
+//! When a name repeats, the last column with that name wins.
+struct Row_Layout
+{
+    // Every column name, in column order
+    std::vector<Value_Ptr> names;
+    // The distinct names, sorted, and the column each one reads from
+    Map::key_container_type keys;
+    std::vector<int> columns;
+
+    static Row_Layout of(sqlite3_stmt* s)
+    {
+        constexpr auto less = Map::key_compare{};
+
+        Row_Layout layout;
+        const int num_cols = sqlite3_column_count(s);
+        layout.names.reserve(num_cols);
+        for (int i = 0; i != num_cols; ++i)
+            layout.names.push_back(
+                Value::create(String{sqlite3_column_name(s, i)}));
+
+        auto order = std::views::iota(0, num_cols)
+                     | std::ranges::to<std::vector>();
+        std::ranges::stable_sort(order, less, [&](int col) -> const auto& {
+            return layout.names.at(col);
+        });
+
+        for (int col : order)
+        {
+            const auto& name = layout.names.at(col);
+            // Sorted and stable, so a later duplicate replaces the earlier
+            if (not layout.keys.empty() && not less(layout.keys.back(), name))
+            {
+                layout.columns.back() = col;
+                continue;
+            }
+            layout.keys.push_back(name);
+            layout.columns.push_back(col);
+        }
+
+        return layout;
+    }
+
+    Value_Ptr read_map(sqlite3_stmt* s) const
+    {
+        Map::mapped_container_type values;
+        values.reserve(columns.size());
+        for (int col : columns)
+            values.push_back(column_to_frost(s, col));
+
+        return Value::create(Value::trusted,
+                             Map{std::sorted_unique, keys, std::move(values)});
+    }
+
+    Value_Ptr read_array(sqlite3_stmt* s) const
+    {
+        Array row;
+        row.reserve(names.size());
+        for (int i = 0; i != static_cast<int>(names.size()); ++i)
+            row.push_back(column_to_frost(s, i));
+        return Value::create(std::move(row));
+    }
+};
+
 void result_to_sqlite(sqlite3_context* ctx, const Value_Ptr& val)
 {
     val->visit(Overload{
@@ -264,6 +370,208 @@ void aggregate_destroy(void* user_data)
     delete static_cast<Aggregate_User_Data*>(user_data);
 }
 
+// The rows behind a table from Connection::register_table. They are only
+// ever read, so SQL can use them in place.
+struct Table_Data
+{
+    Value_Ptr rows;
+    std::vector<Value_Ptr> columns;
+
+    const Array& array() const
+    {
+        return rows->raw_get<Array>();
+    }
+};
+
+using Table_Data_Ptr = std::shared_ptr<const Table_Data>;
+
+struct Array_Table : sqlite3_vtab
+{
+    Table_Data_Ptr data;
+};
+
+struct Array_Cursor : sqlite3_vtab_cursor
+{
+    std::size_t index;
+};
+
+const Table_Data& table_data(sqlite3_vtab_cursor* cur)
+{
+    return *static_cast<Array_Table*>(cur->pVtab)->data;
+}
+
+std::string quote_identifier(const String& name)
+{
+    std::string quoted = "\"";
+    for (char c : name)
+    {
+        if (c == '"')
+            quoted += '"';
+        quoted += c;
+    }
+    quoted += '"';
+    return quoted;
+}
+
+int array_table_connect(sqlite3* db, void* aux, int, const char* const*,
+                        sqlite3_vtab** out, char** err)
+{
+    const auto& data = *static_cast<Table_Data_Ptr*>(aux);
+
+    std::string schema = "CREATE TABLE x(";
+    for (const auto& [idx, column] : std::views::enumerate(data->columns))
+    {
+        if (idx != 0)
+            schema += ", ";
+        schema += quote_identifier(column->raw_get<String>());
+    }
+    schema += ")";
+
+    int rc = sqlite3_declare_vtab(db, schema.c_str());
+    if (rc != SQLITE_OK)
+    {
+        *err = sqlite3_mprintf("%s", sqlite3_errmsg(db));
+        return rc;
+    }
+
+    auto* table = new Array_Table{};
+    table->data = data;
+    *out = table;
+    return SQLITE_OK;
+}
+
+int array_table_disconnect(sqlite3_vtab* vtab)
+{
+    delete static_cast<Array_Table*>(vtab);
+    return SQLITE_OK;
+}
+
+int array_table_best_index(sqlite3_vtab* vtab, sqlite3_index_info* info)
+{
+    // Every scan reads all rows, and SQLite filters them
+    const auto rows = static_cast<Array_Table*>(vtab)->data->array().size();
+    info->estimatedCost = static_cast<double>(rows);
+    info->estimatedRows = static_cast<sqlite3_int64>(rows);
+    return SQLITE_OK;
+}
+
+int array_table_open(sqlite3_vtab*, sqlite3_vtab_cursor** out)
+{
+    *out = new Array_Cursor{};
+    return SQLITE_OK;
+}
+
+int array_table_close(sqlite3_vtab_cursor* cur)
+{
+    delete static_cast<Array_Cursor*>(cur);
+    return SQLITE_OK;
+}
+
+int array_table_filter(sqlite3_vtab_cursor* cur, int, const char*, int,
+                       sqlite3_value**)
+{
+    static_cast<Array_Cursor*>(cur)->index = 0;
+    return SQLITE_OK;
+}
+
+int array_table_next(sqlite3_vtab_cursor* cur)
+{
+    ++static_cast<Array_Cursor*>(cur)->index;
+    return SQLITE_OK;
+}
+
+int array_table_eof(sqlite3_vtab_cursor* cur)
+{
+    return static_cast<Array_Cursor*>(cur)->index
+           >= table_data(cur).array().size();
+}
+
+int array_table_column(sqlite3_vtab_cursor* cur, sqlite3_context* ctx,
+                       int col)
+{
+    const auto& data = table_data(cur);
+    const auto& row =
+        data.array().at(static_cast<Array_Cursor*>(cur)->index)->raw_get<Map>();
+    const auto& column = data.columns.at(col);
+
+    auto it = row.find(column);
+    if (it == row.end())
+    {
+        sqlite3_result_null(ctx);
+        return SQLITE_OK;
+    }
+
+    // The rows outlive any statement reading them, so text is not copied
+    it->second->visit(Overload{
+        [&](const Null&) {
+            sqlite3_result_null(ctx);
+        },
+        [&](const Int& v) {
+            sqlite3_result_int64(ctx, v);
+        },
+        [&](const Float& v) {
+            sqlite3_result_double(ctx, v);
+        },
+        [&](const Bool& v) {
+            sqlite3_result_int64(ctx, v ? 1 : 0);
+        },
+        [&](const String& v) {
+            sqlite3_result_text(ctx, v.c_str(), static_cast<int>(v.size()),
+                                SQLITE_STATIC);
+        },
+        [&](const Function& fn) {
+            if (auto* db =
+                    dynamic_cast<const Data_Builtin<SQLite_Blob>*>(fn.get()))
+            {
+                const auto& bytes = db->data().data->raw_get<String>();
+                sqlite3_result_blob(ctx, bytes.data(),
+                                    static_cast<int>(bytes.size()),
+                                    SQLITE_STATIC);
+            }
+            else
+            {
+                sqlite3_result_error(ctx, "unsupported column type", -1);
+            }
+        },
+        [&](const auto&) {
+            auto msg = fmt::format("unsupported value of type {} in column {}",
+                                   it->second->type_name(),
+                                   column->raw_get<String>());
+            sqlite3_result_error(ctx, msg.c_str(), -1);
+        },
+    });
+    return SQLITE_OK;
+}
+
+int array_table_rowid(sqlite3_vtab_cursor* cur, sqlite3_int64* rowid)
+{
+    *rowid = static_cast<sqlite3_int64>(static_cast<Array_Cursor*>(cur)->index);
+    return SQLITE_OK;
+}
+
+void array_table_destroy(void* aux)
+{
+    delete static_cast<Table_Data_Ptr*>(aux);
+}
+
+// Eponymous-only (no xCreate) and read-only (no xUpdate): the table exists
+// as soon as the module is registered, under the module's name
+constexpr sqlite3_module array_table_module{
+    .iVersion = 0,
+    .xCreate = nullptr,
+    .xConnect = array_table_connect,
+    .xBestIndex = array_table_best_index,
+    .xDisconnect = array_table_disconnect,
+    .xDestroy = array_table_disconnect,
+    .xOpen = array_table_open,
+    .xClose = array_table_close,
+    .xFilter = array_table_filter,
+    .xNext = array_table_next,
+    .xEof = array_table_eof,
+    .xColumn = array_table_column,
+    .xRowid = array_table_rowid,
+};
+
 } // namespace
 
 void Connection::create_function(const String& name, const Function& fn)
@@ -306,6 +614,27 @@ void Connection::create_aggregate(const String& name, const Value_Ptr& init,
     }
 }
 
+void Connection::register_table(const String& name, Value_Ptr rows,
+                                std::vector<Value_Ptr> columns)
+{
+    std::lock_guard lock{mutex_};
+    require_open_();
+
+    auto* aux = new Table_Data_Ptr{
+        std::make_shared<Table_Data>(std::move(rows), std::move(columns))};
+
+    // SQLite calls array_table_destroy on aux itself if this fails
+    int rc = sqlite3_create_module_v2(conn_.get(), name.c_str(),
+                                      &array_table_module, aux,
+                                      array_table_destroy);
+    if (rc != SQLITE_OK)
+    {
+        throw Frost_Recoverable_Error{
+            fmt::format("Failed to register table '{}': {}", name,
+                        sqlite3_errmsg(conn_.get()))};
+    }
+}
+
 void Connection::trace(std::optional<Function> fn)
 {
     std::lock_guard lock{mutex_};
@@ -348,16 +677,8 @@ int Connection::exec_impl_(const Stmt_Ptr& stmt)
 {
     int before = sqlite3_total_changes(conn_.get());
 
-    while (true)
+    while (step_row_(stmt))
     {
-        int rc = sqlite3_step(stmt.get());
-        if (rc == SQLITE_DONE)
-            break;
-        if (rc != SQLITE_ROW)
-        {
-            std::string msg = sqlite3_errmsg(conn_.get());
-            throw Frost_Recoverable_Error{msg};
-        }
     }
 
     return sqlite3_total_changes(conn_.get()) - before;
@@ -379,41 +700,244 @@ int Connection::exec(const String& sql, const Map& bindings)
     return exec_impl_(stmt);
 }
 
-void Connection::for_each_row_impl_(
-    const Stmt_Ptr& stmt, const std::function<void(Value_Ptr)>& row_fn)
+int Connection::exec_many(const String& sql, const Array& rows)
 {
-    int num_cols = sqlite3_column_count(stmt.get());
-    while (true)
+    std::lock_guard lock{mutex_};
+    auto stmt = prepare_(sql);
+
+    int before = sqlite3_total_changes(conn_.get());
+
+    // A savepoint starts a transaction of its own outside of one, and nests
+    // inside of db.transaction, so a failed row undoes the whole batch
+    // either way.
+    script("SAVEPOINT frost_exec_many");
+    try
     {
-        int rc = sqlite3_step(stmt.get());
-        if (rc == SQLITE_DONE)
-            break;
-        if (rc != SQLITE_ROW)
+        for (const auto& [idx, row] : std::views::enumerate(rows))
         {
-            std::string msg = sqlite3_errmsg(conn_.get());
-            throw Frost_Recoverable_Error{msg};
+            sqlite3_reset(stmt.get());
+            try
+            {
+                if (row->is<Array>())
+                    bind_positional_(stmt, row->raw_get<Array>());
+                else if (row->is<Map>())
+                    bind_named_(stmt, row->raw_get<Map>());
+                else
+                    throw Frost_Recoverable_Error{
+                        fmt::format("bindings must be an Array or Map, got {}",
+                                    row->type_name())};
+                exec_impl_(stmt);
+            }
+            catch (const Frost_Recoverable_Error& e)
+            {
+                throw Frost_Recoverable_Error{
+                    fmt::format("row {}: {}", idx, e.what())};
+            }
         }
 
-        row_fn(read_row_(stmt, num_cols));
+        sqlite3_reset(stmt.get());
+        script("RELEASE frost_exec_many");
+    }
+    catch (...)
+    {
+        sqlite3_reset(stmt.get());
+        sqlite3_exec(conn_.get(),
+                     "ROLLBACK TO frost_exec_many; RELEASE frost_exec_many",
+                     nullptr, nullptr, nullptr);
+        throw;
+    }
+
+    return sqlite3_total_changes(conn_.get()) - before;
+}
+
+bool Connection::step_row_(const Stmt_Ptr& stmt)
+{
+    int rc = sqlite3_step(stmt.get());
+    if (rc == SQLITE_DONE)
+        return false;
+    if (rc != SQLITE_ROW)
+    {
+        std::string msg = sqlite3_errmsg(conn_.get());
+        throw Frost_Recoverable_Error{msg};
+    }
+    return true;
+}
+
+void Connection::for_each_row_impl_(
+    const Stmt_Ptr& stmt, const std::function<void(Value_Ptr)>& row_fn,
+    Row_Shape shape)
+{
+    auto* s = stmt.get();
+    const auto layout = Row_Layout::of(s);
+    while (step_row_(stmt))
+    {
+        if (shape == Row_Shape::map)
+            row_fn(layout.read_map(s));
+        else
+            row_fn(layout.read_array(s));
     }
 }
 
 void Connection::for_each_row(const String& sql, const Array& bindings,
-                              std::function<void(Value_Ptr)> row_fn)
+                              std::function<void(Value_Ptr)> row_fn,
+                              Row_Shape shape)
 {
     std::lock_guard lock{mutex_};
     auto stmt = prepare_(sql);
     bind_positional_(stmt, bindings);
-    for_each_row_impl_(stmt, std::move(row_fn));
+    for_each_row_impl_(stmt, std::move(row_fn), shape);
 }
 
 void Connection::for_each_row(const String& sql, const Map& bindings,
-                              std::function<void(Value_Ptr)> row_fn)
+                              std::function<void(Value_Ptr)> row_fn,
+                              Row_Shape shape)
 {
     std::lock_guard lock{mutex_};
     auto stmt = prepare_(sql);
     bind_named_(stmt, bindings);
-    for_each_row_impl_(stmt, std::move(row_fn));
+    for_each_row_impl_(stmt, std::move(row_fn), shape);
+}
+
+Value_Ptr Connection::query_columns_impl_(const Stmt_Ptr& stmt)
+{
+    auto* s = stmt.get();
+    auto layout = Row_Layout::of(s);
+
+    std::vector<Array> columns(layout.names.size());
+    while (step_row_(stmt))
+    {
+        for (auto&& [i, column] : std::views::enumerate(columns))
+            column.push_back(column_to_frost(s, static_cast<int>(i)));
+    }
+
+    Map::mapped_container_type values;
+    values.reserve(layout.columns.size());
+    for (int col : layout.columns)
+        values.push_back(Value::create(std::move(columns.at(col))));
+
+    return Value::create(Value::trusted,
+                         Map{std::sorted_unique, std::move(layout.keys),
+                             std::move(values)});
+}
+
+Value_Ptr Connection::query_columns(const String& sql, const Array& bindings)
+{
+    std::lock_guard lock{mutex_};
+    auto stmt = prepare_(sql);
+    bind_positional_(stmt, bindings);
+    return query_columns_impl_(stmt);
+}
+
+Value_Ptr Connection::query_columns(const String& sql, const Map& bindings)
+{
+    std::lock_guard lock{mutex_};
+    auto stmt = prepare_(sql);
+    bind_named_(stmt, bindings);
+    return query_columns_impl_(stmt);
+}
+
+std::shared_ptr<Statement> Connection::prepare(const String& sql)
+{
+    std::lock_guard lock{mutex_};
+    auto stmt = prepare_(sql);
+
+    auto id = next_statement_id_++;
+    statements_.emplace(id, std::move(stmt));
+    return std::make_shared<Statement>(Statement::Restricted{},
+                                       shared_from_this(), id, sql);
+}
+
+Connection::Statement_Run::Statement_Run(Connection& conn, std::uint64_t id)
+    : conn{conn}
+    , id{id}
+{
+    conn.require_open_();
+
+    auto it = conn.statements_.find(id);
+    if (it == conn.statements_.end())
+        throw Frost_Recoverable_Error{"prepared statement is finalized"};
+
+    // A statement has only one set of bindings and one cursor, so a run
+    // cannot start while another is still going
+    if (not it->second)
+        throw Frost_Recoverable_Error{"prepared statement is already running"};
+
+    stmt = std::move(it->second);
+}
+
+// Leaves the statement ready to be bound and run again, however its run ends
+Connection::Statement_Run::~Statement_Run()
+{
+    sqlite3_reset(stmt.get());
+
+    // Otherwise its Statement is gone, and it is finalized here
+    if (auto it = conn.statements_.find(id); it != conn.statements_.end())
+        it->second = std::move(stmt);
+}
+
+Statement::~Statement()
+{
+    std::lock_guard lock{conn_->mutex_};
+    conn_->statements_.erase(id_);
+}
+
+template <typename Bindings, typename Run>
+auto Statement::run_(const Bindings& bindings, Run&& run)
+{
+    std::lock_guard lock{conn_->mutex_};
+    Connection::Statement_Run running{*conn_, id_};
+
+    if constexpr (std::same_as<Bindings, Array>)
+        conn_->bind_positional_(running.stmt, bindings);
+    else
+        conn_->bind_named_(running.stmt, bindings);
+    return run(running.stmt);
+}
+
+int Statement::exec(const Array& bindings)
+{
+    return run_(bindings, [&](const auto& stmt) {
+        return conn_->exec_impl_(stmt);
+    });
+}
+
+int Statement::exec(const Map& bindings)
+{
+    return run_(bindings, [&](const auto& stmt) {
+        return conn_->exec_impl_(stmt);
+    });
+}
+
+void Statement::for_each_row(const Array& bindings,
+                             std::function<void(Value_Ptr)> row_fn,
+                             Row_Shape shape)
+{
+    run_(bindings, [&](const auto& stmt) {
+        conn_->for_each_row_impl_(stmt, row_fn, shape);
+    });
+}
+
+void Statement::for_each_row(const Map& bindings,
+                             std::function<void(Value_Ptr)> row_fn,
+                             Row_Shape shape)
+{
+    run_(bindings, [&](const auto& stmt) {
+        conn_->for_each_row_impl_(stmt, row_fn, shape);
+    });
+}
+
+Value_Ptr Statement::query_columns(const Array& bindings)
+{
+    return run_(bindings, [&](const auto& stmt) {
+        return conn_->query_columns_impl_(stmt);
+    });
+}
+
+Value_Ptr Statement::query_columns(const Map& bindings)
+{
+    return run_(bindings, [&](const auto& stmt) {
+        return conn_->query_columns_impl_(stmt);
+    });
 }
 
 bool Connection::in_transaction() const
@@ -581,47 +1105,4 @@ void Connection::bind_named_(const Stmt_Ptr& stmt, const Map& bindings)
     }
 }
 
-Value_Ptr Connection::read_row_(const Stmt_Ptr& stmt, int num_cols)
-{
-    auto* s = stmt.get();
-    Map row;
-    for (int i = 0; i != num_cols; ++i)
-    {
-        auto col_name = Value::create(String{sqlite3_column_name(s, i)});
-        switch (sqlite3_column_type(s, i))
-        {
-        case SQLITE_INTEGER:
-            row.insert_or_assign(
-                col_name, Value::create(Int{sqlite3_column_int64(s, i)}));
-            break;
-        case SQLITE_FLOAT:
-            row.insert_or_assign(col_name,
-                                 Value::create(sqlite3_column_double(s, i)));
-            break;
-        case SQLITE_TEXT:
-            row.insert_or_assign(
-                col_name,
-                Value::create(String{
-                    reinterpret_cast<const char*>(sqlite3_column_text(s, i)),
-                    static_cast<std::size_t>(sqlite3_column_bytes(s, i)),
-                }));
-            break;
-        case SQLITE_BLOB:
-            row.insert_or_assign(
-                col_name,
-                Value::create(make_blob(Value::create(String{
-                    static_cast<const char*>(sqlite3_column_blob(s, i)),
-                    static_cast<std::size_t>(sqlite3_column_bytes(s, i)),
-                }))));
-            break;
-        case SQLITE_NULL:
-            row.insert_or_assign(col_name, Value::null());
-            break;
-        default:
-            THROW_UNREACHABLE;
-        }
-    }
-    return Value::create(std::move(row));
-}
-
 } // namespace frst::sqlite
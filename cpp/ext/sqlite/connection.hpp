@@ -4,8 +4,11 @@
 #include <frost/builtins-common.hpp>
 #include <frost/data-builtin.hpp>
 
+#include <cstdint>
+#include <map>
 #include <mutex>
 #include <sqlite3.h>
+#include <vector>
 
 namespace frst::sqlite
 {
@@ -17,12 +20,21 @@ struct SQLite_Blob
 
 Function make_blob(Value_Ptr data);
 
+// How each result row is handed to a for_each_row callback
+enum class Row_Shape
+{
+    map,   // Map of column name to value
+    array, // Array of values in column order
+};
+
+class Statement;
+
 // Connection wraps a SQLite database handle with RAII lifetime.
 //
 // All methods except in_transaction() require an open connection and will
 // throw Frost_Recoverable_Error if called after close().
 // in_transaction() returns false on a closed connection.
-class Connection
+class Connection : public std::enable_shared_from_this<Connection>
 {
     class Restricted
     {
@@ -45,13 +57,29 @@ class Connection
     int exec(const String& sql, const Array& bindings);
     int exec(const String& sql, const Map& bindings);
 
+    // Run sql once per row of bindings (each an Array or Map), reusing a
+    // single prepared statement. All rows are applied, or none are.
+    int exec_many(const String& sql, const Array& rows);
+
     int script(const String& sql);
 
     void for_each_row(const String& sql, const Array& bindings,
-                      std::function<void(Value_Ptr)> row_fn);
+                      std::function<void(Value_Ptr)> row_fn,
+                      Row_Shape shape = Row_Shape::map);
     void for_each_row(const String& sql, const Map& bindings,
-                      std::function<void(Value_Ptr)> row_fn);
+                      std::function<void(Value_Ptr)> row_fn,
+                      Row_Shape shape = Row_Shape::map);
 
+    // The whole result as a Map of column name to an Array of its values
+    Value_Ptr query_columns(const String& sql, const Array& bindings);
+    Value_Ptr query_columns(const String& sql, const Map& bindings);
+
+    // Prepare sql once, to be run any number of times through the returned
+    // Statement
+    std::shared_ptr<Statement> prepare(const String& sql);
+
+    // Also finalizes every Statement prepared on this connection. Throws
+    // while one of them is running, such as from inside its for_each_row.
     void close();
 
     void create_function(const String& name, const Function& fn);
@@ -60,11 +88,20 @@ class Connection
                           std::optional<Function> finalize = std::nullopt);
     void trace(std::optional<Function> fn);
 
+    // Expose rows, an Array of Maps, to SQL as a read-only table called name.
+    // Each column reads the value at the key of the same name (a String
+    // Value) from a row's Map as it is scanned, or NULL if it is missing.
+    // Registering a name again replaces its table.
+    void register_table(const String& name, Value_Ptr rows,
+                        std::vector<Value_Ptr> columns);
+
     bool in_transaction() const;
     int total_changes();
     Int last_insert_rowid();
 
   private:
+    friend Statement;
+
     void require_open_();
 
     using Stmt_Ptr =
@@ -74,7 +111,10 @@ class Connection
 
     int exec_impl_(const Stmt_Ptr& stmt);
     void for_each_row_impl_(const Stmt_Ptr& stmt,
-                            const std::function<void(Value_Ptr)>& row_fn);
+                            const std::function<void(Value_Ptr)>& row_fn,
+                            Row_Shape shape);
+    Value_Ptr query_columns_impl_(const Stmt_Ptr& stmt);
+    bool step_row_(const Stmt_Ptr& stmt);
 
     // Prepared statement caching was benchmarked and rejected. Two scripts
     // ran 5k inserts: one with unique SQL per call (string concatenation, zero
@@ -88,16 +128,93 @@ class Connection
                             const Value_Ptr& val_ptr,
                             const std::string& location);
 
-    Value_Ptr read_row_(const Stmt_Ptr& stmt, int num_cols);
-
     using Conn_Ptr = std::unique_ptr<sqlite3, decltype([](sqlite3* db) {
                                          sqlite3_close_v2(db);
                                      })>;
 
+    // One run of the statement prepared as id. It holds the statement for
+    // as long as it lasts, leaving its entry in statements_ empty, and then
+    // resets it and puts it back. Throws if the statement has been
+    // finalized or is already running.
+    struct Statement_Run
+    {
+        Statement_Run(Connection& conn, std::uint64_t id);
+        ~Statement_Run();
+
+        Statement_Run(const Statement_Run&) = delete;
+        Statement_Run& operator=(const Statement_Run&) = delete;
+
+        Connection& conn;
+        std::uint64_t id;
+        Stmt_Ptr stmt;
+    };
+
     Conn_Ptr conn_;
     std::unique_ptr<Function> trace_fn_;
+    // Statements from prepare(), by id. Ids are never reused, so a
+    // Statement can tell that close() has finalized its statement. An empty
+    // entry is a statement that is running.
+    std::map<std::uint64_t, Stmt_Ptr> statements_;
+    std::uint64_t next_statement_id_ = 0;
     std::recursive_mutex mutex_;
 };
+
+// Statement is a statement prepared by Connection::prepare, which is reset
+// and rebound each time it is run instead of being prepared again.
+//
+// The statement itself belongs to the connection: it is finalized when
+// the Statement is destroyed or the connection is closed, whichever is
+// first. All methods throw Frost_Recoverable_Error after that, and while
+// the statement is already running (such as from inside for_each_row).
+class Statement
+{
+    class Restricted
+    {
+        friend Connection;
+        Restricted() = default;
+    };
+
+  public:
+    Statement(Restricted, std::shared_ptr<Connection> conn, std::uint64_t id,
+              String sql)
+        : conn_{std::move(conn)}
+        , id_{id}
+        , sql_{std::move(sql)}
+    {
+    }
+
+    Statement() = delete;
+    Statement(const Statement&) = delete;
+    Statement(Statement&&) = delete;
+
+    ~Statement();
+
+    const String& sql() const
+    {
+        return sql_;
+    }
+
+    int exec(const Array& bindings);
+    int exec(const Map& bindings);
+
+    void for_each_row(const Array& bindings,
+                      std::function<void(Value_Ptr)> row_fn,
+                      Row_Shape shape = Row_Shape::map);
+    void for_each_row(const Map& bindings,
+                      std::function<void(Value_Ptr)> row_fn,
+                      Row_Shape shape = Row_Shape::map);
+
+    Value_Ptr query_columns(const Array& bindings);
+    Value_Ptr query_columns(const Map& bindings);
+
+  private:
+    template <typename Bindings, typename Run>
+    auto run_(const Bindings& bindings, Run&& run);
+
+    std::shared_ptr<Connection> conn_;
+    std::uint64_t id_;
+    String sql_;
+};
 } // namespace frst::sqlite
 
 #endif
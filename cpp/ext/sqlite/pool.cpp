@@ -0,0 +1,145 @@
+#include "pool.hpp"
+
+#include <algorithm>
+#include <ranges>
+
+namespace frst::sqlite
+{
+
+namespace
+{
+
+// The reader each thread has leased from each pool, and how many of its
+// Leases are still alive
+struct Held_Reader
+{
+    const Pool* pool;
+    std::size_t index;
+    std::size_t depth;
+};
+
+thread_local std::vector<Held_Reader> held_readers;
+
+void set_pragma(Connection& conn, const String& pragma)
+{
+    conn.for_each_row("PRAGMA " + pragma, Array{}, [](Value_Ptr) {});
+}
+
+} // namespace
+
+Pool::Pool(Restricted, std::shared_ptr<Connection> writer,
+           std::vector<std::shared_ptr<Connection>> readers,
+           std::chrono::milliseconds reader_wait)
+    : writer_{std::move(writer)}
+    , readers_{std::move(readers)}
+    , reader_wait_{reader_wait}
+    , free_readers_{std::views::iota(0uz, readers_.size())
+                    | std::ranges::to<std::vector>()}
+{
+}
+
+std::shared_ptr<Pool> Pool::create(const String& filename,
+                                   std::size_t reader_count,
+                                   std::chrono::milliseconds reader_wait)
+{
+    if (filename.empty() or filename == ":memory:")
+        throw Frost_Recoverable_Error{
+            "sqlite.open_pool: a pool needs a database file, not an in-memory "
+            "database"};
+
+    auto writer = Connection::create(
+        filename, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+
+    // journal_mode answers with the mode it ended up in, which is not WAL
+    // for databases that cannot use it
+    String mode;
+    writer->for_each_row(
+        "PRAGMA journal_mode = WAL", Array{},
+        [&](Value_Ptr row) {
+            mode = row->raw_get<Array>().at(0)->to_internal_string();
+        },
+        Row_Shape::array);
+    if (mode != "wal")
+        throw Frost_Recoverable_Error{fmt::format(
+            "sqlite.open_pool: could not switch {} to WAL mode", filename)};
+
+    // Checkpoints can still briefly lock out other connections
+    set_pragma(*writer, "busy_timeout = 5000");
+
+    std::vector<std::shared_ptr<Connection>> readers;
+    readers.reserve(reader_count);
+    for (std::size_t i = 0; i < reader_count; ++i)
+    {
+        auto reader = Connection::create(filename, SQLITE_OPEN_READONLY);
+        set_pragma(*reader, "busy_timeout = 5000");
+        readers.push_back(std::move(reader));
+    }
+
+    return std::make_shared<Pool>(Restricted{}, std::move(writer),
+                                  std::move(readers), reader_wait);
+}
+
+Pool::Lease Pool::read()
+{
+    auto held = std::ranges::find(held_readers, this, &Held_Reader::pool);
+    if (held != held_readers.end())
+    {
+        ++held->depth;
+        return Lease{*this, held->index};
+    }
+
+    std::unique_lock lock{mutex_};
+    if (not reader_freed_.wait_for(lock, reader_wait_, [&] {
+            return not free_readers_.empty();
+        }))
+        throw Frost_Recoverable_Error{fmt::format(
+            "no pool reader became free within {} ms: a row callback that "
+            "waits on other threads querying the same pool may be holding it",
+            reader_wait_.count())};
+    auto index = free_readers_.back();
+    free_readers_.pop_back();
+    lock.unlock();
+
+    held_readers.push_back({this, index, 1});
+    return Lease{*this, index};
+}
+
+std::unique_lock<std::recursive_timed_mutex> Pool::lock_writer()
+{
+    std::unique_lock lock{write_mutex_, std::defer_lock};
+    if (not lock.try_lock_for(reader_wait_))
+        throw Frost_Recoverable_Error{fmt::format(
+            "the pool writer was not free within {} ms: a transaction that "
+            "waits on other threads writing to the same pool may be holding it",
+            reader_wait_.count())};
+    return lock;
+}
+
+Pool::Lease::~Lease()
+{
+    auto held = std::ranges::find(held_readers, pool_, &Held_Reader::pool);
+    if (--held->depth == 0)
+    {
+        held_readers.erase(held);
+        pool_->release_(index_);
+    }
+}
+
+void Pool::release_(std::size_t index)
+{
+    {
+        std::lock_guard lock{mutex_};
+        free_readers_.push_back(index);
+    }
+    reader_freed_.notify_one();
+}
+
+void Pool::close()
+{
+    std::lock_guard lock{write_mutex_};
+    writer_->close();
+    for (const auto& reader : readers_)
+        reader->close();
+}
+
+} // namespace frst::sqlite
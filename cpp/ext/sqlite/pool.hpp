@@ -0,0 +1,118 @@
+#ifndef FROST_EXT_SQLITE_POOL_HPP
+#define FROST_EXT_SQLITE_POOL_HPP
+
+#include "connection.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace frst::sqlite
+{
+
+// Pool is one writer connection and a number of read-only reader
+// connections to the same database file, all in WAL mode, so that readers
+// wait neither on each other nor on the writer.
+//
+// Writes go through writer() while holding write_mutex(). Reads lease a
+// reader with read(): a thread that already holds a lease gets the same
+// reader again, so a row callback can query while its own query is still
+// running. Other threads wait until a reader is free, for at most
+// reader_wait, as a callback holding the last reader may itself be waiting
+// on them.
+//
+// While a transaction is open, the thread running it holds write_mutex()
+// throughout. Writes from that thread outside the transaction fail, and
+// other threads wait for it to end in lock_writer(), also for at most
+// reader_wait, as the transaction may itself be waiting on them.
+class Pool
+{
+    class Restricted
+    {
+        friend Pool;
+        Restricted() = default;
+    };
+
+  public:
+    class Lease
+    {
+      public:
+        Lease(const Lease&) = delete;
+        Lease(Lease&&) = delete;
+        ~Lease();
+
+        Connection& operator*() const
+        {
+            return *pool_->readers_.at(index_);
+        }
+
+      private:
+        friend Pool;
+
+        Lease(Pool& pool, std::size_t index)
+            : pool_{&pool}
+            , index_{index}
+        {
+        }
+
+        Pool* pool_;
+        std::size_t index_;
+    };
+
+    Pool(Restricted, std::shared_ptr<Connection> writer,
+         std::vector<std::shared_ptr<Connection>> readers,
+         std::chrono::milliseconds reader_wait);
+
+    Pool() = delete;
+    Pool(const Pool&) = delete;
+    Pool(Pool&&) = delete;
+
+    static std::shared_ptr<Pool> create(const String& filename,
+                                        std::size_t reader_count,
+                                        std::chrono::milliseconds reader_wait);
+
+    Lease read();
+
+    const std::shared_ptr<Connection>& writer() const
+    {
+        return writer_;
+    }
+
+    std::unique_lock<std::recursive_timed_mutex> lock_writer();
+
+    // Whether the calling thread is the one running pool.transaction
+    bool transaction_on_this_thread() const
+    {
+        return transaction_owner_ == std::this_thread::get_id();
+    }
+
+    void set_transaction_owner(std::thread::id owner)
+    {
+        transaction_owner_ = owner;
+    }
+
+    // Closes the writer and every reader
+    void close();
+
+  private:
+    void release_(std::size_t index);
+
+    std::shared_ptr<Connection> writer_;
+    std::vector<std::shared_ptr<Connection>> readers_;
+    std::recursive_timed_mutex write_mutex_;
+    std::atomic<std::thread::id> transaction_owner_;
+
+    std::chrono::milliseconds reader_wait_;
+    std::mutex mutex_;
+    std::condition_variable reader_freed_;
+    std::vector<std::size_t> free_readers_;
+};
+
+} // namespace frst::sqlite
+
+#endif
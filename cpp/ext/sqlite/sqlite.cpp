@@ -6,6 +6,11 @@
 #include <sqlite3.h>
 
 #include "connection.hpp"
+#include "pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 namespace frst
 {
@@ -19,27 +24,209 @@ bool has_bindings(builtin_args_t args, std::size_t idx)
     return idx < args.size() && not args.at(idx)->is<Function>();
 }
 
-template <std::invocable<Value_Ptr> Row_Fn>
-void for_each_row_dispatch(Connection& conn, const String& sql,
-                           builtin_args_t args, std::size_t idx,
-                           Row_Fn&& row_fn)
+// Runs sql on conn each time, in the same way as a prepared Statement
+struct Sql_Statement
 {
-    if (not has_bindings(args, idx))
+    Connection& conn;
+    const String& sql;
+
+    int exec(const auto& bindings)
     {
-        conn.for_each_row(sql, Array{}, std::forward<Row_Fn>(row_fn));
+        return conn.exec(sql, bindings);
     }
-    else if (args.at(idx)->is<Array>())
+
+    void for_each_row(const auto& bindings,
+                      std::function<void(Value_Ptr)> row_fn, Row_Shape shape)
     {
-        conn.for_each_row(sql, args.at(idx)->raw_get<Array>(),
-                          std::forward<Row_Fn>(row_fn));
+        conn.for_each_row(sql, bindings, std::move(row_fn), shape);
     }
-    else
+
+    Value_Ptr query_columns(const auto& bindings)
     {
-        conn.for_each_row(sql, args.at(idx)->raw_get<Map>(),
-                          std::forward<Row_Fn>(row_fn));
+        return conn.query_columns(sql, bindings);
     }
+};
+
+// Call fn with the bindings at args[idx], or with no bindings if absent
+template <typename Fn>
+decltype(auto) with_bindings(builtin_args_t args, std::size_t idx, Fn&& fn)
+{
+    if (not has_bindings(args, idx))
+        return fn(Array{});
+    if (args.at(idx)->is<Array>())
+        return fn(args.at(idx)->raw_get<Array>());
+    return fn(args.at(idx)->raw_get<Map>());
+}
+
+template <typename Source, std::invocable<Value_Ptr> Row_Fn>
+void for_each_row_dispatch(Source&& source, builtin_args_t args,
+                           std::size_t idx, Row_Fn&& row_fn,
+                           Row_Shape shape = Row_Shape::map)
+{
+    with_bindings(args, idx, [&](const auto& bindings) {
+        source.for_each_row(bindings, std::forward<Row_Fn>(row_fn), shape);
+    });
 }
 
+// What query returns, chosen by its rows option
+enum class Query_Shape
+{
+    maps,    // An Array of row Maps
+    arrays,  // An Array of row Arrays
+    columns, // A Map of column name to an Array of its values
+};
+
+Query_Shape parse_query_options(std::string_view fn_name, const Map& opts)
+{
+    Query_Shape result = Query_Shape::maps;
+
+    for (const auto& [k_val, v_val] : opts)
+    {
+        if (not k_val->is<String>())
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: option keys must be Strings, got {}", fn_name,
+                            k_val->type_name())};
+
+        const auto& key = k_val->raw_get<String>();
+
+        if (key == "rows")
+        {
+            const auto* rows =
+                v_val->is<String>() ? &v_val->raw_get<String>() : nullptr;
+            if (rows and *rows == "map")
+                result = Query_Shape::maps;
+            else if (rows and *rows == "array")
+                result = Query_Shape::arrays;
+            else if (rows and *rows == "columns")
+                result = Query_Shape::columns;
+            else
+                throw Frost_Recoverable_Error{fmt::format(
+                    "{}: rows option must be 'map', 'array' or 'columns'",
+                    fn_name)};
+        }
+        else
+        {
+            throw Frost_Recoverable_Error{
+                fmt::format("{}: unknown option '{}'", fn_name, key)};
+        }
+    }
+
+    return result;
+}
+
+template <typename Source>
+Value_Ptr query_dispatch(Source&& source, builtin_args_t args,
+                         std::size_t idx, Query_Shape shape)
+{
+    if (shape == Query_Shape::columns)
+    {
+        return with_bindings(args, idx, [&](const auto& bindings) {
+            return source.query_columns(bindings);
+        });
+    }
+
+    Array rows;
+    for_each_row_dispatch(
+        source, args, idx,
+        [&](Value_Ptr row) {
+            rows.push_back(std::move(row));
+        },
+        shape == Query_Shape::arrays ? Row_Shape::array : Row_Shape::map);
+    return Value::create(std::move(rows));
+}
+
+// Frost-facing glue for a statement from db.prepare or tx.prepare. guard is
+// the one of the object that prepared it.
+struct Statement_Methods
+{
+    std::shared_ptr<Statement> stmt;
+    std::function<void()> guard;
+
+    Value_Ptr exec(builtin_args_t args)
+    {
+        guard();
+        REQUIRE_ARGS("statement.exec",
+                     OPTIONAL(PARAM("bindings", TYPES(Array, Map))));
+
+        return with_bindings(args, 0, [&](const auto& bindings) {
+            return Value::create(stmt->exec(bindings));
+        });
+    }
+
+    Value_Ptr query(builtin_args_t args)
+    {
+        guard();
+        REQUIRE_ARGS("statement.query",
+                     OPTIONAL(PARAM("bindings", TYPES(Array, Map))),
+                     OPTIONAL(PARAM("options", TYPES(Map))));
+
+        auto shape = HAS(1) ? parse_query_options("statement.query",
+                                                  GET(1, Map))
+                            : Query_Shape::maps;
+        return query_dispatch(*stmt, args, 0, shape);
+    }
+
+    Value_Ptr each(builtin_args_t args)
+    {
+        guard();
+        if (args.size() == 2)
+            REQUIRE_ARGS("statement.each",
+                         PARAM("bindings", TYPES(Array, Map)),
+                         PARAM("callback", TYPES(Function)));
+        else
+            REQUIRE_ARGS("statement.each", PARAM("callback", TYPES(Function)));
+
+        auto& callback = args.back()->raw_get<Function>();
+        for_each_row_dispatch(*stmt, args, 0, [&](Value_Ptr row) {
+            callback->call({row});
+        });
+        return Value::null();
+    }
+
+    Value_Ptr collect(builtin_args_t args)
+    {
+        guard();
+        if (args.size() == 2)
+            REQUIRE_ARGS("statement.collect",
+                         PARAM("bindings", TYPES(Array, Map)),
+                         PARAM("callback", TYPES(Function)));
+        else
+            REQUIRE_ARGS("statement.collect",
+                         PARAM("callback", TYPES(Function)));
+
+        auto& callback = args.back()->raw_get<Function>();
+        Array results;
+        for_each_row_dispatch(*stmt, args, 0, [&](Value_Ptr row) {
+            results.push_back(callback->call({row}));
+        });
+        return Value::create(std::move(results));
+    }
+
+    Value_Ptr to_value()
+    {
+        STRINGS(sql, exec, query, each, collect);
+        auto sql_value = Value::create(auto{stmt->sql()});
+        auto self = std::make_shared<Statement_Methods>(std::move(*this));
+        return Value::create(
+            Value::trusted,
+            Map{
+                {strings.sql, std::move(sql_value)},
+                {strings.exec, system_closure([self](builtin_args_t args) {
+                     return self->exec(args);
+                 })},
+                {strings.query, system_closure([self](builtin_args_t args) {
+                     return self->query(args);
+                 })},
+                {strings.each, system_closure([self](builtin_args_t args) {
+                     return self->each(args);
+                 })},
+                {strings.collect, system_closure([self](builtin_args_t args) {
+                     return self->collect(args);
+                 })},
+            });
+    }
+};
+
 // Frost-facing glue for the data-access methods shared by both the
 // database and transaction closure maps.
 struct Data_Methods
@@ -60,12 +247,20 @@ struct Data_Methods
         REQUIRE_ARGS(n, PARAM("SQL", TYPES(String)),
                      OPTIONAL(PARAM("bindings", TYPES(Array, Map))));
 
-        auto& sql = GET(0, String);
-        if (not has_bindings(args, 1))
-            return Value::create(conn->exec(sql, Array{}));
-        if (args.at(1)->is<Array>())
-            return Value::create(conn->exec(sql, args.at(1)->raw_get<Array>()));
-        return Value::create(conn->exec(sql, args.at(1)->raw_get<Map>()));
+        Sql_Statement source{*conn, GET(0, String)};
+        return with_bindings(args, 1, [&](const auto& bindings) {
+            return Value::create(source.exec(bindings));
+        });
+    }
+
+    Value_Ptr exec_many(builtin_args_t args)
+    {
+        guard();
+        auto n = name("exec_many");
+        REQUIRE_ARGS(n, PARAM("SQL", TYPES(String)),
+                     PARAM("rows", TYPES(Array)));
+
+        return Value::create(conn->exec_many(GET(0, String), GET(1, Array)));
     }
 
     Value_Ptr script(builtin_args_t args)
@@ -81,14 +276,23 @@ struct Data_Methods
         guard();
         auto n = name("query");
         REQUIRE_ARGS(n, PARAM("SQL", TYPES(String)),
-                     OPTIONAL(PARAM("bindings", TYPES(Array, Map))));
+                     OPTIONAL(PARAM("bindings", TYPES(Array, Map))),
+                     OPTIONAL(PARAM("options", TYPES(Map))));
 
-        Array rows;
-        for_each_row_dispatch(*conn, GET(0, String), args, 1,
-                              [&](Value_Ptr row) {
-                                  rows.push_back(std::move(row));
-                              });
-        return Value::create(std::move(rows));
+        auto shape = HAS(2) ? parse_query_options(n, GET(2, Map))
+                            : Query_Shape::maps;
+        return query_dispatch(Sql_Statement{*conn, GET(0, String)}, args, 1,
+                              shape);
+    }
+
+    Value_Ptr prepare(builtin_args_t args)
+    {
+        guard();
+        auto n = name("prepare");
+        REQUIRE_ARGS(n, PARAM("SQL", TYPES(String)));
+
+        return Statement_Methods{conn->prepare(GET(0, String)), guard}
+            .to_value();
     }
 
     Value_Ptr each(builtin_args_t args)
@@ -104,7 +308,7 @@ struct Data_Methods
                          PARAM("callback", TYPES(Function)));
 
         auto& callback = args.back()->raw_get<Function>();
-        for_each_row_dispatch(*conn, GET(0, String), args, 1,
+        for_each_row_dispatch(Sql_Statement{*conn, GET(0, String)}, args, 1,
                               [&](Value_Ptr row) {
                                   callback->call({row});
                               });
@@ -125,7 +329,7 @@ struct Data_Methods
 
         auto& callback = args.back()->raw_get<Function>();
         Array results;
-        for_each_row_dispatch(*conn, GET(0, String), args, 1,
+        for_each_row_dispatch(Sql_Statement{*conn, GET(0, String)}, args, 1,
                               [&](Value_Ptr row) {
                                   results.push_back(callback->call({row}));
                               });
@@ -140,12 +344,16 @@ struct Data_Methods
 
     Map to_map()
     {
-        STRINGS(exec, query, each, collect, script, last_insert_rowid);
+        STRINGS(exec, exec_many, query, each, collect, script, prepare,
+                last_insert_rowid);
         auto self = std::make_shared<Data_Methods>(std::move(*this));
         return Map{
             {strings.exec, system_closure([self](builtin_args_t args) {
                  return self->exec(args);
              })},
+            {strings.exec_many, system_closure([self](builtin_args_t args) {
+                 return self->exec_many(args);
+             })},
             {strings.script, system_closure([self](builtin_args_t args) {
                  return self->script(args);
              })},
@@ -158,6 +366,9 @@ struct Data_Methods
             {strings.collect, system_closure([self](builtin_args_t args) {
                  return self->collect(args);
              })},
+            {strings.prepare, system_closure([self](builtin_args_t args) {
+                 return self->prepare(args);
+             })},
             {strings.last_insert_rowid,
              system_closure([self](builtin_args_t args) {
                  REQUIRE_NULLARY("database.last_insert_rowid");
@@ -243,6 +454,49 @@ struct Database_Methods
         return Value::null();
     }
 
+    Value_Ptr register_table(builtin_args_t args)
+    {
+        REQUIRE_ARGS("database.register_table", PARAM("name", TYPES(String)),
+                     PARAM("rows", TYPES(Array)),
+                     OPTIONAL(PARAM("columns", TYPES(Array))));
+
+        const auto& rows = GET(1, Array);
+        for (const auto& [idx, row] : std::views::enumerate(rows))
+        {
+            if (not row->is<Map>())
+                throw Frost_Recoverable_Error{fmt::format(
+                    "database.register_table: rows must be Maps, got {} at "
+                    "index {}",
+                    row->type_name(), idx)};
+        }
+
+        // Without explicit columns, the first row decides them
+        std::vector<Value_Ptr> columns;
+        if (HAS(2))
+            columns.assign(GET(2, Array).begin(), GET(2, Array).end());
+        else if (not rows.empty())
+            columns.assign_range(rows.front()->raw_get<Map>().keys());
+        else
+            throw Frost_Recoverable_Error{
+                "database.register_table: columns are required when there "
+                "are no rows"};
+
+        if (columns.empty())
+            throw Frost_Recoverable_Error{
+                "database.register_table: a table needs at least one column"};
+        for (const auto& column : columns)
+        {
+            if (not column->is<String>())
+                throw Frost_Recoverable_Error{fmt::format(
+                    "database.register_table: column names must be Strings, "
+                    "got {}",
+                    column->type_name())};
+        }
+
+        conn->register_table(GET(0, String), args[1], std::move(columns));
+        return Value::null();
+    }
+
     Value_Ptr trace(builtin_args_t args)
     {
         REQUIRE_ARGS("database.trace",
@@ -257,7 +511,8 @@ struct Database_Methods
 
     void merge_into(Map& entries)
     {
-        STRINGS(close, transaction, create_function, create_aggregate, trace);
+        STRINGS(close, transaction, create_function, create_aggregate,
+                register_table, trace);
         auto self = std::make_shared<Database_Methods>(std::move(*this));
         entries.insert_or_assign(strings.close,
                                  system_closure([self](builtin_args_t args) {
@@ -275,12 +530,265 @@ struct Database_Methods
                                  system_closure([self](builtin_args_t args) {
                                      return self->create_aggregate(args);
                                  }));
+        entries.insert_or_assign(strings.register_table,
+                                 system_closure([self](builtin_args_t args) {
+                                     return self->register_table(args);
+                                 }));
         entries.insert_or_assign(strings.trace,
                                  system_closure([self](builtin_args_t args) {
                                      return self->trace(args);
                                  }));
     }
 };
+
+// Frost-facing glue for a pool from sqlite.open_pool. Writes hold the
+// pool's write mutex. While a transaction is open, writes through the pool
+// from the thread running it fail, as they do on a single connection. Other
+// threads wait for it to end, for at most reader_wait_ms, since the thread
+// running it may be waiting on the one that would write.
+struct Pool_Methods
+{
+    std::shared_ptr<Pool> pool;
+
+    [[noreturn]] static void refuse_write()
+    {
+        throw Frost_Recoverable_Error{"connection has an active transaction: "
+                                      "use the transaction object instead"};
+    }
+
+    // The thread running pool.transaction already holds the mutex, so it is
+    // checked for first. Once the mutex is held, so is a transaction begun
+    // in SQL rather than with pool.transaction
+    std::unique_lock<std::recursive_timed_mutex> lock_writer()
+    {
+        if (pool->transaction_on_this_thread())
+            refuse_write();
+
+        auto lock = pool->lock_writer();
+        if (pool->writer()->in_transaction())
+            refuse_write();
+        return lock;
+    }
+
+    Value_Ptr exec(builtin_args_t args)
+    {
+        REQUIRE_ARGS("pool.exec", PARAM("SQL", TYPES(String)),
+                     OPTIONAL(PARAM("bindings", TYPES(Array, Map))));
+
+        auto lock = lock_writer();
+        Sql_Statement source{*pool->writer(), GET(0, String)};
+        return with_bindings(args, 1, [&](const auto& bindings) {
+            return Value::create(source.exec(bindings));
+        });
+    }
+
+    Value_Ptr exec_many(builtin_args_t args)
+    {
+        REQUIRE_ARGS("pool.exec_many", PARAM("SQL", TYPES(String)),
+                     PARAM("rows", TYPES(Array)));
+
+        auto lock = lock_writer();
+        return Value::create(
+            pool->writer()->exec_many(GET(0, String), GET(1, Array)));
+    }
+
+    Value_Ptr script(builtin_args_t args)
+    {
+        REQUIRE_ARGS("pool.script", PARAM("SQL", TYPES(String)));
+
+        auto lock = lock_writer();
+        return Value::create(pool->writer()->script(GET(0, String)));
+    }
+
+    Value_Ptr query(builtin_args_t args)
+    {
+        REQUIRE_ARGS("pool.query", PARAM("SQL", TYPES(String)),
+                     OPTIONAL(PARAM("bindings", TYPES(Array, Map))),
+                     OPTIONAL(PARAM("options", TYPES(Map))));
+
+        auto shape = HAS(2) ? parse_query_options("pool.query", GET(2, Map))
+                            : Query_Shape::maps;
+        auto reader = pool->read();
+        return query_dispatch(Sql_Statement{*reader, GET(0, String)}, args, 1,
+                              shape);
+    }
+
+    Value_Ptr each(builtin_args_t args)
+    {
+        if (args.size() == 3)
+            REQUIRE_ARGS("pool.each", PARAM("SQL", TYPES(String)),
+                         PARAM("bindings", TYPES(Array, Map)),
+                         PARAM("callback", TYPES(Function)));
+        else
+            REQUIRE_ARGS("pool.each", PARAM("SQL", TYPES(String)),
+                         PARAM("callback", TYPES(Function)));
+
+        auto& callback = args.back()->raw_get<Function>();
+        auto reader = pool->read();
+        for_each_row_dispatch(Sql_Statement{*reader, GET(0, String)}, args, 1,
+                              [&](Value_Ptr row) {
+                                  callback->call({row});
+                              });
+        return Value::null();
+    }
+
+    Value_Ptr collect(builtin_args_t args)
+    {
+        if (args.size() == 3)
+            REQUIRE_ARGS("pool.collect", PARAM("SQL", TYPES(String)),
+                         PARAM("bindings", TYPES(Array, Map)),
+                         PARAM("callback", TYPES(Function)));
+        else
+            REQUIRE_ARGS("pool.collect", PARAM("SQL", TYPES(String)),
+                         PARAM("callback", TYPES(Function)));
+
+        auto& callback = args.back()->raw_get<Function>();
+        Array results;
+        auto reader = pool->read();
+        for_each_row_dispatch(Sql_Statement{*reader, GET(0, String)}, args, 1,
+                              [&](Value_Ptr row) {
+                                  results.push_back(callback->call({row}));
+                              });
+        return Value::create(std::move(results));
+    }
+
+    Value_Ptr transaction(builtin_args_t args)
+    {
+        if (pool->transaction_on_this_thread())
+            throw Frost_Recoverable_Error{
+                "connection has an active transaction: "
+                "cannot start a nested transaction"};
+
+        auto lock = pool->lock_writer();
+
+        struct Open_Transaction
+        {
+            explicit Open_Transaction(Pool& pool)
+                : pool{pool}
+            {
+                pool.set_transaction_owner(std::this_thread::get_id());
+            }
+            ~Open_Transaction()
+            {
+                pool.set_transaction_owner({});
+            }
+
+            Pool& pool;
+        } open{*pool};
+
+        return Database_Methods{pool->writer()}.transaction(args);
+    }
+
+    Value_Ptr last_insert_rowid(builtin_args_t args)
+    {
+        REQUIRE_NULLARY("pool.last_insert_rowid");
+        return Value::create(pool->writer()->last_insert_rowid());
+    }
+
+    Value_Ptr close(builtin_args_t args)
+    {
+        REQUIRE_NULLARY("pool.close");
+
+        if (pool->transaction_on_this_thread())
+            throw Frost_Recoverable_Error{"cannot close connection while a "
+                                          "transaction is active"};
+
+        auto lock = pool->lock_writer();
+        if (pool->writer()->in_transaction())
+            throw Frost_Recoverable_Error{"cannot close connection while a "
+                                          "transaction is active"};
+        pool->close();
+        return Value::null();
+    }
+
+    Value_Ptr to_value()
+    {
+        STRINGS(exec, exec_many, script, query, each, collect, transaction,
+                last_insert_rowid, close);
+        auto self = std::make_shared<Pool_Methods>(std::move(*this));
+        return Value::create(
+            Value::trusted,
+            Map{
+                {strings.exec, system_closure([self](builtin_args_t args) {
+                     return self->exec(args);
+                 })},
+                {strings.exec_many,
+                 system_closure([self](builtin_args_t args) {
+                     return self->exec_many(args);
+                 })},
+                {strings.script, system_closure([self](builtin_args_t args) {
+                     return self->script(args);
+                 })},
+                {strings.query, system_closure([self](builtin_args_t args) {
+                     return self->query(args);
+                 })},
+                {strings.each, system_closure([self](builtin_args_t args) {
+                     return self->each(args);
+                 })},
+                {strings.collect, system_closure([self](builtin_args_t args) {
+                     return self->collect(args);
+                 })},
+                {strings.transaction,
+                 system_closure([self](builtin_args_t args) {
+                     return self->transaction(args);
+                 })},
+                {strings.last_insert_rowid,
+                 system_closure([self](builtin_args_t args) {
+                     return self->last_insert_rowid(args);
+                 })},
+                {strings.close, system_closure([self](builtin_args_t args) {
+                     return self->close(args);
+                 })},
+            });
+    }
+};
+
+struct Pool_Options
+{
+    std::size_t readers =
+        std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+    std::chrono::milliseconds reader_wait{5000};
+};
+
+Pool_Options parse_pool_options(const Map& opts)
+{
+    Pool_Options result;
+
+    for (const auto& [k_val, v_val] : opts)
+    {
+        if (not k_val->is<String>())
+            throw Frost_Recoverable_Error{
+                fmt::format("sqlite.open_pool: option keys must be Strings, "
+                            "got {}",
+                            k_val->type_name())};
+
+        const auto& key = k_val->raw_get<String>();
+
+        if (key == "readers")
+        {
+            if (not v_val->is<Int>() or v_val->raw_get<Int>() < 1)
+                throw Frost_Recoverable_Error{
+                    "sqlite.open_pool: readers option must be a positive Int"};
+            result.readers = static_cast<std::size_t>(v_val->raw_get<Int>());
+        }
+        else if (key == "reader_wait_ms")
+        {
+            if (not v_val->is<Int>() or v_val->raw_get<Int>() < 0)
+                throw Frost_Recoverable_Error{
+                    "sqlite.open_pool: reader_wait_ms option must be a "
+                    "non-negative Int"};
+            result.reader_wait =
+                std::chrono::milliseconds{v_val->raw_get<Int>()};
+        }
+        else
+        {
+            throw Frost_Recoverable_Error{fmt::format(
+                "sqlite.open_pool: unknown option '{}'", key)};
+        }
+    }
+
+    return result;
+}
 } // namespace
 
 Value_Ptr database_to_closuremap(const std::shared_ptr<Connection>& conn)
@@ -328,6 +836,20 @@ BUILTIN(open_memory)
     return database_to_closuremap(std::move(conn));
 }
 
+BUILTIN(open_pool)
+{
+    REQUIRE_ARGS("sqlite.open_pool", PARAM("path", TYPES(String)),
+                 OPTIONAL(PARAM("options", TYPES(Map))));
+
+    Pool_Options opts;
+    if (HAS(1))
+        opts = parse_pool_options(GET(1, Map));
+
+    return Pool_Methods{
+        Pool::create(GET(0, String), opts.readers, opts.reader_wait)}
+        .to_value();
+}
+
 BUILTIN(blob)
 {
     REQUIRE_ARGS("sqlite.blob", PARAM("data", TYPES(String)));
@@ -342,6 +864,6 @@ REGISTER_EXTENSION(sqlite,
                        Value::create(String{sqlite3_version}),
                    },
                    ENTRY(open), ENTRY(open_readonly), ENTRY(open_memory),
-                   ENTRY(blob))
+                   ENTRY(open_pool), ENTRY(blob))
 
 } // namespace frst
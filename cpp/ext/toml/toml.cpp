@@ -1,6 +1,7 @@
 #include "frost/exceptions.hpp"
 #include <frost/data-builtin.hpp>
 #include <frost/extensions-common.hpp>
+#include <frost/map-builder.hpp>
 #include <limits>
 
 #define TOML_EXCEPTIONS 0
@@ -382,13 +383,13 @@ struct Decode_Toml
 
     static Value_Ptr operator()(const tomlpp::table& table)
     {
-        Map result;
+        Map_Builder result;
+        result.reserve(table.size());
         for (const auto& [k, v] : table)
         {
-            result.try_emplace(Value::create(String{k}),
-                               v.visit(Decode_Toml{}));
+            result.add(Value::create(String{k}), v.visit(Decode_Toml{}));
         }
-        return Value::create(Value::trusted, std::move(result));
+        return Value::create(Value::trusted, std::move(result).build());
     }
 
     static Value_Ptr operator()(const tomlpp::value<tomlpp::date>& date)
@@ -9,6 +9,7 @@
 #include <frost/stdlib.hpp>
 #include <frost/symbol-table.hpp>
 #include <frost/value.hpp>
+#include <frost/vm.hpp>
 
 #include <fmt/format.h>
 
@@ -20,10 +21,16 @@
 using namespace std::literals;
 
 void exec_program(const std::vector<frst::ast::Statement::Ptr>& program,
-                  frst::Execution_Context ctx, bool do_dump)
+                  frst::Execution_Context ctx, bool do_dump, bool use_vm)
 {
     try
     {
+        if (use_vm && not do_dump)
+        {
+            (void)frst::vm::run(frst::vm::compile_program(program), ctx);
+            return;
+        }
+
         for (const auto& statement : program)
         {
             if (do_dump)
@@ -68,6 +75,8 @@ Options:
   -i, --interactive      Start the REPL after any -e or file
       --no-prelude       Skip loading the prelude
       --enable-backtrace Enable backtrace on error
+      --engine <name>    Execution engine: tree (default) or vm
+                         (experimental; no backtraces)
   -e, --eval <code>      Evaluate a snippet of Frost code (repeatable)
 
 Driver options end at the first non-flag argument (the script file)
@@ -86,6 +95,7 @@ int main(int argc, const char** argv)
     bool do_repl = false;
     bool do_dump = false;
     bool do_backtrace = false;
+    std::string_view engine = "tree";
 
     // Parse driver flags in a single pass.
     //
@@ -138,6 +148,10 @@ int main(int argc, const char** argv)
             skip_prelude = true;
         else if (arg == "--enable-backtrace")
             do_backtrace = true;
+        else if (arg == "--engine")
+            engine = take_value(arg);
+        else if (arg.starts_with("--engine="))
+            engine = arg.substr("--engine="sv.size());
         else if (arg == "-e" || arg == "--eval")
             strings_to_evaluate.emplace_back(take_value(arg));
         else
@@ -167,6 +181,25 @@ int main(int argc, const char** argv)
         return 1;
     }
 
+    if (engine != "tree" && engine != "vm")
+    {
+        fmt::println(stderr, "frost: unknown engine '{}'", engine);
+        return 1;
+    }
+
+    // The VM does not record a frame per node, so it can't produce a
+    // backtrace. Running the tree walker instead would quietly ignore the
+    // engine the user asked for
+    if (engine == "vm" && do_backtrace)
+    {
+        std::fputs("frost: --enable-backtrace is not supported by the vm "
+                   "engine\n",
+                   stderr);
+        return 1;
+    }
+
+    const bool use_vm = engine == "vm";
+
     frst::Backtrace_State trace;
     frst::Backtrace_State::set_current(do_backtrace ? &trace : nullptr);
 
@@ -218,7 +251,7 @@ int main(int argc, const char** argv)
             fmt::println(stderr, "{}", results.error());
             return 1;
         }
-        exec_program(results.value(), main_ctx, do_dump);
+        exec_program(results.value(), main_ctx, do_dump, use_vm);
     }
 
     if (file_to_evaluate)
@@ -229,7 +262,7 @@ int main(int argc, const char** argv)
             fmt::println(stderr, "{}", results.error());
             return 1;
         }
-        exec_program(results.value(), main_ctx, do_dump);
+        exec_program(results.value(), main_ctx, do_dump, use_vm);
     }
 
     if (not file_to_evaluate && strings_to_evaluate.empty())
@@ -0,0 +1,207 @@
+#include <frost/builtins-common.hpp>
+
+#include <frost/async.hpp>
+#include <frost/backtrace.hpp>
+#include <frost/builtin.hpp>
+#include <frost/symbol-table.hpp>
+#include <frost/thread-pool.hpp>
+#include <frost/value.hpp>
+
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <ranges>
+#include <vector>
+
+namespace frst
+{
+
+namespace
+{
+// Backtraces are recorded per thread, so while they're on everything runs on
+// the calling thread to keep every frame
+bool run_serially(const Array& arr)
+{
+    return Backtrace_State::current() || arr.size() < 2;
+}
+
+// A few chunks per worker evens out elements that take uneven time
+std::size_t chunk_size_for(std::size_t count)
+{
+    const auto chunk_count = Thread_Pool::shared().size() * 4;
+    return (count + chunk_count - 1) / chunk_count;
+}
+
+std::ranges::subrange<Array::const_iterator> chunk_of(const Array& arr,
+                                                      std::size_t begin,
+                                                      std::size_t end)
+{
+    return {arr.begin() + static_cast<std::ptrdiff_t>(begin),
+            arr.begin() + static_cast<std::ptrdiff_t>(end)};
+}
+
+Value_Ptr spawned_result(Value_Ptr&& result)
+{
+    return std::move(result);
+}
+
+using Spawned_Task = async::Future<Value_Ptr, spawned_result>;
+
+// Every spawned task holds the pool, so the pool outlives the script's last
+// reference to it until its queue has drained
+Value_Ptr spawn_on(std::shared_ptr<Thread_Pool> pool, Function fn,
+                   Array fn_args)
+{
+    auto task = std::make_shared<Spawned_Task>();
+
+    std::packaged_task<Value_Ptr()> job{
+        [fn = std::move(fn), fn_args = std::move(fn_args)] {
+            return fn->call(fn_args);
+        }};
+    task->future = job.get_future();
+
+    pool->post([task, job = std::move(job), pool]() mutable {
+        job();
+        task->complete = true;
+    });
+
+    return async::make_future_value(std::move(task), "thread_pool.spawn");
+}
+} // namespace
+
+BUILTIN(pmap)
+{
+    REQUIRE_ARGS("pmap", TYPES(Array), TYPES(Function));
+
+    const auto& arr = GET(0, Array);
+    const auto& fn = GET(1, Function);
+
+    if (run_serially(arr))
+        return Value::do_map(args.at(0), fn, "Builtin pmap");
+
+    Array result(arr.size());
+    Thread_Pool::shared().for_chunks(
+        arr.size(), chunk_size_for(arr.size()),
+        [&](std::size_t begin, std::size_t end) {
+            for (auto i = begin; i < end; ++i)
+                result[i] = fn->call({arr[i]});
+        });
+
+    return Value::create(std::move(result));
+}
+
+BUILTIN(pselect)
+{
+    REQUIRE_ARGS("pselect", TYPES(Array), TYPES(Function));
+
+    const auto& arr = GET(0, Array);
+    const auto& pred = GET(1, Function);
+
+    if (run_serially(arr))
+        return Value::do_filter(args.at(0), pred);
+
+    // Not std::vector<bool>, which packs its elements and so cannot be
+    // written from several threads at once
+    std::vector<char> keep(arr.size());
+    Thread_Pool::shared().for_chunks(
+        arr.size(), chunk_size_for(arr.size()),
+        [&](std::size_t begin, std::size_t end) {
+            for (auto i = begin; i < end; ++i)
+                keep[i] = pred->call({arr[i]})->truthy();
+        });
+
+    Array result;
+    for (const auto& [elem, kept] : std::views::zip(arr, keep))
+    {
+        if (kept)
+            result.push_back(elem);
+    }
+
+    return Value::create(std::move(result));
+}
+
+BUILTIN(preduce)
+{
+    REQUIRE_ARGS("preduce", TYPES(Array), TYPES(Function),
+                 OPTIONAL(PARAM("init", ANY)),
+                 OPTIONAL(PARAM("combine", TYPES(Function))));
+
+    const auto& arr = GET(0, Array);
+    const auto& fn = GET(1, Function);
+    const auto init =
+        HAS(2) ? std::optional<Value_Ptr>{args.at(2)} : std::nullopt;
+
+    // With init, fn may take an accumulator of another type than the
+    // elements, so the results of chunks can only be put together by a
+    // combine of their own
+    if (run_serially(arr) || (init && not HAS(3)))
+        return Value::do_reduce(args.at(0), fn, init);
+
+    const auto& combine = HAS(3) ? GET(3, Function) : fn;
+
+    const auto reduction = [&](const Value_Ptr& acc, const Value_Ptr& elem) {
+        return fn->call({acc, elem});
+    };
+    const auto combination = [&](const Value_Ptr& left,
+                                 const Value_Ptr& right) {
+        return combine->call({left, right});
+    };
+
+    // Each chunk is reduced on its own, from init if there is one, then the
+    // results are combined in order. This matches fold when combine is
+    // associative, and init changes nothing it is combined with.
+    const auto chunk_size = chunk_size_for(arr.size());
+    std::vector<Value_Ptr> partials((arr.size() + chunk_size - 1) / chunk_size);
+    Thread_Pool::shared().for_chunks(
+        arr.size(), chunk_size, [&](std::size_t begin, std::size_t end) {
+            const auto chunk = chunk_of(arr, begin, end);
+            partials[begin / chunk_size] =
+                init ? std::ranges::fold_left(chunk, *init, reduction)
+                     : std::ranges::fold_left_first(chunk, reduction).value();
+        });
+
+    return std::ranges::fold_left_first(partials, combination).value();
+}
+
+BUILTIN(thread_pool)
+{
+    REQUIRE_ARGS("thread_pool", PARAM("thread count", TYPES(Int)));
+
+    const auto thread_count = GET(0, Int);
+    if (thread_count <= 0)
+        throw Frost_Recoverable_Error{
+            "Function thread_pool requires its thread count to be >0"};
+
+    auto pool =
+        std::make_shared<Thread_Pool>(static_cast<std::size_t>(thread_count));
+
+    STRINGS(spawn, size);
+
+    auto spawn = system_closure([pool](builtin_args_t args) {
+        REQUIRE_ARGS("thread_pool.spawn", PARAM("function", TYPES(Function)),
+                     VARIADIC_REST(0, "argument", ANY));
+
+        return spawn_on(pool, GET(0, Function),
+                        Array{std::from_range, args.subspan(1)});
+    });
+
+    auto size = system_closure([pool](builtin_args_t args) {
+        REQUIRE_NULLARY("thread_pool.size");
+        return Value::create(static_cast<Int>(pool->size()));
+    });
+
+    return Value::create(Value::trusted,
+                         Map{
+                             {strings.spawn, std::move(spawn)},
+                             {strings.size, std::move(size)},
+                         });
+}
+
+void inject_parallel(Symbol_Table& table)
+{
+    INJECT(pmap);
+    INJECT(pselect);
+    INJECT(preduce);
+    INJECT(thread_pool);
+}
+} // namespace frst
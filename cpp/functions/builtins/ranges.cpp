@@ -7,6 +7,7 @@
 
 #include <algorithm>
 #include <ranges>
+#include <utility>
 
 namespace frst
 {
@@ -39,6 +40,13 @@ Value_Ptr dispatch_sequence(const Value_Ptr& val, auto&& fn)
     return fn(val->raw_get<Array>());
 }
 
+std::size_t sequence_size(const Value_Ptr& val)
+{
+    if (val->is<String>())
+        return val->raw_get<String>().size();
+    return val->raw_get<Array>().size();
+}
+
 template <auto adaptor, typename Seq>
 Value_Ptr apply_view(const Seq& seq, Int num)
 {
@@ -62,16 +70,6 @@ Value_Ptr apply_rewrap_view(const Array& arr, Int num)
         arr | adaptor(num) | array_array | std::ranges::to<Array>());
 }
 
-template <auto adaptor>
-Value_Ptr apply_pred_view(const Array& arr, const Function& fn)
-{
-    return Value::create(arr
-                         | adaptor([&](const Value_Ptr& val) {
-                               return fn->call({val})->truthy();
-                           })
-                         | std::ranges::to<Array>());
-}
-
 template <auto algorithm>
 Value_Ptr quantifier_impl(std::string_view name, builtin_args_t args)
 {
@@ -112,6 +110,10 @@ BUILTIN(take)
     auto num = GET(1, Int);
     require_nonnegative("take", num);
 
+    // The whole sequence is kept, so share it
+    if (std::cmp_greater_equal(num, sequence_size(args.at(0))))
+        return args.at(0);
+
     return dispatch_sequence(args.at(0), [&](const auto& seq) {
         return apply_view<std::views::take>(seq, num);
     });
@@ -124,6 +126,10 @@ BUILTIN(drop)
     auto num = GET(1, Int);
     require_nonnegative("drop", num);
 
+    // The whole sequence is kept, so share it
+    if (num == 0)
+        return args.at(0);
+
     return dispatch_sequence(args.at(0), [&](const auto& seq) {
         return apply_view<std::views::drop>(seq, num);
     });
@@ -136,6 +142,10 @@ BUILTIN(tail)
     auto num = GET(1, Int);
     require_nonnegative("tail", num);
 
+    // The whole sequence is kept, so share it
+    if (std::cmp_greater_equal(num, sequence_size(args.at(0))))
+        return args.at(0);
+
     return dispatch_sequence(args.at(0), [&](const auto& seq) {
         return apply_rev_view<std::views::take>(seq, num);
     });
@@ -148,6 +158,10 @@ BUILTIN(drop_tail)
     auto num = GET(1, Int);
     require_nonnegative("drop_tail", num);
 
+    // The whole sequence is kept, so share it
+    if (num == 0)
+        return args.at(0);
+
     return dispatch_sequence(args.at(0), [&](const auto& seq) {
         return apply_rev_view<std::views::drop>(seq, num);
     });
@@ -185,8 +199,8 @@ BUILTIN(reverse)
     });
 }
 
-// TODO: {take,drop}_while can evaluate the predicate multiple times
-//       per element
+// These search with the predicate once, rather than going through
+// std::views::{take,drop}_while, which can call it more than once per element
 BUILTIN(take_while)
 {
     REQUIRE_ARGS("take_while", TYPES(Array), TYPES(Function));
@@ -194,7 +208,11 @@ BUILTIN(take_while)
     const auto& arr = GET(0, Array);
     const auto& fn = GET(1, Function);
 
-    return apply_pred_view<std::views::take_while>(arr, fn);
+    const auto end = std::ranges::find_if_not(arr, [&](const Value_Ptr& val) {
+        return fn->call({val})->truthy();
+    });
+
+    return Value::create(Array{arr.begin(), end});
 }
 
 BUILTIN(drop_while)
@@ -204,7 +222,11 @@ BUILTIN(drop_while)
     const auto& arr = GET(0, Array);
     const auto& fn = GET(1, Function);
 
-    return apply_pred_view<std::views::drop_while>(arr, fn);
+    const auto begin = std::ranges::find_if_not(arr, [&](const Value_Ptr& val) {
+        return fn->call({val})->truthy();
+    });
+
+    return Value::create(Array{begin, arr.end()});
 }
 
 BUILTIN(chunk_by)
@@ -492,32 +514,52 @@ Value_Ptr generalize_map(T&& map)
                          | std::views::transform(make_map_generalizer_for(map))
                          | std::ranges::to<Map>());
 }
-} // namespace
 
-BUILTIN(group_by)
+// Key every element of arr with fn, and fold each element into the group for
+// its key, in order. Sorting the keys once keeps this O(n log n), where
+// inserting each new key into the flat_map as it's seen is quadratic.
+template <typename Group>
+auto group_elements(const Array& arr, const Function& fn, auto&& fold)
 {
-    REQUIRE_ARGS("group_by", TYPES(Array), TYPES(Function));
+    using Groups = std::flat_map<Value_Ptr, Group, impl::Value_Ptr_Less>;
+    using Keyed = std::pair<Value_Ptr, Value_Ptr>;
+    constexpr auto less = impl::Value_Ptr_Less{};
 
-    std::flat_map<Value_Ptr, Array, impl::Value_Ptr_Less> groups;
-
-    auto arr = GET(0, Array);
-    auto fn = GET(1, Function);
+    auto keyed = arr
+                 | std::views::transform([&](const Value_Ptr& elem) {
+                       return Keyed{fn->call({elem}), elem};
+                   })
+                 | std::ranges::to<std::vector>();
+    std::ranges::stable_sort(keyed, less, &Keyed::first);
 
-    for (const auto& elem : arr)
+    std::vector<Value_Ptr> keys;
+    std::vector<Group> groups;
+    for (auto& [key, elem] : keyed)
     {
-        auto key = fn->call({elem});
-
-        auto itr = groups.find(key);
-        if (itr == groups.end())
+        if (keys.empty() || less(keys.back(), key))
         {
-            groups.emplace(key, Array{elem});
-        }
-        else
-        {
-            itr->second.push_back(elem);
+            keys.push_back(std::move(key));
+            groups.emplace_back();
         }
+        fold(groups.back(), elem);
     }
 
+    return Groups{std::sorted_unique, std::move(keys), std::move(groups)};
+}
+} // namespace
+
+BUILTIN(group_by)
+{
+    REQUIRE_ARGS("group_by", TYPES(Array), TYPES(Function));
+
+    const auto& arr = GET(0, Array);
+    const auto& fn = GET(1, Function);
+
+    auto groups =
+        group_elements<Array>(arr, fn, [](Array& group, const Value_Ptr& elem) {
+            group.push_back(elem);
+        });
+
     return generalize_map(std::move(groups));
 }
 
@@ -525,17 +567,13 @@ BUILTIN(count_by)
 {
     REQUIRE_ARGS("count_by", TYPES(Array), TYPES(Function));
 
-    std::flat_map<Value_Ptr, Int, impl::Value_Ptr_Less> counts;
-
-    auto arr = GET(0, Array);
-    auto fn = GET(1, Function);
-
-    for (const auto& elem : arr)
-    {
-        auto key = fn->call({elem});
+    const auto& arr = GET(0, Array);
+    const auto& fn = GET(1, Function);
 
-        ++counts[key]; // leverage operator[] default-constructing
-    }
+    auto counts =
+        group_elements<Int>(arr, fn, [](Int& count, const Value_Ptr&) {
+            ++count;
+        });
 
     return generalize_map(std::move(counts));
 }
@@ -672,6 +710,8 @@ BUILTIN(slice)
 
         if (start >= end)
             return Value::create(Seq{});
+        if (start == 0 && end == seq.size())
+            return args.at(0);
 
         return Value::create(Seq{seq.begin() + static_cast<Int>(start),
                                  seq.begin() + static_cast<Int>(end)});
@@ -5,24 +5,71 @@
 #include <frost/symbol-table.hpp>
 #include <frost/value.hpp>
 
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
 #include <iostream>
 
 namespace frst
 {
 
+namespace streams_detail
+{
+
+namespace
+{
+
+// Each underflow takes whatever one read of the descriptor returns, so what
+// a pipe has delivered so far shows up in in_avail
+class Stdin_Buf : public std::streambuf
+{
+  protected:
+    int_type underflow() override
+    {
+        if (gptr() < egptr())
+            return traits_type::to_int_type(*gptr());
+
+        ssize_t got;
+        do
+            got = ::read(STDIN_FILENO, buffer_.data(), buffer_.size());
+        while (got < 0 && errno == EINTR);
+
+        if (got <= 0)
+            return traits_type::eof();
+
+        setg(buffer_.data(), buffer_.data(), buffer_.data() + got);
+        return traits_type::to_int_type(*gptr());
+    }
+
+  private:
+    std::array<char, 64 * 1024> buffer_;
+};
+
+} // namespace
+
+std::istream& standard_input()
+{
+    static Stdin_Buf buf;
+    static std::istream stream{&buf};
+    return stream;
+}
+
+} // namespace streams_detail
+
 using namespace streams_detail;
 
-STRINGS(read_line, read_one, read, read_rest, write, writeln);
+STRINGS(read_line, read_one, read, read_rest, read_some, write, writeln);
 
 namespace
 {
 
 Value_Ptr make_stdin()
 {
-    // A shared ptr to std::cin with a no-op delete...
+    // A shared ptr to standard input with a no-op delete...
     // I'm not proud of this...
     auto hacky_stdin_ptr = std::make_shared<Locked_Stream<std::istream>>(
-        std::shared_ptr<std::istream>(&std::cin, [](auto&&...) {
+        std::shared_ptr<std::istream>(&standard_input(), [](auto&&...) {
         }));
 
     return Value::create(Value::trusted,
@@ -31,6 +78,7 @@ Value_Ptr make_stdin()
                              {strings.read_one, read_one(hacky_stdin_ptr)},
                              {strings.read, read_rest(hacky_stdin_ptr)},
                              {strings.read_rest, read_rest(hacky_stdin_ptr)},
+                             {strings.read_some, read_some(hacky_stdin_ptr)},
                          });
 }
 
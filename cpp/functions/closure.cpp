@@ -1,6 +1,9 @@
 #include <frost/ast.hpp>
+#include <frost/ast/resolver.hpp>
 #include <frost/closure.hpp>
+#include <frost/frame.hpp>
 #include <frost/symbol-table.hpp>
+#include <frost/tail-call.hpp>
 
 #include <fmt/format.h>
 
@@ -8,41 +11,118 @@
 
 using namespace frst;
 
-Closure::Closure(std::vector<std::string> parameters,
+namespace
+{
+// The `[...]` of a body that is only `p + [...]`, for the first parameter p,
+// when nothing in the brackets uses p
+const ast::Expression* find_appended_elements(
+    const std::vector<std::string>& parameters, bool dollar_alias,
+    const std::vector<ast::Statement::Ptr>& body_prefix,
+    const ast::Expression& return_expr)
+{
+    if (parameters.empty() || not body_prefix.empty())
+        return nullptr;
+
+    const auto* binop = dynamic_cast<const ast::Binop*>(&return_expr);
+    if (not binop || binop->op() != ast::Binary_Op::PLUS)
+        return nullptr;
+
+    const auto* acc = dynamic_cast<const ast::Name_Lookup*>(&binop->lhs());
+    const auto* elems =
+        dynamic_cast<const ast::Array_Constructor*>(&binop->rhs());
+    if (not acc || not elems || acc->name() != parameters.front())
+        return nullptr;
+
+    for (const auto& action : elems->symbol_sequence())
+    {
+        const auto* used = std::get_if<ast::AST_Node::Usage>(&action);
+        if (used
+            && (used->name == parameters.front()
+                || (dollar_alias && used->name == "$")))
+            return nullptr;
+    }
+
+    return elems;
+}
+} // namespace
+
+std::shared_ptr<const Frame_Layout> frst::resolve_frame_layout(
+    std::vector<std::string> parameters,
+    std::optional<std::string> vararg_parameter,
+    std::optional<std::string> self_name, std::vector<std::string> captures,
+    const std::vector<ast::Statement::Ptr>& body_prefix,
+    const ast::Expression& return_expr)
+{
+    ast::Resolver resolver{captures};
+
+    // Must match the order in which Closure::call binds them
+    for (const auto& param : parameters)
+        resolver.define(param);
+    if (vararg_parameter)
+        resolver.define(vararg_parameter.value());
+    if (self_name)
+        resolver.define(self_name.value());
+
+    const bool dollar_alias =
+        not parameters.empty() && parameters.front() == "$1";
+    if (dollar_alias)
+        resolver.define("$");
+
+    for (const ast::Statement::Ptr& node : body_prefix)
+        node->resolve(resolver);
+    return_expr.resolve(resolver);
+
+    const auto* appended_elements = find_appended_elements(
+        parameters, dollar_alias, body_prefix, return_expr);
+
+    return std::make_shared<const Frame_Layout>(Frame_Layout{
+        .parameters = std::move(parameters),
+        .vararg_parameter = std::move(vararg_parameter),
+        .self_name = std::move(self_name),
+        .dollar_alias = dollar_alias,
+        .captures = std::move(captures),
+        .local_count = resolver.local_count(),
+        .appended_elements = appended_elements,
+    });
+}
+
+Closure::Closure(std::shared_ptr<const Frame_Layout> layout,
                  std::shared_ptr<std::vector<ast::Statement::Ptr>> body_prefix,
                  std::shared_ptr<ast::Expression> return_expr,
-                 Symbol_Table captures, std::size_t define_count,
-                 std::optional<std::string> vararg_parameter,
-                 std::optional<std::string> self_name)
-    : parameters_{std::move(parameters)}
+                 std::vector<Value_Ptr> captures,
+                 std::shared_ptr<const Compiled_Body> compiled_body)
+    : layout_{std::move(layout)}
     , body_prefix_{std::move(body_prefix)}
     , return_expr_{std::move(return_expr)}
     , captures_{std::move(captures)}
-    , vararg_parameter_{std::move(vararg_parameter)}
-    , self_name_{std::move(self_name)}
-    , define_count_{define_count}
+    , compiled_body_{std::move(compiled_body)}
 {
-    // Assumed: all params in parameters_ and vararg_parameter_ (if present) are
-    // all unique. No duplicates exist.
+    // Assumed: all params in the layout's parameters and vararg_parameter (if
+    // present) are all unique. No duplicates exist.
     // This must be checked by the Lambda AST node.
+    if (captures_.size() != layout_->captures.size())
+        THROW_UNREACHABLE;
 }
 
 std::shared_ptr<Closure> Closure::create(
-    std::vector<std::string> parameters,
+    std::shared_ptr<const Frame_Layout> layout,
     std::shared_ptr<std::vector<ast::Statement::Ptr>> body,
-    std::shared_ptr<ast::Expression> return_expr, Symbol_Table captures,
-    std::size_t define_count, std::optional<std::string> vararg_parameter,
-    std::optional<std::string> self_name)
+    std::shared_ptr<ast::Expression> return_expr,
+    std::vector<Value_Ptr> captures,
+    std::shared_ptr<const Compiled_Body> compiled_body)
 {
     return std::make_shared<Closure>(
-        std::move(parameters), std::move(body), std::move(return_expr),
-        std::move(captures), define_count, std::move(vararg_parameter),
-        std::move(self_name));
+        std::move(layout), std::move(body), std::move(return_expr),
+        std::move(captures), std::move(compiled_body));
 }
 
-const Symbol_Table& Closure::debug_capture_table() const
+Symbol_Table Closure::debug_capture_table() const
 {
-    return captures_;
+    Symbol_Table table;
+    for (const auto& [name, value] :
+         std::views::zip(layout_->captures, captures_))
+        table.define(name, value);
+    return table;
 }
 
 Function Closure::self_function() const
@@ -52,58 +132,112 @@ Function Closure::self_function() const
 
 Value_Ptr Closure::call(std::span<const Value_Ptr> args) const
 {
-    if (!vararg_parameter_ && args.size() != parameters_.size())
+    // A body ending in a tail call leaves the call to be made here, in place
+    // of this one, so tail recursion never nests
+    const Closure* closure = this;
+    Function callee;
+    std::vector<Value_Ptr> callee_args;
+
+    while (true)
+    {
+        if (Value_Ptr result = closure->run_body(args))
+            return result;
+
+        auto tail_call = Tail_Call::take();
+        if (not tail_call)
+            THROW_UNREACHABLE;
+
+        // Whatever the previous iteration held on to is done with now
+        callee = std::move(tail_call->callee);
+        callee_args = std::move(tail_call->args);
+        args = callee_args;
+
+        closure = dynamic_cast<const Closure*>(callee.get());
+        if (not closure)
+            return callee->call(args);
+    }
+}
+
+template <typename Run>
+Value_Ptr Closure::in_frame(std::span<const Value_Ptr> args, Run run) const
+{
+    const Frame_Layout& layout = *layout_;
+
+    if (!layout.vararg_parameter && args.size() != layout.parameters.size())
     {
         throw Frost_Recoverable_Error{
             fmt::format("Closure called with wrong number of arguments. "
                         "Expected {}, but got {}.",
-                        parameters_.size(), args.size())};
+                        layout.parameters.size(), args.size())};
     }
 
-    if (vararg_parameter_ && args.size() < parameters_.size())
+    if (layout.vararg_parameter && args.size() < layout.parameters.size())
     {
         throw Frost_Recoverable_Error{
             fmt::format("Closure called with wrong number of arguments. "
                         "Expected at least {}, but got {}.",
-                        parameters_.size(), args.size())};
+                        layout.parameters.size(), args.size())};
     }
 
-    Symbol_Table scope_table(&captures_);
-    Execution_Context scope_ctx{.symbols = scope_table};
-    scope_ctx.symbols.reserve(define_count_ + (self_name_ ? 1 : 0));
-    for (const auto& [arg_name, arg_val] : std::views::zip(parameters_, args))
-    {
-        scope_ctx.symbols.define(arg_name, arg_val);
-    }
+    // Slot order is fixed by resolve_frame_layout
+    Frame frame{captures_, layout.local_count};
+    std::uint32_t next_slot = 0;
+    for (const auto& arg_val : args.first(layout.parameters.size()))
+        frame.set(next_slot++, arg_val);
 
-    if (vararg_parameter_)
+    if (layout.vararg_parameter)
     {
-        scope_ctx.symbols.define(
-            vararg_parameter_.value(),
-            Value::create(args
-                          | std::views::drop(parameters_.size())
-                          | std::ranges::to<Array>()));
+        frame.set(next_slot++,
+                  Value::create(args
+                                | std::views::drop(layout.parameters.size())
+                                | std::ranges::to<Array>()));
     }
 
-    if (self_name_)
-        scope_ctx.symbols.define(self_name_.value(),
-                                 Value::create(self_function()));
+    if (layout.self_name)
+        frame.set(next_slot++, Value::create(self_function()));
 
-    if (parameters_.size() != 0 && parameters_.front() == "$1")
-        scope_ctx.symbols.define("$", args.front());
+    if (layout.dollar_alias)
+        frame.set(next_slot++, args.front());
 
-    for (const ast::Statement::Ptr& node : *body_prefix_)
-    {
-        node->execute(scope_ctx);
-    }
+    Execution_Context scope_ctx{.symbols = Symbol_Table::sealed(),
+                                .frame = &frame};
 
-    return return_expr_->evaluate(scope_ctx.as_eval());
+    return run(scope_ctx);
+}
+
+Value_Ptr Closure::run_body(std::span<const Value_Ptr> args) const
+{
+    return in_frame(args, [&](Execution_Context scope_ctx) {
+        if (compiled_body_)
+            return compiled_body_->run(scope_ctx);
+
+        for (const ast::Statement::Ptr& node : *body_prefix_)
+        {
+            node->execute(scope_ctx);
+        }
+
+        return return_expr_->evaluate(scope_ctx.as_eval());
+    });
+}
+
+bool Closure::appends_to_first_argument() const
+{
+    return layout_->appended_elements != nullptr;
+}
+
+// The brackets are evaluated on their own, even when the body is compiled,
+// as they resolved to the same frame slots
+Value_Ptr Closure::appended_elements(std::span<const Value_Ptr> args) const
+{
+    return in_frame(args, [&](Execution_Context scope_ctx) {
+        return layout_->appended_elements->evaluate(scope_ctx.as_eval());
+    });
 }
 
 std::string Closure::name() const
 {
-    if (self_name_)
-        return self_name_.value();
+    if (layout_->self_name)
+        return layout_->self_name.value();
     return "<anonymous>";
 }
 
@@ -112,11 +246,11 @@ std::string Closure::debug_dump() const
     std::ostringstream os;
     os << "<Closure>";
 
-    if (not captures_.empty())
+    if (not layout_->captures.empty())
     {
         os
             << " (capturing: "
-            << (captures_.names()
+            << (layout_->captures
                 | std::views::join_with(',')
                 | std::ranges::to<std::string>())
             << ")";
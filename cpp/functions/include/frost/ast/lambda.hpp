@@ -33,6 +33,30 @@ class Lambda final : public Expression
 
     std::generator<Symbol_Action> symbol_sequence() const final;
 
+    void resolve(Resolver& resolver) const final;
+
+    const Frame_Layout& layout() const
+    {
+        return *layout_;
+    }
+
+    const std::vector<Statement::Ptr>& body_prefix() const
+    {
+        return *body_prefix_;
+    }
+
+    const Expression& return_expr() const
+    {
+        return *return_expr_;
+    }
+
+    // Closures created from this lambda afterwards run `body` in place of
+    // walking their body
+    void set_compiled_body(std::shared_ptr<const Compiled_Body> body) const
+    {
+        compiled_body_ = std::move(body);
+    }
+
   protected:
     std::string do_node_label() const final;
 
@@ -41,13 +65,16 @@ class Lambda final : public Expression
     std::generator<Child_Info> children() const final;
 
   private:
-    std::vector<std::string> params_;
-    std::flat_set<std::string> names_to_capture_;
     std::shared_ptr<std::vector<Statement::Ptr>> body_prefix_;
     std::shared_ptr<ast::Expression> return_expr_;
-    std::optional<std::string> vararg_param_;
-    std::optional<std::string> self_name_;
-    std::size_t closure_define_count_;
+    std::shared_ptr<const Frame_Layout> layout_;
+
+    // Where each capture comes from in the enclosing closure's frame,
+    // stamped by resolve() when this lambda is itself within a closure body
+    mutable std::optional<std::vector<std::optional<Frame_Slot>>>
+        capture_slots_;
+
+    mutable std::shared_ptr<const Compiled_Body> compiled_body_;
 };
 } // namespace frst::ast
 
@@ -1,44 +1,118 @@
 #ifndef FROST_BUILTINS_ASYNC_HPP
 #define FROST_BUILTINS_ASYNC_HPP
 
+#include <frost/builtins-common.hpp>
 #include <frost/value.hpp>
 
-#include <boost/asio/io_context.hpp>
-
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <future>
-#include <thread>
+#include <memory>
+#include <mutex>
+#include <string_view>
 
 namespace frst::async
 {
 
+//! @brief A result being produced on another thread, as seen from Frost
+//!
+//! Whatever produces the result sets `complete` once it's done, whether or
+//! not it succeeded. The first get() waits for the result and translates it
+//! to a Value, and every get() after produces that same Value, or rethrows
+//! the same error.
 template <std::movable Result, std::invocable<Result&&> auto Translate>
     requires std::is_same_v<Value_Ptr,
                             std::invoke_result_t<decltype(Translate), Result&&>>
-struct Task
+struct Future
 {
-    boost::asio::io_context ioc;
     std::future<Result> future;
-    std::jthread worker;
 
     std::atomic<bool> complete = false;
     std::once_flag cache_once;
     Value_Ptr cache;
+    std::exception_ptr error;
+
+    // Taking the result leaves the future invalid, so that is kept apart from
+    // anyone still waiting on it
+    std::mutex take_mutex;
 
     Value_Ptr get()
     {
         std::call_once(cache_once, [&] {
-            Result result = future.get();
-            cache = Translate(std::move(result));
+            try
+            {
+                future.wait();
+                Result result = [&] {
+                    std::lock_guard lock{take_mutex};
+                    return future.get();
+                }();
+                cache = Translate(std::move(result));
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
             complete = true;
         });
+
+        if (error)
+            std::rethrow_exception(error);
         return cache;
     }
     Value_Ptr is_ready()
     {
         return Value::create(complete.load());
     }
+    Value_Ptr wait_for(std::chrono::milliseconds timeout)
+    {
+        std::lock_guard lock{take_mutex};
+        if (not future.valid())
+            return Value::create(true);
+        return Value::create(future.wait_for(timeout)
+                             == std::future_status::ready);
+    }
 };
 
+//! @brief The Frost value for a Future: a Map of get, is_ready and wait_for
+//!
+//! `name` is what errors from the methods are reported under, e.g.
+//! "http.request" for "http.request.get"
+template <typename Future_Type>
+Value_Ptr make_future_value(std::shared_ptr<Future_Type> future,
+                            std::string_view name)
+{
+    STRINGS(get, is_ready, wait_for);
+
+    auto get = system_closure(
+        [future, fn = fmt::format("{}.get", name)](builtin_args_t args) {
+            REQUIRE_NULLARY(fn);
+            return future->get();
+        });
+
+    auto is_ready = system_closure(
+        [future, fn = fmt::format("{}.is_ready", name)](builtin_args_t args) {
+            REQUIRE_NULLARY(fn);
+            return future->is_ready();
+        });
+
+    // Negative timeouts just check, as zero does
+    auto wait_for = system_closure(
+        [future, fn = fmt::format("{}.wait_for", name)](builtin_args_t args) {
+            REQUIRE_ARGS(fn, PARAM("milliseconds", TYPES(Int)));
+            return future->wait_for(
+                std::chrono::milliseconds{std::max(GET(0, Int), Int{0})});
+        });
+
+    return Value::create(Value::trusted,
+                         Map{
+                             {strings.get, std::move(get)},
+                             {strings.is_ready, std::move(is_ready)},
+                             {strings.wait_for, std::move(wait_for)},
+                         });
+}
+
 } // namespace frst::async
 
 #endif
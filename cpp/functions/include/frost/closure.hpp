@@ -3,13 +3,63 @@
 
 #include <frost/ast/expression.hpp>
 #include <frost/ast/statement.hpp>
+#include <frost/execution-context.hpp>
 #include <frost/symbol-table.hpp>
 #include <frost/value.hpp>
 
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 namespace frst
 {
+
+//! @brief Where each name in a closure body lives in its frame
+//!
+//! Shared by every closure created from the same lambda. The first local
+//! slots are, in order: the parameters, the vararg parameter, the self
+//! binding, and the `$` alias.
+struct Frame_Layout
+{
+    std::vector<std::string> parameters;
+    std::optional<std::string> vararg_parameter;
+    std::optional<std::string> self_name;
+    bool dollar_alias = false;
+    std::vector<std::string> captures;
+    std::size_t local_count = 0;
+
+    // Set when the body is only `p + [...]`, for the first parameter p, and
+    // nothing in the brackets uses p: the bracketed Array_Constructor
+    const ast::Expression* appended_elements = nullptr;
+};
+
+// Resolve every name in a closure body to a frame slot
+// Assumed: the parameters, vararg parameter, and self name are all unique
+std::shared_ptr<const Frame_Layout> resolve_frame_layout(
+    std::vector<std::string> parameters,
+    std::optional<std::string> vararg_parameter,
+    std::optional<std::string> self_name, std::vector<std::string> captures,
+    const std::vector<ast::Statement::Ptr>& body_prefix,
+    const ast::Expression& return_expr);
+
+//! @brief A closure body lowered to some other form than the AST
+//!
+//! Produced by an alternative execution engine, and run in place of walking
+//! the body. Runs against the closure's frame once the parameters are bound.
+class Compiled_Body
+{
+  public:
+    Compiled_Body() = default;
+    Compiled_Body(const Compiled_Body&) = delete;
+    Compiled_Body(Compiled_Body&&) = delete;
+    Compiled_Body& operator=(const Compiled_Body&) = delete;
+    Compiled_Body& operator=(Compiled_Body&&) = delete;
+    virtual ~Compiled_Body() = default;
+
+    virtual Value_Ptr run(Execution_Context ctx) const = 0;
+};
+
 class Closure : public Callable, public std::enable_shared_from_this<Closure>
 {
   public:
@@ -20,36 +70,42 @@ class Closure : public Callable, public std::enable_shared_from_this<Closure>
     Closure& operator=(Closure&&) = delete;
     ~Closure() override = default;
 
-    Closure(std::vector<std::string> parameters,
+    // `captures` holds one value per name in `layout->captures`
+    Closure(std::shared_ptr<const Frame_Layout> layout,
             std::shared_ptr<std::vector<ast::Statement::Ptr>> body,
-            std::shared_ptr<ast::Expression> return_expr, Symbol_Table captures,
-            std::size_t define_count,
-            std::optional<std::string> vararg_parameter = {},
-            std::optional<std::string> self_name = {});
+            std::shared_ptr<ast::Expression> return_expr,
+            std::vector<Value_Ptr> captures,
+            std::shared_ptr<const Compiled_Body> compiled_body = nullptr);
 
     static std::shared_ptr<Closure> create(
-        std::vector<std::string> parameters,
+        std::shared_ptr<const Frame_Layout> layout,
         std::shared_ptr<std::vector<ast::Statement::Ptr>> body,
-        std::shared_ptr<ast::Expression> return_expr, Symbol_Table captures,
-        std::size_t define_count,
-        std::optional<std::string> vararg_parameter = {},
-        std::optional<std::string> self_name = {});
+        std::shared_ptr<ast::Expression> return_expr,
+        std::vector<Value_Ptr> captures,
+        std::shared_ptr<const Compiled_Body> compiled_body = nullptr);
 
     Value_Ptr call(std::span<const Value_Ptr> args) const override;
+    bool appends_to_first_argument() const override;
+    Value_Ptr appended_elements(std::span<const Value_Ptr> args) const override;
     std::string debug_dump() const override;
     std::string name() const override;
-    const Symbol_Table& debug_capture_table() const;
+    Symbol_Table debug_capture_table() const;
 
   private:
     Function self_function() const;
 
-    std::vector<std::string> parameters_;
+    // Run the body once, without following its tail call
+    Value_Ptr run_body(std::span<const Value_Ptr> args) const;
+
+    // Bind args in a new frame, then call run with its context
+    template <typename Run>
+    Value_Ptr in_frame(std::span<const Value_Ptr> args, Run run) const;
+
+    std::shared_ptr<const Frame_Layout> layout_;
     std::shared_ptr<std::vector<ast::Statement::Ptr>> body_prefix_;
     std::shared_ptr<ast::Expression> return_expr_;
-    Symbol_Table captures_;
-    std::optional<std::string> vararg_parameter_;
-    std::optional<std::string> self_name_;
-    std::size_t define_count_;
+    std::vector<Value_Ptr> captures_;
+    std::shared_ptr<const Compiled_Body> compiled_body_;
 };
 } // namespace frst
 
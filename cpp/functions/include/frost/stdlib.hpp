@@ -50,6 +50,7 @@ class Stdlib_Registry
     X(fs)                                                                      \
     X(io)                                                                      \
     X(json)                                                                    \
+    X(lazy)                                                                    \
     X(math)                                                                    \
     X(os)                                                                      \
     X(random)                                                                  \
@@ -3,8 +3,12 @@
 
 #include <frost/builtins-common.hpp>
 
+#include <algorithm>
+#include <fstream>
+#include <istream>
 #include <memory>
 #include <mutex>
+#include <utility>
 
 namespace frst::streams_detail
 {
@@ -84,6 +88,60 @@ auto read_rest(const std::shared_ptr<Locked_Stream<Stream>>& ls)
     });
 }
 
+// Standard input, read straight from its file descriptor. std::cin is kept
+// in step with C stdio, so it hands out a character at a time and never knows
+// how much more is waiting.
+std::istream& standard_input();
+
+// Blocks for at least one character, then takes whatever else is already
+// buffered, so that a pipe yields its data as it arrives. A file is never
+// waited on for long, so is read on up to max.
+template <std::derived_from<std::istream> Stream>
+auto read_some(const std::shared_ptr<Locked_Stream<Stream>>& ls)
+{
+    return system_closure([ls](builtin_args_t args) {
+        REQUIRE_ARGS("<system closure:read_some>", PARAM("max", TYPES(Int)));
+        auto max = GET(0, Int);
+        if (max <= 0)
+            throw Frost_Recoverable_Error{
+                "<system closure:read_some> requires max > 0"};
+
+        std::lock_guard lock{ls->mutex};
+        int got = ls->stream->get();
+        if (not std::char_traits<char>::not_eof(got))
+            return Value::create(String{});
+
+        auto avail = std::max<std::streamsize>(
+            ls->stream->rdbuf()->in_avail(), 0);
+        auto more = std::min<std::streamsize>(avail, max - 1);
+
+        String chunk(static_cast<std::size_t>(more) + 1, '\0');
+        chunk[0] = static_cast<char>(got);
+        more = ls->stream->readsome(chunk.data() + 1, more);
+        chunk.resize(static_cast<std::size_t>(more) + 1);
+
+        if constexpr (std::derived_from<Stream, std::ifstream>)
+        {
+            // A piece at a time, so a huge max costs nothing up front
+            constexpr std::streamsize piece_size = 64 * 1024;
+            while (std::cmp_less(chunk.size(), max))
+            {
+                const auto size = chunk.size();
+                const auto piece = std::min<std::streamsize>(
+                    piece_size, max - static_cast<Int>(size));
+                chunk.resize(size + static_cast<std::size_t>(piece));
+                const auto read =
+                    ls->stream->rdbuf()->sgetn(chunk.data() + size, piece);
+                chunk.resize(size + static_cast<std::size_t>(read));
+                if (read < piece)
+                    break;
+            }
+        }
+
+        return Value::create(std::move(chunk));
+    });
+}
+
 template <std::derived_from<std::istream> Stream>
 auto tell(const std::shared_ptr<Locked_Stream<Stream>>& ls)
 {
@@ -0,0 +1,84 @@
+#ifndef FROST_THREAD_POOL_HPP
+#define FROST_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace frst
+{
+
+//! @brief A fixed set of worker threads, running queued jobs in order
+//!
+//! Destroying the pool waits for every job already queued to finish. That
+//! may happen from inside one of its own jobs, when the job held the last
+//! reference to the pool.
+class Thread_Pool
+{
+  public:
+    using Job = std::move_only_function<void()>;
+    using Chunk_Body = std::function<void(std::size_t, std::size_t)>;
+
+    explicit Thread_Pool(std::size_t thread_count);
+    ~Thread_Pool();
+
+    Thread_Pool(const Thread_Pool&) = delete;
+    Thread_Pool& operator=(const Thread_Pool&) = delete;
+
+    std::size_t size() const
+    {
+        return workers_.size();
+    }
+
+    // Queue a job, which must not throw
+    void post(Job job);
+
+    // Queue fn, and get a future for its result or exception
+    template <std::invocable Fn>
+    std::future<std::invoke_result_t<Fn>> submit(Fn fn)
+    {
+        std::packaged_task<std::invoke_result_t<Fn>()> task{std::move(fn)};
+        auto future = task.get_future();
+        post(std::move(task));
+        return future;
+    }
+
+    //! @brief Run body(begin, end) over [0, count), one chunk at a time
+    //!
+    //! The calling thread works through chunks alongside the pool, so this
+    //! may be called from inside a job without starving the pool. If any
+    //! chunks throw, chunks after the first failing one are skipped, and its
+    //! exception is rethrown here once the rest are done.
+    void for_chunks(std::size_t count, std::size_t chunk_size,
+                    Chunk_Body body);
+
+    // The pool shared by the builtins, with a worker per hardware thread
+    static Thread_Pool& shared();
+
+  private:
+    // Shared with the workers, so that one left running by a pool destroyed
+    // from its own job still has a queue to look at on the way out
+    struct Queue
+    {
+        std::mutex mutex;
+        std::condition_variable_any ready;
+        std::queue<Job> jobs;
+    };
+
+    static void work(const std::shared_ptr<Queue>& queue,
+                     std::stop_token stop);
+
+    std::shared_ptr<Queue> queue_ = std::make_shared<Queue>();
+    std::vector<std::jthread> workers_;
+};
+
+} // namespace frst
+
+#endif
@@ -16,7 +16,8 @@ namespace frst
     X(mutable_cell)                                                            \
     X(ranges)                                                                  \
     X(and_then)                                                                \
-    X(streams)
+    X(streams)                                                                 \
+    X(parallel)
 
 #define X(F) void inject_##F(Symbol_Table&);
 
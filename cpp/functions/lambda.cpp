@@ -1,5 +1,6 @@
 #include <frost/ast/lambda.hpp>
 #include <frost/ast/literal.hpp>
+#include <frost/ast/resolver.hpp>
 #include <frost/ast/utils/block-utils.hpp>
 #include <frost/closure.hpp>
 
@@ -20,34 +21,31 @@ Lambda::Lambda(Source_Range source_range, std::vector<std::string> params,
                std::optional<std::string> vararg_param,
                std::optional<std::string> self_name, bool abbreviated)
     : Expression(source_range)
-    , params_{std::move(params)}
     , body_prefix_{std::make_shared<std::vector<Statement::Ptr>>(
           std::move(body_prefix))}
-    , vararg_param_{std::move(vararg_param)}
-    , self_name_{std::move(self_name)}
 {
     if (not abbreviated)
     {
-        for (const auto& p : params_)
+        for (const auto& p : params)
             forbid_dollar_identifier(p);
-        if (vararg_param_)
-            forbid_dollar_identifier(vararg_param_.value());
+        if (vararg_param)
+            forbid_dollar_identifier(vararg_param.value());
     }
 
-    std::flat_set<std::string> param_set{std::from_range, params_};
+    std::flat_set<std::string> param_set{std::from_range, params};
 
-    if (vararg_param_)
-        param_set.insert(vararg_param_.value());
+    if (vararg_param)
+        param_set.insert(vararg_param.value());
 
-    if (self_name_ && param_set.contains(self_name_.value()))
+    if (self_name && param_set.contains(self_name.value()))
     {
         throw Frost_Unrecoverable_Error{fmt::format(
             "Closure parameter cannot shadow name bound to self ({})",
-            self_name_.value())};
+            self_name.value())};
     }
 
     if (const auto expected_param_set_size =
-            params_.size() + (vararg_param_.has_value() ? 1 : 0);
+            params.size() + (vararg_param.has_value() ? 1 : 0);
         expected_param_set_size != param_set.size())
     {
         throw Frost_Unrecoverable_Error{"Closure has duplicate parameters"};
@@ -73,20 +71,22 @@ Lambda::Lambda(Source_Range source_range, std::vector<std::string> params,
         throw Frost_Unrecoverable_Error{"A lambda must end in an expression"};
     }
     return_expr_ = std::move(return_expr);
+    return_expr_->mark_tail_position();
 
     std::flat_set<std::string> names_defined_so_far{std::from_range, param_set};
+    std::flat_set<std::string> names_to_capture;
 
     for (const AST_Node::Symbol_Action& name :
          utils::body_symbol_sequence(*body_prefix_, return_expr_))
     {
         name.visit(Overload{
             [&](const AST_Node::Definition& defn) {
-                if (defn.name == self_name_)
+                if (defn.name == self_name)
                 {
                     throw Frost_Unrecoverable_Error{
                         fmt::format("Closure local definition cannot shadow "
                                     "name bound to self ({})",
-                                    self_name_.value())};
+                                    self_name.value())};
                 }
                 if (param_set.contains(defn.name))
                 {
@@ -100,34 +100,52 @@ Lambda::Lambda(Source_Range source_range, std::vector<std::string> params,
             },
             [&](const AST_Node::Usage& used) {
                 if (used.name
-                    != self_name_
+                    != self_name
                     && !names_defined_so_far.contains(used.name))
                 {
-                    names_to_capture_.insert(used.name);
+                    names_to_capture.insert(used.name);
                 }
             },
         });
     }
 
-    closure_define_count_ = names_defined_so_far.size();
+    layout_ = resolve_frame_layout(
+        std::move(params), std::move(vararg_param), std::move(self_name),
+        std::move(names_to_capture).extract(), *body_prefix_, *return_expr_);
+}
+
+void Lambda::resolve(Resolver& resolver) const
+{
+    // The body has already been resolved against this lambda's own frame,
+    // the enclosing frame only supplies the values to capture
+    auto& slots = capture_slots_.emplace();
+    slots.reserve(layout_->captures.size());
+    for (const std::string& name : layout_->captures)
+        slots.push_back(resolver.use(name));
 }
 
 Value_Ptr Lambda::do_evaluate(Evaluation_Context ctx) const
 {
-    Symbol_Table captures;
-    captures.reserve(names_to_capture_.size());
-    for (const std::string& name : names_to_capture_)
+    std::vector<Value_Ptr> captures;
+    captures.reserve(layout_->captures.size());
+    for (const auto& [i, name] : std::views::enumerate(layout_->captures))
     {
-        if (const auto val = ctx.symbols.soft_lookup(name); val)
-            captures.define(name, std::move(val).value());
-        else
+        Value_Ptr val;
+        if (capture_slots_ && capture_slots_->at(i))
+            val = ctx.frame->get(capture_slots_->at(i).value());
+        else if (auto found = ctx.symbols.soft_lookup(name))
+            val = std::move(found).value();
+
+        if (not val)
             throw Frost_Unrecoverable_Error{fmt::format(
                 "No definition found for captured symbol: {}", name)};
+
+        captures.push_back(std::move(val));
     }
 
-    return Value::create(Function{Closure::create(
-        params_, body_prefix_, return_expr_, std::move(captures),
-        closure_define_count_, vararg_param_, self_name_)});
+    return Value::create(
+        Function{Closure::create(layout_, body_prefix_, return_expr_,
+                                 std::move(captures), compiled_body_)});
 }
 
 std::generator<AST_Node::Symbol_Action> Lambda::symbol_sequence() const
@@ -137,7 +155,7 @@ std::generator<AST_Node::Symbol_Action> Lambda::symbol_sequence() const
         return action.name;
     };
 
-    std::flat_set<std::string> defns{std::from_range, params_};
+    std::flat_set<std::string> defns{std::from_range, layout_->parameters};
 
     // Mirror the abbreviated lambda alias/suppression from the constructor:
     // `$` is a runtime alias for `$1`
@@ -146,11 +164,11 @@ std::generator<AST_Node::Symbol_Action> Lambda::symbol_sequence() const
         defns.insert("$");
     }
 
-    if (self_name_)
-        defns.insert(self_name_.value());
+    if (layout_->self_name)
+        defns.insert(layout_->self_name.value());
 
-    if (vararg_param_)
-        defns.insert(vararg_param_.value());
+    if (layout_->vararg_parameter)
+        defns.insert(layout_->vararg_parameter.value());
 
     for (const AST_Node::Symbol_Action& action :
          utils::body_symbol_sequence(*body_prefix_, return_expr_))
@@ -165,14 +183,16 @@ std::generator<AST_Node::Symbol_Action> Lambda::symbol_sequence() const
 
 std::string Lambda::do_node_label() const
 {
-    const bool has_params = !params_.empty() || vararg_param_;
+    const auto& params = layout_->parameters;
+    const auto& vararg_param = layout_->vararg_parameter;
+    const auto& self_name = layout_->self_name;
+    const bool has_params = !params.empty() || vararg_param;
     return fmt::format(
         "Lambda({}{}{}{}{}{})",
-        self_name_ ? std::string_view{*self_name_} : std::string_view{},
-        self_name_ ? (has_params ? ": " : ":") : "", fmt::join(params_, ", "),
-        !params_.empty() && vararg_param_ ? ", " : "",
-        vararg_param_ ? "..." : "",
-        vararg_param_ ? std::string_view{*vararg_param_} : std::string_view{});
+        self_name ? std::string_view{*self_name} : std::string_view{},
+        self_name ? (has_params ? ": " : ":") : "", fmt::join(params, ", "),
+        !params.empty() && vararg_param ? ", " : "", vararg_param ? "..." : "",
+        vararg_param ? std::string_view{*vararg_param} : std::string_view{});
 }
 
 std::generator<AST_Node::Child_Info> Lambda::children() const
@@ -1,11 +1,12 @@
 #include <frost/builtins-common.hpp>
 
+#include <frost/streams.hpp>
 #include <frost/value.hpp>
 
 #include <expected>
 #include <flat_map>
 #include <flat_set>
-#include <iostream>
+#include <istream>
 
 namespace frst
 {
@@ -649,7 +650,7 @@ BUILTIN(prompt)
     std::fflush(stderr);
 
     std::string line;
-    if (not std::getline(std::cin, line))
+    if (not std::getline(streams_detail::standard_input(), line))
         return Value::null();
     return Value::create(String{std::move(line)});
 }
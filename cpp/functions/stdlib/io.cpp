@@ -12,8 +12,8 @@ namespace frst
 
 using namespace streams_detail;
 
-STRINGS(close, is_open, read_line, read_one, read_rest, tell, seek, eof, write,
-        writeln, get, flush);
+STRINGS(close, is_open, read_line, read_one, read_rest, read_some, tell, seek,
+        eof, write, writeln, get, flush);
 
 namespace
 {
@@ -43,6 +43,7 @@ BUILTIN(open_read)
                                              {strings.read_line, read_line(ls)},
                                              {strings.read_one, read_one(ls)},
                                              {strings.read_rest, read_rest(ls)},
+                                             {strings.read_some, read_some(ls)},
                                              {strings.close, close(ls)},
                                              {strings.is_open, is_open(ls)},
                                              {strings.eof, eof(ls)},
@@ -108,6 +109,7 @@ BUILTIN(stringreader)
                                              {strings.read_line, read_line(ls)},
                                              {strings.read_one, read_one(ls)},
                                              {strings.read_rest, read_rest(ls)},
+                                             {strings.read_some, read_some(ls)},
                                              {strings.eof, eof(ls)},
                                              {strings.tell, tell(ls)},
                                              {strings.seek, seek(ls)},
@@ -1,210 +1,559 @@
 #include <frost/builtin.hpp>
 #include <frost/builtins-common.hpp>
+#include <frost/map-builder.hpp>
 #include <frost/value.hpp>
 
 #include <boost/json.hpp>
+#include <boost/json/basic_parser_impl.hpp>
+
+#include <array>
+#include <charconv>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <optional>
+#include <ranges>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace frst
 {
 
 namespace json
 {
-struct Decode_Json_Impl
+//! @brief A boost::json parser handler that builds Frost values directly
+//!
+//! Skipping the boost::json::value DOM means each value is allocated once.
+//! Finished values wait on a stack until the array or object around them
+//! ends. Object keys are interned, so records that share their keys also
+//! share the key Values.
+class Value_Builder
 {
+    using error_code = boost::system::error_code;
+
+  public:
+    constexpr static std::size_t max_object_size =
+        std::numeric_limits<std::size_t>::max();
+    constexpr static std::size_t max_array_size =
+        std::numeric_limits<std::size_t>::max();
+    constexpr static std::size_t max_key_size =
+        std::numeric_limits<std::size_t>::max();
+    constexpr static std::size_t max_string_size =
+        std::numeric_limits<std::size_t>::max();
+
+    // Past this many distinct keys, new keys are no longer interned, so
+    // that a stream of unrelated keys cannot grow the table without bound
+    constexpr static std::size_t max_interned_keys = 4096;
+
+    explicit Value_Builder(std::string_view fn_name)
+        : fn_name_{fn_name}
+    {
+    }
 
-    Value_Ptr operator()(this const auto, const std::nullptr_t&)
+    // The value of the document just parsed
+    Value_Ptr release()
     {
-        return Value::null();
+        auto result = std::move(values_.back());
+        values_.clear();
+        return result;
     }
 
-    Value_Ptr operator()(this const auto, const bool& b)
+    bool on_document_begin(error_code&)
     {
-        return Value::create(auto{b});
+        return true;
     }
 
-    Value_Ptr operator()(this const auto, const boost::json::string& str)
+    bool on_document_end(error_code&)
     {
-        return Value::create(String{str});
+        return true;
     }
 
-    Value_Ptr operator()(this const auto, const std::int64_t& i)
+    bool on_array_begin(error_code&)
     {
-        return Value::create(auto{i});
+        return true;
     }
 
-    Value_Ptr operator()(this const auto, const double& d)
+    bool on_array_end(std::size_t size, error_code&)
     {
-        return Value::create(auto{d});
+        auto first = values_.end() - static_cast<std::ptrdiff_t>(size);
+        Array result(std::make_move_iterator(first),
+                     std::make_move_iterator(values_.end()));
+        values_.erase(first, values_.end());
+        values_.push_back(Value::create(std::move(result)));
+        return true;
     }
 
-    Value_Ptr operator()(this const auto, const std::uint64_t& u)
+    bool on_object_begin(error_code&)
     {
-        throw Frost_Recoverable_Error{
-            fmt::format("json.decode: Value {} is out of range", u)};
+        return true;
+    }
+
+    bool on_object_end(std::size_t size, error_code&)
+    {
+        auto first_key = keys_.end() - static_cast<std::ptrdiff_t>(size);
+        auto first_value = values_.end() - static_cast<std::ptrdiff_t>(size);
+
+        // The last of any repeated key wins, as with boost::json::parse, but
+        // Map_Builder keeps the first one added, so entries go in backwards
+        Map_Builder result;
+        result.reserve(size);
+        for (std::size_t i = size; i-- > 0;)
+            result.add(std::move(first_key[i]), std::move(first_value[i]));
+
+        keys_.erase(first_key, keys_.end());
+        values_.erase(first_value, values_.end());
+        values_.push_back(
+            Value::create(Value::trusted, std::move(result).build()));
+        return true;
+    }
+
+    bool on_string_part(std::string_view part, std::size_t, error_code&)
+    {
+        buffer_.append(part);
+        return true;
+    }
+
+    bool on_string(std::string_view part, std::size_t, error_code&)
+    {
+        values_.push_back(Value::create(take_buffered(part)));
+        return true;
     }
 
-    Value_Ptr operator()(this const auto self, const boost::json::array& arr)
+    bool on_key_part(std::string_view part, std::size_t, error_code&)
     {
-        return Value::create(arr
-                             | std::views::transform([&](const auto& elem) {
-                                   return boost::json::visit(self, elem);
-                               })
-                             | std::ranges::to<Array>());
+        buffer_.append(part);
+        return true;
     }
 
-    Value_Ptr operator()(this const auto self, const boost::json::object& obj)
+    bool on_key(std::string_view part, std::size_t, error_code&)
     {
-        Map result;
-        for (const auto& [k, v] : obj)
+        if (buffer_.empty())
         {
-            result.try_emplace(Value::create(String{k}),
-                               boost::json::visit(self, v));
+            keys_.push_back(intern(part));
+            return true;
         }
-        return Value::create(Value::trusted, std::move(result));
+        buffer_.append(part);
+        keys_.push_back(intern(buffer_));
+        buffer_.clear();
+        return true;
+    }
+
+    bool on_number_part(std::string_view, error_code&)
+    {
+        return true;
+    }
+
+    bool on_int64(std::int64_t i, std::string_view, error_code&)
+    {
+        values_.push_back(Value::create(Int{i}));
+        return true;
+    }
+
+    bool on_uint64(std::uint64_t u, std::string_view, error_code&)
+    {
+        throw Frost_Recoverable_Error{
+            fmt::format("{}: Value {} is out of range", fn_name_, u)};
+    }
+
+    bool on_double(double d, std::string_view, error_code&)
+    {
+        values_.push_back(Value::create(Float{d}));
+        return true;
+    }
+
+    bool on_bool(bool b, error_code&)
+    {
+        values_.push_back(Value::create(Bool{b}));
+        return true;
+    }
+
+    bool on_null(error_code&)
+    {
+        values_.push_back(Value::null());
+        return true;
     }
 
-} constexpr static decode_json_impl;
+    bool on_comment_part(std::string_view, error_code&)
+    {
+        return true;
+    }
+
+    bool on_comment(std::string_view, error_code&)
+    {
+        return true;
+    }
+
+  private:
+    String take_buffered(std::string_view last_part)
+    {
+        if (buffer_.empty())
+            return String{last_part};
+        buffer_.append(last_part);
+        return std::exchange(buffer_, String{});
+    }
+
+    Value_Ptr intern(std::string_view key)
+    {
+        if (auto it = interned_.find(key); it != interned_.end())
+            return it->second;
+
+        auto result = Value::create(String{key});
+        if (interned_.size() < max_interned_keys)
+            interned_.emplace(String{key}, result);
+        return result;
+    }
+
+    std::string_view fn_name_;
+    std::vector<Value_Ptr> values_;
+    std::vector<Value_Ptr> keys_;
+    String buffer_;
+    std::map<String, Value_Ptr, std::less<>> interned_;
+};
+
+using Value_Parser = boost::json::basic_parser<Value_Builder>;
+
+const boost::json::parse_options json_parse_options{
+    .max_depth = 1024,
+    .allow_comments = true,
+    .allow_trailing_commas = true,
+};
 
 BUILTIN(decode)
 {
     REQUIRE_ARGS("json.decode", TYPES(String));
+    const auto& text = GET(0, String);
+
+    Value_Parser parser{json_parse_options, "json.decode"};
     boost::system::error_code ec;
-    boost::json::parse_options opts{
-        .max_depth = 1024,
-        .allow_comments = true,
-        .allow_trailing_commas = true,
-    };
-    auto json = boost::json::parse(GET(0, String), ec, {}, opts);
+    auto used = parser.write_some(false, text.data(), text.size(), ec);
+    if (not ec && used < text.size())
+        ec = boost::json::error::extra_data;
     if (ec)
         throw Frost_Recoverable_Error{
             fmt::format("json.decode: {}", ec.message())};
 
-    return boost::json::visit(decode_json_impl, json);
+    return parser.handler().release();
+}
+
+// The named method of an io reader or writer
+Function stream_method(std::string_view fn_name, std::string_view param,
+                       const Map& stream, const String& method)
+{
+    auto it = stream.find(Value::create(String{method}));
+    if (it == stream.end() || not it->second->is<Function>())
+        throw Frost_Recoverable_Error{fmt::format(
+            "{}: {} must have a {} method", fn_name, param, method)};
+    return it->second->raw_get<Function>();
 }
 
-struct Encode_Json_Impl
+// How much is asked of the reader at a time
+constexpr Int decode_stream_chunk_size = 64 * 1024;
+
+BUILTIN(decode_stream)
 {
+    REQUIRE_ARGS("json.decode_stream", PARAM("reader", TYPES(Map)),
+                 PARAM("callback", TYPES(Function)));
+
+    auto read_some = stream_method("json.decode_stream", "reader",
+                                   GET(0, Map), "read_some");
+    const auto& callback = GET(1, Function);
+
+    auto check = [](const boost::system::error_code& ec) {
+        if (ec)
+            throw Frost_Recoverable_Error{
+                fmt::format("json.decode_stream: {}", ec.message())};
+    };
+
+    // Only one top-level value is held at a time: the parser is emptied as
+    // soon as a value is complete, before the next one is started. Interned
+    // keys are kept from one value to the next.
+    Value_Parser parser{json_parse_options, "json.decode_stream"};
+    bool in_value = false;
+    auto emit = [&] {
+        auto value = parser.handler().release();
+        parser.reset();
+        in_value = false;
+        callback->call({std::move(value)});
+    };
 
-    boost::json::value operator()(this const auto, const Null&)
+    for (;;)
     {
-        return {};
+        auto got =
+            read_some->call({Value::create(Int{decode_stream_chunk_size})});
+        if (not got->is<String>())
+            throw Frost_Recoverable_Error{fmt::format(
+                "json.decode_stream: read_some must return a String, got {}",
+                got->type_name())};
+
+        std::string_view chunk = got->raw_get<String>();
+        if (chunk.empty())
+            break;
+
+        while (not chunk.empty())
+        {
+            // Whitespace between values would otherwise start a new value
+            // that never ends
+            if (not in_value)
+            {
+                auto start = chunk.find_first_not_of(" \t\r\n");
+                if (start == std::string_view::npos)
+                    break;
+                chunk.remove_prefix(start);
+                in_value = true;
+            }
+
+            boost::system::error_code ec;
+            auto used =
+                parser.write_some(true, chunk.data(), chunk.size(), ec);
+            check(ec);
+            chunk.remove_prefix(used);
+
+            if (parser.done())
+                emit();
+        }
     }
 
-    boost::json::value operator()(this const auto, const String& str)
+    if (in_value)
     {
-        return {str};
+        boost::system::error_code ec;
+        parser.write_some(false, nullptr, 0, ec);
+        check(ec);
+        emit();
     }
 
-    boost::json::value operator()(this const auto,
-                                  const Frost_Primitive auto& value)
+    return Value::null();
+}
+
+// Characters that cannot appear in a JSON string as themselves
+constexpr auto needs_escape = [] {
+    std::array<bool, 256> table{};
+    for (std::size_t c = 0; c < 0x20; ++c)
+        table[c] = true;
+    table['"'] = true;
+    table['\\'] = true;
+    return table;
+}();
+
+constexpr std::string_view hex_digits = "0123456789abcdef";
+
+//! @brief Writes Frost values as JSON text, without building a
+//! boost::json::value first
+//!
+//! Output accumulates in a buffer. When given a sink, the encoder hands the
+//! buffer over whenever it grows past flush_size, so a value far larger than
+//! memory can be written out as it is walked.
+class Json_Encoder
+{
+  public:
+    constexpr static std::size_t flush_size = 64 * 1024;
+
+    using Sink = std::function<void(std::string_view)>;
+
+    // Compact output unless indent is given, in which case every element
+    // goes on its own line, indented by that many spaces per level
+    Json_Encoder(std::string_view fn_name, std::optional<std::size_t> indent,
+                 Sink sink = {})
+        : fn_name_{fn_name}
+        , indent_{indent}
+        , sink_{std::move(sink)}
     {
-        return value;
     }
 
-    boost::json::value operator()(this const auto self, const Array& arr)
+    void encode(const Value_Ptr& value)
     {
-        return arr
-               | std::views::transform([&](const Value_Ptr& elem) {
-                     return elem->visit(self);
-                 })
-               | std::ranges::to<boost::json::array>();
+        value->visit(*this);
     }
 
-    boost::json::value operator()(this const auto self, const Map& map)
+    std::string take() &&
     {
-        boost::json::object result;
+        return std::move(out_);
+    }
 
-        for (const auto& [k, v] : map)
+    void flush()
+    {
+        if (sink_ && not out_.empty())
         {
-            if (not k->is<String>())
-            {
-                throw Frost_Recoverable_Error{fmt::format(
-                    "json.encode: Map with non-String key: \"{}\" cannot be "
-                    "serialized to JSON",
-                    k->to_internal_string())};
-            }
-
-            result.emplace(k->raw_get<String>(), v->visit(self));
+            sink_(out_);
+            out_.clear();
         }
-
-        return result;
     }
 
-    boost::json::value operator()(this const auto, const Function&)
+    void operator()(const Null&)
     {
-        throw Frost_Recoverable_Error{
-            "json.encode: Cannot serialize Function to JSON"};
+        out_ += "null";
     }
 
-} constexpr static encode_json_impl;
+    void operator()(const Bool& b)
+    {
+        out_ += b ? "true" : "false";
+    }
 
-BUILTIN(encode)
-{
-    REQUIRE_ARGS("json.encode", ANY);
-    return Value::create(serialize(args.at(0)->visit(encode_json_impl)));
-}
+    void operator()(const Int& i)
+    {
+        std::array<char, 24> buf;
+        auto end = std::to_chars(buf.data(), buf.data() + buf.size(), i).ptr;
+        out_.append(buf.data(), end);
+    }
 
-void pretty_format(std::string& out, const boost::json::value& val,
-                   std::size_t indent, std::size_t depth)
-{
-    if (val.is_null()
-        || val.is_bool()
-        || val.is_int64()
-        || val.is_uint64()
-        || val.is_double()
-        || val.is_string())
+    // Formatted by boost::json, so Floats read the same as they always have
+    void operator()(const Float& f)
     {
-        out += serialize(val);
-        return;
+        boost::json::value json = f;
+        float_serializer_.reset(&json);
+        std::array<char, 32> buf;
+        while (not float_serializer_.done())
+        {
+            auto part = float_serializer_.read(buf.data(), buf.size());
+            out_.append(part.data(), part.size());
+        }
     }
 
-    std::string inner_pad(indent * (depth + 1), ' ');
-    std::string outer_pad(indent * depth, ' ');
+    void operator()(const String& str)
+    {
+        write_string(str);
+    }
 
-    if (val.is_array())
+    void operator()(const Array& arr)
     {
-        const auto& arr = val.get_array();
         if (arr.empty())
         {
-            out += "[]";
+            out_ += "[]";
             return;
         }
 
-        out += "[\n";
-        for (std::size_t i = 0; i < arr.size(); ++i)
+        out_ += '[';
+        ++depth_;
+        for (const auto& [i, elem] : std::views::enumerate(arr))
         {
-            out += inner_pad;
-            pretty_format(out, arr[i], indent, depth + 1);
-            if (i + 1 < arr.size())
-                out += ',';
-            out += '\n';
+            if (i > 0)
+                out_ += ',';
+            newline();
+            elem->visit(*this);
+            maybe_flush();
         }
-        out += outer_pad;
-        out += ']';
-        return;
+        --depth_;
+        newline();
+        out_ += ']';
     }
 
-    const auto& obj = val.get_object();
-    if (obj.empty())
+    void operator()(const Map& map)
     {
-        out += "{}";
-        return;
+        if (map.empty())
+        {
+            out_ += "{}";
+            return;
+        }
+
+        out_ += '{';
+        ++depth_;
+        for (const auto& [i, entry] : std::views::enumerate(map))
+        {
+            const auto& [k, v] = entry;
+            if (not k->is<String>())
+            {
+                throw Frost_Recoverable_Error{fmt::format(
+                    "{}: Map with non-String key: \"{}\" cannot be "
+                    "serialized to JSON",
+                    fn_name_, k->to_internal_string())};
+            }
+
+            if (i > 0)
+                out_ += ',';
+            newline();
+            write_string(k->raw_get<String>());
+            out_ += indent_ ? ": " : ":";
+            v->visit(*this);
+            maybe_flush();
+        }
+        --depth_;
+        newline();
+        out_ += '}';
     }
 
-    out += "{\n";
-    std::size_t i = 0;
-    for (const auto& [k, v] : obj)
+    void operator()(const Function&)
     {
-        out += inner_pad;
-        out += serialize(boost::json::value{k});
-        out += ": ";
-        pretty_format(out, v, indent, depth + 1);
-        if (++i < obj.size())
-            out += ',';
-        out += '\n';
+        throw Frost_Recoverable_Error{fmt::format(
+            "{}: Cannot serialize Function to JSON", fn_name_)};
     }
-    out += outer_pad;
-    out += '}';
+
+  private:
+    void newline()
+    {
+        if (not indent_)
+            return;
+        out_ += '\n';
+        out_.append(*indent_ * depth_, ' ');
+    }
+
+    void maybe_flush()
+    {
+        if (out_.size() >= flush_size)
+            flush();
+    }
+
+    // Unescaped runs are copied whole, so the usual string costs one append
+    void write_string(std::string_view str)
+    {
+        out_ += '"';
+        auto run = str.begin();
+        for (auto it = str.begin(); it != str.end(); ++it)
+        {
+            auto c = static_cast<unsigned char>(*it);
+            if (not needs_escape[c])
+                continue;
+
+            out_.append(run, it);
+            run = std::next(it);
+            switch (c)
+            {
+            case '"':
+                out_ += "\\\"";
+                break;
+            case '\\':
+                out_ += "\\\\";
+                break;
+            case '\b':
+                out_ += "\\b";
+                break;
+            case '\f':
+                out_ += "\\f";
+                break;
+            case '\n':
+                out_ += "\\n";
+                break;
+            case '\r':
+                out_ += "\\r";
+                break;
+            case '\t':
+                out_ += "\\t";
+                break;
+            default:
+                out_ += "\\u00";
+                out_ += hex_digits[c >> 4];
+                out_ += hex_digits[c & 0xf];
+            }
+        }
+        out_.append(run, str.end());
+        out_ += '"';
+    }
+
+    std::string_view fn_name_;
+    std::optional<std::size_t> indent_;
+    Sink sink_;
+    std::size_t depth_ = 0;
+    std::string out_;
+    boost::json::serializer float_serializer_;
+};
+
+BUILTIN(encode)
+{
+    REQUIRE_ARGS("json.encode", ANY);
+
+    Json_Encoder encoder{"json.encode", std::nullopt};
+    encoder.encode(args.at(0));
+    return Value::create(std::move(encoder).take());
 }
 
 BUILTIN(encode_pretty)
@@ -216,15 +565,31 @@ BUILTIN(encode_pretty)
         throw Frost_Recoverable_Error{
             "json.encode_pretty: requires a non-negative indent"};
 
-    auto json = args.at(0)->visit(encode_json_impl);
+    Json_Encoder encoder{"json.encode_pretty",
+                         static_cast<std::size_t>(indent)};
+    encoder.encode(args.at(0));
+    return Value::create(std::move(encoder).take());
+}
 
-    std::string result;
-    pretty_format(result, json, static_cast<std::size_t>(indent), 0);
-    return Value::create(std::move(result));
+BUILTIN(encode_to)
+{
+    REQUIRE_ARGS("json.encode_to", PARAM("writer", TYPES(Map)), ANY);
+
+    auto write = stream_method("json.encode_to", "writer", GET(0, Map),
+                               "write");
+
+    Json_Encoder encoder{"json.encode_to", std::nullopt,
+                         [&](std::string_view chunk) {
+                             (void)write->call({Value::create(String{chunk})});
+                         }};
+    encoder.encode(args.at(1));
+    encoder.flush();
+    return Value::null();
 }
 
 } // namespace json
 
-STDLIB_MODULE(json, ENTRY(decode), ENTRY(encode), ENTRY(encode_pretty))
+STDLIB_MODULE(json, ENTRY(decode), ENTRY(decode_stream), ENTRY(encode),
+              ENTRY(encode_pretty), ENTRY(encode_to))
 
 } // namespace frst
@@ -0,0 +1,476 @@
+#include <frost/builtin.hpp>
+#include <frost/builtins-common.hpp>
+#include <frost/data-builtin.hpp>
+#include <frost/value.hpp>
+
+#include <functional>
+#include <generator>
+#include <limits>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace frst
+{
+
+namespace lazy
+{
+namespace
+{
+
+// A lazy sequence is a foreign value carrying a way to start pulling its
+// elements. Each pull starts over, so a sequence can be consumed repeatedly.
+struct Sequence
+{
+    std::function<std::generator<Value_Ptr>()> elements;
+};
+
+Value_Ptr collect_sequence(const Sequence& seq)
+{
+    Array result;
+    for (auto&& elem : seq.elements())
+        result.push_back(std::move(elem));
+    return Value::create(std::move(result));
+}
+
+Value_Ptr make_sequence(Sequence seq)
+{
+    return Value::create(Function{std::make_shared<Data_Builtin<Sequence>>(
+        [seq](builtin_args_t args) {
+            REQUIRE_NULLARY("lazy.sequence");
+            return collect_sequence(seq);
+        },
+        "lazy.sequence", std::move(seq))});
+}
+
+// The coroutines below take everything by value, so that their frames own
+// what they pull from
+
+std::generator<Value_Ptr> array_elements(Value_Ptr arr)
+{
+    for (const auto& elem : arr->raw_get<Array>())
+        co_yield elem;
+}
+
+// Arrays are accepted anywhere a sequence is, as a sequence of their elements
+Sequence get_sequence(std::string_view name, const Value_Ptr& val)
+{
+    if (val->is<Array>())
+        return {[val] { return array_elements(val); }};
+
+    if (val->is<Function>())
+    {
+        if (auto seq = dynamic_cast<const Data_Builtin<Sequence>*>(
+                val->raw_get<Function>().get()))
+            return seq->data();
+    }
+
+    throw Frost_Recoverable_Error{
+        fmt::format("Function {} requires a lazy sequence or Array, got {}",
+                    name, val->type_name())};
+}
+
+// Saturating, so that stepping past the end of Int stops rather than wraps
+std::generator<Value_Ptr> count_elements(Int start, Int stop, Int step)
+{
+    for (Int i = start; step > 0 ? i < stop : i > stop;
+         i = std::add_sat(i, step))
+    {
+        co_yield Value::create(i);
+    }
+}
+
+std::generator<Value_Ptr> iterate_elements(Value_Ptr init, Function fn)
+{
+    for (auto val = std::move(init);; val = fn->call({val}))
+        co_yield val;
+}
+
+std::generator<Value_Ptr> map_elements(Sequence source, Function fn)
+{
+    for (auto&& elem : source.elements())
+        co_yield fn->call({elem});
+}
+
+std::generator<Value_Ptr> select_elements(Sequence source, Function pred)
+{
+    for (auto&& elem : source.elements())
+    {
+        if (pred->call({elem})->truthy())
+            co_yield elem;
+    }
+}
+
+std::generator<Value_Ptr> take_elements(Sequence source, Int num)
+{
+    if (num == 0)
+        co_return;
+
+    for (auto&& elem : source.elements())
+    {
+        co_yield elem;
+        if (--num == 0)
+            co_return;
+    }
+}
+
+std::generator<Value_Ptr> drop_elements(Sequence source, Int num)
+{
+    for (auto&& elem : source.elements())
+    {
+        if (num > 0)
+            --num;
+        else
+            co_yield elem;
+    }
+}
+
+std::generator<Value_Ptr> stride_elements(Sequence source, Int num)
+{
+    Int skip = 0;
+    for (auto&& elem : source.elements())
+    {
+        if (skip == 0)
+            co_yield elem;
+        skip = (skip + 1) % num;
+    }
+}
+
+std::generator<Value_Ptr> take_while_elements(Sequence source, Function pred)
+{
+    for (auto&& elem : source.elements())
+    {
+        if (not pred->call({elem})->truthy())
+            co_return;
+        co_yield elem;
+    }
+}
+
+std::generator<Value_Ptr> drop_while_elements(Sequence source, Function pred)
+{
+    bool dropping = true;
+    for (auto&& elem : source.elements())
+    {
+        if (dropping && pred->call({elem})->truthy())
+            continue;
+        dropping = false;
+        co_yield elem;
+    }
+}
+
+// Stops at the end of the shortest source, without pulling from the rest
+std::generator<Value_Ptr> zip_elements(std::vector<Sequence> sources)
+{
+    using Elements = std::generator<Value_Ptr>;
+
+    std::vector<Elements> columns;
+    std::vector<std::ranges::iterator_t<Elements>> positions;
+    columns.reserve(sources.size());
+    positions.reserve(sources.size());
+
+    for (const auto& source : sources)
+    {
+        columns.push_back(source.elements());
+        positions.push_back(columns.back().begin());
+        if (positions.back() == columns.back().end())
+            co_return;
+    }
+
+    for (;;)
+    {
+        Array row;
+        row.reserve(positions.size());
+        for (auto& pos : positions)
+            row.push_back(*pos);
+        co_yield Value::create(std::move(row));
+
+        for (auto&& [column, pos] : std::views::zip(columns, positions))
+        {
+            if (++pos == column.end())
+                co_return;
+        }
+    }
+}
+
+// The last chunk has whatever is left over, if that is fewer than num
+std::generator<Value_Ptr> chunk_elements(Sequence source, Int num)
+{
+    Array chunk;
+    for (auto&& elem : source.elements())
+    {
+        chunk.push_back(std::move(elem));
+        if (std::cmp_equal(chunk.size(), num))
+            co_yield Value::create(std::exchange(chunk, Array{}));
+    }
+
+    if (not chunk.empty())
+        co_yield Value::create(std::move(chunk));
+}
+
+// Each element of the first source, followed by each row of the product of
+// the rest. The rest are pulled again, from the start, for every element
+// before them, so only the first may be endless.
+std::generator<Value_Ptr> xprod_rows(std::span<const Sequence> sources,
+                                     Array row)
+{
+    if (sources.empty())
+    {
+        co_yield Value::create(std::move(row));
+        co_return;
+    }
+
+    for (auto&& elem : sources.front().elements())
+    {
+        auto next = row;
+        next.push_back(std::move(elem));
+        co_yield std::ranges::elements_of(
+            xprod_rows(sources.subspan(1), std::move(next)));
+    }
+}
+
+std::generator<Value_Ptr> xprod_elements(std::vector<Sequence> sources)
+{
+    co_yield std::ranges::elements_of(xprod_rows(sources, Array{}));
+}
+
+std::vector<Sequence> get_sequences(std::string_view name,
+                                    std::span<const Value_Ptr> vals)
+{
+    return vals
+           | std::views::transform([&](const Value_Ptr& val) {
+                 return get_sequence(name, val);
+             })
+           | std::ranges::to<std::vector>();
+}
+
+void require_nonnegative(std::string_view name, Int num)
+{
+    if (num < 0)
+        throw Frost_Recoverable_Error{fmt::format(
+            "Function {} requires its numeric argument to be >=0", name)};
+}
+
+} // namespace
+
+BUILTIN(range)
+{
+    REQUIRE_ARITY("lazy.range", 1, 3);
+
+    if (args.size() == 1)
+    {
+        REQUIRE_ARGS("lazy.range", PARAM("upper bound", TYPES(Int)));
+        return make_sequence({[stop = GET(0, Int)] {
+            return count_elements(0, stop, 1);
+        }});
+    }
+    else if (args.size() == 2)
+    {
+        REQUIRE_ARGS("lazy.range", PARAM("lower bound", TYPES(Int)),
+                     PARAM("upper bound", TYPES(Int)));
+        return make_sequence({[start = GET(0, Int), stop = GET(1, Int)] {
+            return count_elements(start, stop, 1);
+        }});
+    }
+    else
+    {
+        REQUIRE_ARGS("lazy.range", PARAM("start", TYPES(Int)),
+                     PARAM("stop", TYPES(Int)), PARAM("step", TYPES(Int)));
+
+        auto step = GET(2, Int);
+        if (step == 0)
+            throw Frost_Recoverable_Error{
+                "Function lazy.range requires step != 0"};
+
+        return make_sequence(
+            {[start = GET(0, Int), stop = GET(1, Int), step] {
+                return count_elements(start, stop, step);
+            }});
+    }
+}
+
+BUILTIN(count)
+{
+    REQUIRE_ARGS("lazy.count", OPTIONAL(PARAM("start", TYPES(Int))));
+
+    const auto start = HAS(0) ? GET(0, Int) : Int{0};
+    return make_sequence({[start] {
+        return count_elements(start, std::numeric_limits<Int>::max(), 1);
+    }});
+}
+
+BUILTIN(iterate)
+{
+    REQUIRE_ARGS("lazy.iterate", PARAM("init", ANY), TYPES(Function));
+
+    return make_sequence({[init = args.at(0), fn = GET(1, Function)] {
+        return iterate_elements(init, fn);
+    }});
+}
+
+BUILTIN(map)
+{
+    REQUIRE_ARGS("lazy.map", PARAM("seq", ANY), TYPES(Function));
+
+    return make_sequence({[source = get_sequence("lazy.map", args.at(0)),
+                           fn = GET(1, Function)] {
+        return map_elements(source, fn);
+    }});
+}
+
+BUILTIN(select)
+{
+    REQUIRE_ARGS("lazy.select", PARAM("seq", ANY), TYPES(Function));
+
+    return make_sequence({[source = get_sequence("lazy.select", args.at(0)),
+                           pred = GET(1, Function)] {
+        return select_elements(source, pred);
+    }});
+}
+
+BUILTIN(take)
+{
+    REQUIRE_ARGS("lazy.take", PARAM("seq", ANY), TYPES(Int));
+
+    auto num = GET(1, Int);
+    require_nonnegative("lazy.take", num);
+
+    return make_sequence(
+        {[source = get_sequence("lazy.take", args.at(0)), num] {
+            return take_elements(source, num);
+        }});
+}
+
+BUILTIN(drop)
+{
+    REQUIRE_ARGS("lazy.drop", PARAM("seq", ANY), TYPES(Int));
+
+    auto num = GET(1, Int);
+    require_nonnegative("lazy.drop", num);
+
+    return make_sequence(
+        {[source = get_sequence("lazy.drop", args.at(0)), num] {
+            return drop_elements(source, num);
+        }});
+}
+
+BUILTIN(stride)
+{
+    REQUIRE_ARGS("lazy.stride", PARAM("seq", ANY), TYPES(Int));
+
+    auto num = GET(1, Int);
+    if (num <= 0)
+        throw Frost_Recoverable_Error{
+            "Function lazy.stride requires its numeric argument to be >0"};
+
+    return make_sequence(
+        {[source = get_sequence("lazy.stride", args.at(0)), num] {
+            return stride_elements(source, num);
+        }});
+}
+
+BUILTIN(take_while)
+{
+    REQUIRE_ARGS("lazy.take_while", PARAM("seq", ANY), TYPES(Function));
+
+    return make_sequence(
+        {[source = get_sequence("lazy.take_while", args.at(0)),
+          pred = GET(1, Function)] {
+            return take_while_elements(source, pred);
+        }});
+}
+
+BUILTIN(drop_while)
+{
+    REQUIRE_ARGS("lazy.drop_while", PARAM("seq", ANY), TYPES(Function));
+
+    return make_sequence(
+        {[source = get_sequence("lazy.drop_while", args.at(0)),
+          pred = GET(1, Function)] {
+            return drop_while_elements(source, pred);
+        }});
+}
+
+BUILTIN(zip)
+{
+    REQUIRE_ARGS("lazy.zip", VARIADIC_REST(2, "seq", ANY));
+
+    return make_sequence({[sources = get_sequences("lazy.zip", args)] {
+        return zip_elements(sources);
+    }});
+}
+
+BUILTIN(chunk)
+{
+    REQUIRE_ARGS("lazy.chunk", PARAM("seq", ANY), TYPES(Int));
+
+    auto num = GET(1, Int);
+    if (num <= 0)
+        throw Frost_Recoverable_Error{
+            "Function lazy.chunk requires its numeric argument to be >0"};
+
+    return make_sequence(
+        {[source = get_sequence("lazy.chunk", args.at(0)), num] {
+            return chunk_elements(source, num);
+        }});
+}
+
+BUILTIN(xprod)
+{
+    REQUIRE_ARGS("lazy.xprod", VARIADIC_REST(2, "seq", ANY));
+
+    return make_sequence({[sources = get_sequences("lazy.xprod", args)] {
+        return xprod_elements(sources);
+    }});
+}
+
+BUILTIN(collect)
+{
+    REQUIRE_ARGS("lazy.collect", PARAM("seq", ANY));
+
+    return collect_sequence(get_sequence("lazy.collect", args.at(0)));
+}
+
+BUILTIN(fold)
+{
+    REQUIRE_ARGS("lazy.fold", PARAM("seq", ANY), TYPES(Function),
+                 OPTIONAL(PARAM("init", ANY)));
+
+    const auto source = get_sequence("lazy.fold", args.at(0));
+    const auto& fn = GET(1, Function);
+
+    std::optional<Value_Ptr> acc;
+    if (HAS(2))
+        acc = args.at(2);
+
+    for (auto&& elem : source.elements())
+    {
+        if (acc)
+            acc = fn->call({*acc, elem});
+        else
+            acc = std::move(elem);
+    }
+
+    return acc.value_or(Value::null());
+}
+
+BUILTIN(is_sequence)
+{
+    REQUIRE_ARGS("lazy.is_sequence", ANY);
+
+    const auto& val = args.at(0);
+    return Value::create(
+        val->is<Function>()
+        && dynamic_cast<const Data_Builtin<Sequence>*>(
+               val->raw_get<Function>().get()));
+}
+
+} // namespace lazy
+
+STDLIB_MODULE(lazy, ENTRY(range), ENTRY(count), ENTRY(iterate), ENTRY(map),
+              ENTRY(select), ENTRY(take), ENTRY(drop), ENTRY(stride),
+              ENTRY(take_while), ENTRY(drop_while), ENTRY(zip), ENTRY(chunk),
+              ENTRY(xprod), ENTRY(collect), ENTRY(fold), ENTRY(is_sequence))
+
+} // namespace frst
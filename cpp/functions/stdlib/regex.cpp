@@ -6,7 +6,14 @@
 
 #include <boost/regex.hpp>
 
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <ranges>
+#include <string>
+#include <vector>
 
 using namespace std::literals;
 using namespace frst::literals;
@@ -20,81 +27,176 @@ namespace regex
 namespace
 {
 
-boost::regex regex(const String& re)
+std::optional<std::vector<std::string>> extract_group_names(
+    const std::string& regex)
 {
-    try
+    std::vector<std::string> group_names;
+    static const boost::regex re{R"(\(\?(<(?<aname>\w+)>|'(?<tname>\w+)'))",
+                                 boost::regex_constants::optimize
+                                     | boost::regex_constants::perl};
+    for (boost::regex_iterator<std::string::const_iterator>
+             it{regex.begin(), regex.end(), re},
+         end;
+         it != end; ++it)
     {
-        return boost::regex{re};
+        const auto& match = *it;
+        if (match["aname"].matched)
+            group_names.push_back(match["aname"].str());
+        if (match["tname"].matched)
+            group_names.push_back(match["tname"].str());
     }
-    catch (const boost::regex_error& e)
+
+    if (not group_names.empty())
+        return group_names;
+    else
+        return std::nullopt;
+}
+
+// A compiled pattern is only ever read once built, so one can be shared
+// between threads
+struct Compiled_Regex
+{
+    boost::regex re;
+    std::optional<std::vector<std::string>> group_names;
+};
+
+using Regex_Ptr = std::shared_ptr<const Compiled_Regex>;
+
+//! @brief The most recently used compiled patterns, keyed by pattern and flags
+//!
+//! Scripts tend to use the same few patterns over and over (often in a
+//! loop), so compiling each of them once saves most of the cost of a call.
+//! Patterns that fail to compile are not cached.
+class Regex_Cache
+{
+  public:
+    static constexpr std::size_t capacity = 256;
+
+    static Regex_Cache& shared()
     {
-        throw Frost_Recoverable_Error{fmt::format("Regex error: {}", e.what())};
+        static Regex_Cache cache;
+        return cache;
     }
-}
 
-} // namespace
+    Regex_Ptr get(const String& pattern, boost::regex::flag_type flags)
+    {
+        Key key{pattern, flags};
+        {
+            std::lock_guard lock{mutex_};
+            if (auto it = index_.find(key); it != index_.end())
+            {
+                entries_.splice(entries_.begin(), entries_, it->second);
+                return it->second->second;
+            }
+        }
 
-BUILTIN(matches)
-{
-    REQUIRE_ARGS("regex.matches", PARAM("string", TYPES(String)),
-                 PARAM("regex", TYPES(String)));
+        // Compiling can be slow, so other threads are not held up by it
+        auto compiled = compile(pattern, flags);
 
-    auto re = regex(GET(1, String));
+        std::lock_guard lock{mutex_};
+        if (auto it = index_.find(key); it != index_.end())
+            return it->second->second;
 
-    return Value::create(boost::regex_match(GET(0, String), re));
-}
+        entries_.emplace_front(key, compiled);
+        index_.emplace(std::move(key), entries_.begin());
+        if (entries_.size() > capacity)
+        {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+        return compiled;
+    }
 
-BUILTIN(contains)
-{
-    REQUIRE_ARGS("regex.contains", PARAM("string", TYPES(String)),
-                 PARAM("regex", TYPES(String)));
+  private:
+    struct Key
+    {
+        String pattern;
+        boost::regex::flag_type flags;
 
-    auto re = regex(GET(1, String));
+        auto operator<=>(const Key&) const = default;
+    };
 
-    return Value::create(boost::regex_search(GET(0, String), re));
-}
+    using Entries = std::list<std::pair<Key, Regex_Ptr>>;
 
-BUILTIN(replace)
-{
-    REQUIRE_ARGS("regex.replace", PARAM("string", TYPES(String)),
-                 PARAM("regex", TYPES(String)),
-                 PARAM("replacement", TYPES(String)));
+    static Regex_Ptr compile(const String& pattern,
+                             boost::regex::flag_type flags)
+    {
+        try
+        {
+            return std::make_shared<Compiled_Regex>(
+                boost::regex{pattern, flags}, extract_group_names(pattern));
+        }
+        catch (const boost::regex_error& e)
+        {
+            throw Frost_Recoverable_Error{
+                fmt::format("Regex error: {}", e.what())};
+        }
+    }
 
-    auto re = regex(GET(1, String));
+    std::mutex mutex_;
+    // Most recently used first
+    Entries entries_;
+    std::map<Key, Entries::iterator> index_;
+};
 
-    return Value::create(
-        boost::regex_replace(GET(0, String), re, GET(2, String)));
+Regex_Ptr regex(const String& pattern,
+                boost::regex::flag_type flags = boost::regex::perl)
+{
+    return Regex_Cache::shared().get(pattern, flags);
 }
 
-BUILTIN(replace_first)
+boost::regex::flag_type parse_flags(const String& flags)
 {
-    REQUIRE_ARGS("regex.replace_first", PARAM("string", TYPES(String)),
-                 PARAM("regex", TYPES(String)),
-                 PARAM("replacement", TYPES(String)));
-
-    auto re = regex(GET(1, String));
+    boost::regex::flag_type result = boost::regex::perl;
+    for (char flag : flags)
+    {
+        switch (flag)
+        {
+        case 'i':
+            result |= boost::regex::icase;
+            break;
+        case 's':
+            result |= boost::regex::mod_s;
+            break;
+        case 'x':
+            result |= boost::regex::mod_x;
+            break;
+        default:
+            throw Frost_Recoverable_Error{
+                fmt::format("regex.compile: unknown flag '{}'", flag)};
+        }
+    }
+    return result;
+}
 
-    return Value::create(
-        boost::regex_replace(GET(0, String), re, GET(2, String),
-                             boost::regex_constants::format_first_only));
+Value_Ptr do_matches(const String& input, const Compiled_Regex& re)
+{
+    return Value::create(boost::regex_match(input, re.re));
 }
 
-BUILTIN(replace_with)
+Value_Ptr do_contains(const String& input, const Compiled_Regex& re)
 {
-    REQUIRE_ARGS("regex.replace_with", PARAM("string", TYPES(String)),
-                 PARAM("regex", TYPES(String)),
-                 PARAM("callback", TYPES(Function)));
+    return Value::create(boost::regex_search(input, re.re));
+}
 
-    auto re = regex(GET(1, String));
-    const auto& input = GET(0, String);
-    const auto& fn = GET(2, Function);
+Value_Ptr do_replace(const String& input, const Compiled_Regex& re,
+                     const String& replacement,
+                     boost::regex_constants::match_flag_type flags =
+                         boost::regex_constants::format_default)
+{
+    return Value::create(
+        boost::regex_replace(input, re.re, replacement, flags));
+}
 
+Value_Ptr do_replace_with(const String& input, const Compiled_Regex& re,
+                          const Function& fn)
+{
     using itr = boost::regex_iterator<String::const_iterator>;
 
     std::string result;
     auto tail = input.cbegin();
 
-    for (itr it{input.cbegin(), input.cend(), re}, end; it != end; ++it)
+    for (itr it{input.cbegin(), input.cend(), re.re}, end; it != end; ++it)
     {
         const auto& match = *it;
         result.append(tail, match[0].first);
@@ -107,70 +209,29 @@ BUILTIN(replace_with)
     return Value::create(std::move(result));
 }
 
-BUILTIN(split)
+Value_Ptr do_split(const String& input, const Compiled_Regex& re)
 {
-    REQUIRE_ARGS("regex.split", PARAM("string", TYPES(String)),
-                 PARAM("regex", TYPES(String)));
-
-    auto re = regex(GET(1, String));
-    const auto& input = GET(0, String);
-
     using itr = boost::regex_token_iterator<String::const_iterator>;
     return Value::create(
-        std::ranges::subrange(itr{input.begin(), input.end(), re, -1}, itr{})
+        std::ranges::subrange(itr{input.begin(), input.end(), re.re, -1},
+                              itr{})
         | std::views::transform([](const auto& m) {
               return Value::create(String{m.first, m.second});
           })
         | std::ranges::to<Array>());
 }
 
-namespace
-{
-
-std::optional<std::vector<std::string>> extract_group_names(
-    const std::string& regex)
-{
-    std::vector<std::string> group_names;
-    static const boost::regex re{R"(\(\?(<(?<aname>\w+)>|'(?<tname>\w+)'))",
-                                 boost::regex_constants::optimize
-                                     | boost::regex_constants::perl};
-    for (boost::regex_iterator<std::string::const_iterator>
-             it{regex.begin(), regex.end(), re},
-         end;
-         it != end; ++it)
-    {
-        const auto& match = *it;
-        if (match["aname"].matched)
-            group_names.push_back(match["aname"].str());
-        if (match["tname"].matched)
-            group_names.push_back(match["tname"].str());
-    }
-
-    if (not group_names.empty())
-        return group_names;
-    else
-        return std::nullopt;
-}
-
-} // namespace
-
-BUILTIN(scan_matches)
+Value_Ptr do_scan_matches(const String& input, const Compiled_Regex& re)
 {
-    REQUIRE_ARGS("regex.scan_matches", PARAM("string", TYPES(String)),
-                 PARAM("regex", TYPES(String)));
-
     STRINGS(full, matched, value, index, named, groups, found, count, matches);
 
     using itr = std::string::const_iterator;
-    auto re = regex(GET(1, String));
-    const auto& input = GET(0, String);
-
-    auto group_names = extract_group_names(GET(1, String));
+    const auto& group_names = re.group_names;
 
     Array iterations{};
     Map result{};
 
-    for (boost::regex_iterator<itr> it{input.begin(), input.end(), re}, end;
+    for (boost::regex_iterator<itr> it{input.begin(), input.end(), re.re}, end;
          it != end; ++it)
     {
         Map each_iteration{};
@@ -232,9 +293,154 @@ BUILTIN(scan_matches)
     return Value::create(Value::trusted, std::move(result));
 }
 
+Value_Ptr make_compiled(const String& pattern, Regex_Ptr re)
+{
+    return Value::create(
+        Value::trusted,
+        Map{
+            {"pattern"_s, Value::create(auto{pattern})},
+            {
+                "matches"_s,
+                system_closure([re](builtin_args_t args) {
+                    REQUIRE_ARGS("compiled_regex.matches",
+                                 PARAM("string", TYPES(String)));
+                    return do_matches(GET(0, String), *re);
+                }),
+            },
+            {
+                "contains"_s,
+                system_closure([re](builtin_args_t args) {
+                    REQUIRE_ARGS("compiled_regex.contains",
+                                 PARAM("string", TYPES(String)));
+                    return do_contains(GET(0, String), *re);
+                }),
+            },
+            {
+                "replace"_s,
+                system_closure([re](builtin_args_t args) {
+                    REQUIRE_ARGS("compiled_regex.replace",
+                                 PARAM("string", TYPES(String)),
+                                 PARAM("replacement", TYPES(String)));
+                    return do_replace(GET(0, String), *re, GET(1, String));
+                }),
+            },
+            {
+                "replace_first"_s,
+                system_closure([re](builtin_args_t args) {
+                    REQUIRE_ARGS("compiled_regex.replace_first",
+                                 PARAM("string", TYPES(String)),
+                                 PARAM("replacement", TYPES(String)));
+                    return do_replace(
+                        GET(0, String), *re, GET(1, String),
+                        boost::regex_constants::format_first_only);
+                }),
+            },
+            {
+                "replace_with"_s,
+                system_closure([re](builtin_args_t args) {
+                    REQUIRE_ARGS("compiled_regex.replace_with",
+                                 PARAM("string", TYPES(String)),
+                                 PARAM("callback", TYPES(Function)));
+                    return do_replace_with(GET(0, String), *re,
+                                           GET(1, Function));
+                }),
+            },
+            {
+                "split"_s,
+                system_closure([re](builtin_args_t args) {
+                    REQUIRE_ARGS("compiled_regex.split",
+                                 PARAM("string", TYPES(String)));
+                    return do_split(GET(0, String), *re);
+                }),
+            },
+            {
+                "scan_matches"_s,
+                system_closure([re](builtin_args_t args) {
+                    REQUIRE_ARGS("compiled_regex.scan_matches",
+                                 PARAM("string", TYPES(String)));
+                    return do_scan_matches(GET(0, String), *re);
+                }),
+            },
+        });
+}
+
+} // namespace
+
+BUILTIN(matches)
+{
+    REQUIRE_ARGS("regex.matches", PARAM("string", TYPES(String)),
+                 PARAM("regex", TYPES(String)));
+
+    return do_matches(GET(0, String), *regex(GET(1, String)));
+}
+
+BUILTIN(contains)
+{
+    REQUIRE_ARGS("regex.contains", PARAM("string", TYPES(String)),
+                 PARAM("regex", TYPES(String)));
+
+    return do_contains(GET(0, String), *regex(GET(1, String)));
+}
+
+BUILTIN(replace)
+{
+    REQUIRE_ARGS("regex.replace", PARAM("string", TYPES(String)),
+                 PARAM("regex", TYPES(String)),
+                 PARAM("replacement", TYPES(String)));
+
+    return do_replace(GET(0, String), *regex(GET(1, String)), GET(2, String));
+}
+
+BUILTIN(replace_first)
+{
+    REQUIRE_ARGS("regex.replace_first", PARAM("string", TYPES(String)),
+                 PARAM("regex", TYPES(String)),
+                 PARAM("replacement", TYPES(String)));
+
+    return do_replace(GET(0, String), *regex(GET(1, String)), GET(2, String),
+                      boost::regex_constants::format_first_only);
+}
+
+BUILTIN(replace_with)
+{
+    REQUIRE_ARGS("regex.replace_with", PARAM("string", TYPES(String)),
+                 PARAM("regex", TYPES(String)),
+                 PARAM("callback", TYPES(Function)));
+
+    return do_replace_with(GET(0, String), *regex(GET(1, String)),
+                           GET(2, Function));
+}
+
+BUILTIN(split)
+{
+    REQUIRE_ARGS("regex.split", PARAM("string", TYPES(String)),
+                 PARAM("regex", TYPES(String)));
+
+    return do_split(GET(0, String), *regex(GET(1, String)));
+}
+
+BUILTIN(scan_matches)
+{
+    REQUIRE_ARGS("regex.scan_matches", PARAM("string", TYPES(String)),
+                 PARAM("regex", TYPES(String)));
+
+    return do_scan_matches(GET(0, String), *regex(GET(1, String)));
+}
+
+BUILTIN(compile)
+{
+    REQUIRE_ARGS("regex.compile", PARAM("regex", TYPES(String)),
+                 OPTIONAL(PARAM("flags", TYPES(String))));
+
+    const auto& pattern = GET(0, String);
+    auto flags = HAS(1) ? parse_flags(GET(1, String)) : boost::regex::perl;
+
+    return make_compiled(pattern, regex(pattern, flags));
+}
+
 } // namespace regex
 
 STDLIB_MODULE(regex, ENTRY(matches), ENTRY(contains), ENTRY(replace),
               ENTRY(replace_first), ENTRY(replace_with), ENTRY(split),
-              ENTRY(scan_matches))
+              ENTRY(scan_matches), ENTRY(compile))
 } // namespace frst
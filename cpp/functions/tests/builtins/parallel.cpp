@@ -0,0 +1,411 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <ranges>
+#include <thread>
+#include <vector>
+
+#include <frost/testing/stringmaker-specializations.hpp>
+
+#include <frost/backtrace.hpp>
+#include <frost/builtin.hpp>
+#include <frost/symbol-table.hpp>
+#include <frost/thread-pool.hpp>
+#include <frost/value.hpp>
+
+using namespace frst;
+using namespace std::literals;
+using Catch::Matchers::ContainsSubstring;
+
+namespace
+{
+template <typename Fn>
+Function make_builtin(Fn fn, std::string name)
+{
+    return std::make_shared<Builtin>(std::move(fn), std::move(name));
+}
+
+Function lookup(Symbol_Table& table, const std::string& name)
+{
+    auto val = table.lookup(name);
+    REQUIRE(val->is<Function>());
+    return val->get<Function>().value();
+}
+
+Value_Ptr ints(Int count)
+{
+    return Value::create(std::views::iota(Int{0}, count)
+                         | std::views::transform([](Int i) {
+                               return Value::create(i);
+                           })
+                         | std::ranges::to<Array>());
+}
+
+std::vector<Int> as_ints(const Value_Ptr& value)
+{
+    REQUIRE(value->is<Array>());
+    return value->raw_get<Array>()
+           | std::views::transform([](const Value_Ptr& elem) {
+                 return elem->raw_get<Int>();
+             })
+           | std::ranges::to<std::vector>();
+}
+
+Function method(const Value_Ptr& object, const std::string& name)
+{
+    REQUIRE(object->is<Map>());
+    const auto& map = object->raw_get<Map>();
+    auto it = map.find(Value::create(String{name}));
+    REQUIRE(it != map.end());
+    REQUIRE(it->second->is<Function>());
+    return it->second->raw_get<Function>();
+}
+
+// Record backtraces for as long as this lives
+struct Scoped_Backtrace
+{
+    Backtrace_State state;
+    Backtrace_State* previous = Backtrace_State::current();
+
+    Scoped_Backtrace()
+    {
+        Backtrace_State::set_current(&state);
+    }
+    ~Scoped_Backtrace()
+    {
+        Backtrace_State::set_current(previous);
+    }
+};
+} // namespace
+
+TEST_CASE("Thread_Pool")
+{
+    Thread_Pool pool{4};
+
+    SECTION("submit produces the job's result")
+    {
+        auto future = pool.submit([] { return 42; });
+        CHECK(future.get() == 42);
+    }
+
+    SECTION("submit carries the job's exception")
+    {
+        auto future = pool.submit([]() -> int {
+            throw Frost_Recoverable_Error{"boom"};
+        });
+        CHECK_THROWS_WITH(future.get(), ContainsSubstring("boom"));
+    }
+
+    SECTION("for_chunks covers every index exactly once")
+    {
+        std::vector<std::atomic<int>> seen(1000);
+        pool.for_chunks(seen.size(), 7,
+                        [&](std::size_t begin, std::size_t end) {
+                            for (auto i = begin; i < end; ++i)
+                                ++seen[i];
+                        });
+        CHECK(std::ranges::all_of(seen, [](const auto& n) { return n == 1; }));
+    }
+
+    SECTION("for_chunks rethrows the earliest failing chunk")
+    {
+        CHECK_THROWS_WITH(
+            pool.for_chunks(100, 10,
+                            [](std::size_t begin, std::size_t) {
+                                if (begin >= 30)
+                                    throw Frost_Recoverable_Error{
+                                        fmt::format("chunk {}", begin)};
+                            }),
+            ContainsSubstring("chunk 30"));
+    }
+
+    SECTION("for_chunks can be nested without starving the pool")
+    {
+        std::atomic<int> total = 0;
+        pool.for_chunks(16, 1, [&](std::size_t, std::size_t) {
+            pool.for_chunks(16, 1, [&](std::size_t, std::size_t) {
+                ++total;
+            });
+        });
+        CHECK(total == 256);
+    }
+}
+
+TEST_CASE("Builtin parallel")
+{
+    Symbol_Table table;
+    inject_builtins(table);
+
+    auto pmap = lookup(table, "pmap");
+    auto pselect = lookup(table, "pselect");
+    auto preduce = lookup(table, "preduce");
+
+    auto twice = Value::create(make_builtin(
+        [](builtin_args_t args) {
+            return Value::create(args.at(0)->raw_get<Int>() * 2);
+        },
+        "twice"));
+    auto is_even = Value::create(make_builtin(
+        [](builtin_args_t args) {
+            return Value::create(args.at(0)->raw_get<Int>() % 2 == 0);
+        },
+        "is_even"));
+    auto plus = Value::create(make_builtin(
+        [](builtin_args_t args) {
+            return Value::create(args.at(0)->raw_get<Int>()
+                                 + args.at(1)->raw_get<Int>());
+        },
+        "plus"));
+
+    constexpr Int count = 10'000;
+    const auto input = ints(count);
+
+    SECTION("pmap keeps the order of its input")
+    {
+        const auto expected = std::views::iota(Int{0}, count)
+                              | std::views::transform([](Int i) {
+                                    return i * 2;
+                                })
+                              | std::ranges::to<std::vector>();
+        CHECK(as_ints(pmap->call({input, twice})) == expected);
+    }
+
+    SECTION("pmap runs on more than the calling thread")
+    {
+        std::mutex mutex;
+        std::vector<std::thread::id> threads;
+        auto record = Value::create(make_builtin(
+            [&](builtin_args_t args) {
+                std::this_thread::sleep_for(1ms);
+                std::lock_guard lock{mutex};
+                if (not std::ranges::contains(threads,
+                                              std::this_thread::get_id()))
+                    threads.push_back(std::this_thread::get_id());
+                return args.at(0);
+            },
+            "record"));
+
+        (void)pmap->call({ints(64), record});
+        if (Thread_Pool::shared().size() > 1)
+            CHECK(threads.size() > 1);
+    }
+
+    SECTION("pselect keeps the order of its input")
+    {
+        const auto expected = std::views::iota(Int{0}, count)
+                              | std::views::filter([](Int i) {
+                                    return i % 2 == 0;
+                                })
+                              | std::ranges::to<std::vector>();
+        CHECK(as_ints(pselect->call({input, is_even})) == expected);
+    }
+
+    SECTION("preduce matches fold for an associative function")
+    {
+        const auto sum = count * (count - 1) / 2;
+        CHECK(preduce->call({input, plus})->raw_get<Int>() == sum);
+        CHECK(preduce->call({input, plus, Value::create(100_f)})
+                  ->raw_get<Int>()
+              == sum + 100);
+    }
+
+    SECTION("preduce with init folds in order unless given a combine")
+    {
+        const auto words = Value::create(
+            std::views::iota(Int{0}, count)
+            | std::views::transform([](Int i) {
+                  return Value::create(String(static_cast<std::size_t>(i % 7),
+                                              'x'));
+              })
+            | std::ranges::to<Array>());
+        const auto add_length = Value::create(make_builtin(
+            [](builtin_args_t args) {
+                return Value::create(
+                    args.at(0)->raw_get<Int>()
+                    + static_cast<Int>(args.at(1)->raw_get<String>().size()));
+            },
+            "add_length"));
+
+        Int total = 0;
+        for (Int i = 0; i < count; ++i)
+            total += i % 7;
+
+        CHECK(preduce->call({words, add_length, Value::create(0_f)})
+                  ->raw_get<Int>()
+              == total);
+        CHECK(preduce->call({words, add_length, Value::create(0_f), plus})
+                  ->raw_get<Int>()
+              == total);
+    }
+
+    SECTION("Empty and single element input")
+    {
+        const auto empty = Value::create(Array{});
+        CHECK(as_ints(pmap->call({empty, twice})).empty());
+        CHECK(as_ints(pselect->call({empty, is_even})).empty());
+        CHECK(preduce->call({empty, plus})->is<Null>());
+        CHECK(preduce->call({empty, plus, Value::create(5_f)})->raw_get<Int>()
+              == 5);
+
+        const auto one = ints(1);
+        CHECK(as_ints(pmap->call({one, twice})) == std::vector<Int>{0});
+        CHECK(preduce->call({one, plus})->raw_get<Int>() == 0);
+    }
+
+    SECTION("The earliest failing element's error is raised")
+    {
+        auto fail_from = Value::create(make_builtin(
+            [](builtin_args_t args) -> Value_Ptr {
+                const auto i = args.at(0)->raw_get<Int>();
+                if (i % 1000 == 999)
+                    throw Frost_Recoverable_Error{fmt::format("bad {}", i)};
+                return args.at(0);
+            },
+            "fail_from"));
+
+        CHECK_THROWS_WITH(pmap->call({input, fail_from}),
+                          ContainsSubstring("bad 999"));
+        CHECK_THROWS_WITH(pselect->call({input, fail_from}),
+                          ContainsSubstring("bad 999"));
+    }
+
+    SECTION("Runs on the calling thread while recording backtraces")
+    {
+        Scoped_Backtrace backtrace;
+
+        std::atomic<bool> other_thread = false;
+        const auto caller = std::this_thread::get_id();
+        auto check_thread = Value::create(make_builtin(
+            [&](builtin_args_t args) {
+                if (std::this_thread::get_id() != caller)
+                    other_thread = true;
+                return args.at(0);
+            },
+            "check_thread"));
+
+        (void)pmap->call({input, check_thread});
+        (void)pselect->call({input, check_thread});
+        CHECK_FALSE(other_thread);
+    }
+
+    SECTION("Type errors")
+    {
+        CHECK_THROWS_AS(pmap->call({Value::create(1_f), twice}),
+                        Frost_User_Error);
+        CHECK_THROWS_AS(pselect->call({input, Value::create(1_f)}),
+                        Frost_User_Error);
+        CHECK_THROWS_AS(preduce->call({Value::create(Map{}), plus}),
+                        Frost_User_Error);
+        CHECK_THROWS_AS(
+            preduce->call({input, plus, Value::create(0_f), Value::create(1_f)}),
+            Frost_User_Error);
+    }
+}
+
+TEST_CASE("Builtin thread_pool")
+{
+    Symbol_Table table;
+    inject_builtins(table);
+
+    auto thread_pool = lookup(table, "thread_pool");
+    auto pool = thread_pool->call({Value::create(2_f)});
+    auto spawn = method(pool, "spawn");
+
+    auto plus = Value::create(make_builtin(
+        [](builtin_args_t args) {
+            return Value::create(args.at(0)->raw_get<Int>()
+                                 + args.at(1)->raw_get<Int>());
+        },
+        "plus"));
+
+    SECTION("size is the thread count")
+    {
+        CHECK(method(pool, "size")->call({})->raw_get<Int>() == 2);
+    }
+
+    SECTION("get produces the function's result")
+    {
+        auto future =
+            spawn->call({plus, Value::create(40_f), Value::create(2_f)});
+        CHECK(method(future, "get")->call({})->raw_get<Int>() == 42);
+        CHECK(method(future, "get")->call({})->raw_get<Int>() == 42);
+        CHECK(method(future, "is_ready")->call({})->truthy());
+        CHECK(method(future, "wait_for")
+                  ->call({Value::create(0_f)})
+                  ->truthy());
+    }
+
+    SECTION("get rethrows the function's error every time")
+    {
+        auto fail = Value::create(make_builtin(
+            [](builtin_args_t) -> Value_Ptr {
+                throw Frost_Recoverable_Error{"boom"};
+            },
+            "fail"));
+
+        auto get = method(spawn->call({fail}), "get");
+        CHECK_THROWS_WITH(get->call({}), ContainsSubstring("boom"));
+        CHECK_THROWS_WITH(get->call({}), ContainsSubstring("boom"));
+    }
+
+    SECTION("wait_for gives up on a task that is still running")
+    {
+        std::promise<void> release;
+        auto released = release.get_future().share();
+        auto blocked = Value::create(make_builtin(
+            [released](builtin_args_t) {
+                released.wait();
+                return Value::null();
+            },
+            "blocked"));
+
+        auto future = spawn->call({blocked});
+        CHECK_FALSE(method(future, "wait_for")
+                        ->call({Value::create(10_f)})
+                        ->truthy());
+        CHECK_FALSE(method(future, "is_ready")->call({})->truthy());
+
+        release.set_value();
+        CHECK(method(future, "get")->call({})->is<Null>());
+        CHECK(method(future, "is_ready")->call({})->truthy());
+    }
+
+    SECTION("Tasks still run after the pool itself is dropped")
+    {
+        std::atomic<int> runs = 0;
+        auto count_run = Value::create(make_builtin(
+            [&](builtin_args_t) {
+                ++runs;
+                return Value::null();
+            },
+            "count_run"));
+
+        std::vector<Value_Ptr> futures;
+        for (int i = 0; i < 20; ++i)
+            futures.push_back(spawn->call({count_run}));
+        pool.reset();
+        spawn.reset();
+
+        for (const auto& future : futures)
+            (void)method(future, "get")->call({});
+        CHECK(runs == 20);
+    }
+
+    SECTION("Errors")
+    {
+        CHECK_THROWS_AS(thread_pool->call({Value::create(0_f)}),
+                        Frost_User_Error);
+        CHECK_THROWS_AS(thread_pool->call({Value::create("2"s)}),
+                        Frost_User_Error);
+        CHECK_THROWS_AS(spawn->call({Value::create(1_f)}), Frost_User_Error);
+        CHECK_THROWS_AS(
+            method(spawn->call({plus, Value::create(1_f), Value::create(1_f)}),
+                   "wait_for")
+                ->call({}),
+            Frost_User_Error);
+    }
+}
@@ -576,6 +576,7 @@ TEST_CASE("Builtin ranges")
 
         // full array
         require_array_eq(fn->call({arr, Value::create(0_f)}), {a, b, c, d, e});
+        CHECK(fn->call({arr, Value::create(0_f)}) == arr);
 
         // negative start
         require_array_eq(fn->call({arr, Value::create(-2_f)}), {d, e});
@@ -758,6 +759,10 @@ TEST_CASE("Builtin ranges")
         auto empty_arr = Value::create(Array{});
         require_array_eq(fn->call({empty_arr, Value::create(2_f)}), {});
 
+        // Taking everything shares the input rather than copying it
+        CHECK(fn->call({arr, Value::create(5_f)}) == arr);
+        CHECK(fn->call({arr, Value::create(10_f)}) == arr);
+
         CHECK_THROWS_AS(fn->call({arr, Value::create(-1_f)}), Frost_User_Error);
     }
 
@@ -780,6 +785,9 @@ TEST_CASE("Builtin ranges")
         auto empty_arr = Value::create(Array{});
         require_array_eq(fn->call({empty_arr, Value::create(2_f)}), {});
 
+        // Dropping nothing shares the input rather than copying it
+        CHECK(fn->call({arr, Value::create(0_f)}) == arr);
+
         CHECK_THROWS_AS(fn->call({arr, Value::create(-1_f)}), Frost_User_Error);
     }
 
@@ -127,6 +127,29 @@ std::shared_ptr<std::vector<Statement::Ptr>> make_body(
     return std::make_shared<std::vector<Statement::Ptr>>(std::move(body));
 }
 
+std::shared_ptr<Closure> make_closure(
+    std::vector<std::string> parameters,
+    std::shared_ptr<std::vector<Statement::Ptr>> body,
+    std::shared_ptr<Expression> return_expr, const Symbol_Table& captures,
+    std::optional<std::string> vararg_parameter = {},
+    std::optional<std::string> self_name = {})
+{
+    std::vector<std::string> capture_names;
+    std::vector<Value_Ptr> capture_values;
+    for (const auto& name : captures.names())
+    {
+        capture_names.emplace_back(name);
+        capture_values.push_back(captures.lookup(std::string{name}));
+    }
+
+    auto layout = resolve_frame_layout(
+        std::move(parameters), std::move(vararg_parameter),
+        std::move(self_name), std::move(capture_names), *body, *return_expr);
+
+    return Closure::create(std::move(layout), std::move(body),
+                           std::move(return_expr), std::move(capture_values));
+}
+
 std::pair<std::string, std::string> split_header_body(const std::string& dump)
 {
     const auto pos = dump.find('\n');
@@ -177,12 +200,13 @@ TEST_CASE("Construct Closure")
         body.push_back(node<Name_Lookup>(AST_Node::no_range, "missing"));
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{"p"}, body_ptr, null_expr(), std::move(captures), 0};
+        auto closure = make_closure({"p"}, body_ptr, null_expr(),
+                                    std::move(captures));
 
-        CHECK(capture_names(closure) == std::set<std::string>{"x", "y"});
-        CHECK(closure.debug_capture_table().lookup("x") == x_val);
-        CHECK(closure.debug_capture_table().lookup("y") == y_val);
-        CHECK_FALSE(closure.debug_capture_table().has("p"));
+        CHECK(capture_names(*closure) == std::set<std::string>{"x", "y"});
+        CHECK(closure->debug_capture_table().lookup("x") == x_val);
+        CHECK(closure->debug_capture_table().lookup("y") == y_val);
+        CHECK_FALSE(closure->debug_capture_table().has("p"));
     }
 }
 
@@ -197,9 +221,10 @@ TEST_CASE("Call Closure")
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{}, body_ptr, null_expr(), std::move(captures), 0};
+        auto closure = make_closure({}, body_ptr, null_expr(),
+                                    std::move(captures));
 
-        auto result = closure.call({});
+        auto result = closure->call({});
         CHECK(result->is<Null>());
     }
 
@@ -209,10 +234,10 @@ TEST_CASE("Call Closure")
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{
-            {"p", "q"}, body_ptr, null_expr(), std::move(captures), 0};
+        auto closure = make_closure({"p", "q"}, body_ptr, null_expr(),
+                                    std::move(captures));
 
-        CHECK_THROWS_WITH(closure.call({Value::create(1_f)}),
+        CHECK_THROWS_WITH(closure->call({Value::create(1_f)}),
                           ContainsSubstring("wrong number of arguments")
                               && ContainsSubstring("Expected 2, but got 1."));
     }
@@ -225,13 +250,11 @@ TEST_CASE("Call Closure")
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{},
-                        body_ptr,
-                        expr<Literal>(AST_Node::no_range, out_val),
-                        std::move(captures),
-                        0};
+        auto closure = make_closure({}, body_ptr,
+                                    expr<Literal>(AST_Node::no_range, out_val),
+                                    std::move(captures));
 
-        auto result = closure.call({});
+        auto result = closure->call({});
         CHECK(result == out_val);
     }
 
@@ -241,13 +264,11 @@ TEST_CASE("Call Closure")
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{"p", "q"},
-                        body_ptr,
-                        expr<Name_Lookup>(AST_Node::no_range, "q"),
-                        std::move(captures),
-                        0};
+        auto closure = make_closure({"p", "q"}, body_ptr,
+                                    expr<Name_Lookup>(AST_Node::no_range, "q"),
+                                    std::move(captures));
 
-        CHECK_THROWS_WITH(closure.call({Value::create(1_f)}),
+        CHECK_THROWS_WITH(closure->call({Value::create(1_f)}),
                           ContainsSubstring("wrong number of arguments")
                               && ContainsSubstring("Expected 2, but got 1."));
     }
@@ -263,13 +284,11 @@ TEST_CASE("Call Closure")
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{"a", "b", "c"},
-                        body_ptr,
-                        lookup_array_expr({"a", "b", "c"}),
-                        std::move(captures),
-                        0};
+        auto closure = make_closure({"a", "b", "c"}, body_ptr,
+                                    lookup_array_expr({"a", "b", "c"}),
+                                    std::move(captures));
 
-        CHECK_THROWS_WITH(closure.call({}),
+        CHECK_THROWS_WITH(closure->call({}),
                           ContainsSubstring("wrong number of arguments")
                               && ContainsSubstring("Expected 3, but got 0."));
     }
@@ -280,14 +299,11 @@ TEST_CASE("Call Closure")
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{"p"},
-                        body_ptr,
-                        expr<Name_Lookup>(AST_Node::no_range, "rest"),
-                        std::move(captures),
-                        0,
-                        "rest"};
+        auto closure = make_closure(
+            {"p"}, body_ptr, expr<Name_Lookup>(AST_Node::no_range, "rest"),
+            std::move(captures), "rest");
 
-        auto result = closure.call({Value::create(1_f)});
+        auto result = closure->call({Value::create(1_f)});
         REQUIRE(result->is<Array>());
         CHECK(result->get<Array>()->empty());
     }
@@ -302,14 +318,11 @@ TEST_CASE("Call Closure")
         auto b = Value::create(2_f);
         auto c = Value::create(3_f);
 
-        Closure closure{{"p"},
-                        body_ptr,
-                        expr<Name_Lookup>(AST_Node::no_range, "rest"),
-                        std::move(captures),
-                        0,
-                        "rest"};
+        auto closure = make_closure(
+            {"p"}, body_ptr, expr<Name_Lookup>(AST_Node::no_range, "rest"),
+            std::move(captures), "rest");
 
-        auto result = closure.call({a, b, c});
+        auto result = closure->call({a, b, c});
         REQUIRE(result->is<Array>());
         auto arr = result->get<Array>();
         REQUIRE(arr->size() == 2);
@@ -327,15 +340,12 @@ TEST_CASE("Call Closure")
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{"p"},
-                        body_ptr,
-                        lookup_array_expr({"p", "rest"}),
-                        std::move(captures),
-                        0,
-                        "rest"};
+        auto closure = make_closure({"p"}, body_ptr,
+                                    lookup_array_expr({"p", "rest"}),
+                                    std::move(captures), "rest");
 
         CHECK_THROWS_WITH(
-            closure.call({}),
+            closure->call({}),
             ContainsSubstring("wrong number of arguments")
                 && ContainsSubstring("Expected at least 1, but got 0."));
     }
@@ -354,14 +364,11 @@ TEST_CASE("Call Closure")
         auto b = Value::create(2_f);
         auto c = Value::create(3_f);
 
-        Closure closure{{"p"},
-                        body_ptr,
-                        lookup_array_expr({"p", "rest"}),
-                        std::move(captures),
-                        0,
-                        "rest"};
+        auto closure = make_closure({"p"}, body_ptr,
+                                    lookup_array_expr({"p", "rest"}),
+                                    std::move(captures), "rest");
 
-        auto result = closure.call({a, b, c});
+        auto result = closure->call({a, b, c});
         REQUIRE(result->is<Array>());
         auto arr = result->get<Array>().value();
         REQUIRE(arr.size() == 2);
@@ -382,14 +389,11 @@ TEST_CASE("Call Closure")
         auto a = Value::create(1_f);
         auto b = Value::create(2_f);
 
-        Closure closure{{"a", "b"},
-                        body_ptr,
-                        lookup_array_expr({"a", "b", "rest"}),
-                        std::move(captures),
-                        0,
-                        "rest"};
+        auto closure = make_closure({"a", "b"}, body_ptr,
+                                    lookup_array_expr({"a", "b", "rest"}),
+                                    std::move(captures), "rest");
 
-        auto result = closure.call({a, b});
+        auto result = closure->call({a, b});
         REQUIRE(result->is<Array>());
         auto arr = result->get<Array>().value();
         REQUIRE(arr.size() == 3);
@@ -405,15 +409,12 @@ TEST_CASE("Call Closure")
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{"a", "b"},
-                        body_ptr,
-                        expr<Name_Lookup>(AST_Node::no_range, "rest"),
-                        std::move(captures),
-                        0,
-                        "rest"};
+        auto closure = make_closure(
+            {"a", "b"}, body_ptr, expr<Name_Lookup>(AST_Node::no_range, "rest"),
+            std::move(captures), "rest");
 
         CHECK_THROWS_WITH(
-            closure.call({Value::create(1_f)}),
+            closure->call({Value::create(1_f)}),
             ContainsSubstring("wrong number of arguments")
                 && ContainsSubstring("Expected at least 2, but got 1."));
     }
@@ -424,14 +425,11 @@ TEST_CASE("Call Closure")
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{},
-                        body_ptr,
-                        expr<Name_Lookup>(AST_Node::no_range, "rest"),
-                        std::move(captures),
-                        0,
-                        "rest"};
+        auto closure = make_closure(
+            {}, body_ptr, expr<Name_Lookup>(AST_Node::no_range, "rest"),
+            std::move(captures), "rest");
 
-        auto result = closure.call({});
+        auto result = closure->call({});
         REQUIRE(result->is<Array>());
         CHECK(result->get<Array>()->empty());
     }
@@ -446,14 +444,11 @@ TEST_CASE("Call Closure")
         auto b = Value::create(2_f);
         auto c = Value::create(3_f);
 
-        Closure closure{{},
-                        body_ptr,
-                        expr<Name_Lookup>(AST_Node::no_range, "rest"),
-                        std::move(captures),
-                        0,
-                        "rest"};
+        auto closure = make_closure(
+            {}, body_ptr, expr<Name_Lookup>(AST_Node::no_range, "rest"),
+            std::move(captures), "rest");
 
-        auto result = closure.call({a, b, c});
+        auto result = closure->call({a, b, c});
         REQUIRE(result->is<Array>());
         auto arr = result->get<Array>();
         REQUIRE(arr->size() == 3);
@@ -471,10 +466,10 @@ TEST_CASE("Call Closure")
         body.push_back(node<Name_Lookup>(AST_Node::no_range, "x"));
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{"p"}, body_ptr, null_expr(), std::move(captures),
-                        0,     "rest"};
+        auto closure = make_closure({"p"}, body_ptr, null_expr(),
+                                    std::move(captures), "rest");
 
-        const auto names = capture_names(closure);
+        const auto names = capture_names(*closure);
         CHECK(names.contains("x"));
         CHECK_FALSE(names.contains("rest"));
     }
@@ -485,18 +480,15 @@ TEST_CASE("Call Closure")
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{"p"},
-                        body_ptr,
-                        expr<Name_Lookup>(AST_Node::no_range, "p"),
-                        std::move(captures),
-                        0,
-                        "rest"};
+        auto closure = make_closure({"p"}, body_ptr,
+                                    expr<Name_Lookup>(AST_Node::no_range, "p"),
+                                    std::move(captures), "rest");
 
         auto a = Value::create(1_f);
         auto b = Value::create(2_f);
         auto c = Value::create(3_f);
 
-        CHECK_NOTHROW(closure.call({a, b, c}));
+        CHECK_NOTHROW(closure->call({a, b, c}));
     }
 
     SECTION("Debug dump unaffected by variadic parameter")
@@ -505,14 +497,12 @@ TEST_CASE("Call Closure")
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{"p"},
-                        body_ptr,
-                        expr<Literal>(AST_Node::no_range, Value::create(42_f)),
-                        std::move(captures),
-                        0,
-                        "rest"};
+        auto closure = make_closure(
+            {"p"}, body_ptr,
+            expr<Literal>(AST_Node::no_range, Value::create(42_f)),
+            std::move(captures), "rest");
 
-        const auto dump = closure.debug_dump();
+        const auto dump = closure->debug_dump();
         std::cout << dump;
 
         CHECK(dump == R"(<Closure>
@@ -530,14 +520,11 @@ Literal(42) [0:0-0:0]
         body.push_back(node<Name_Lookup>(AST_Node::no_range, "rest"));
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{},
-                        body_ptr,
-                        expr<Name_Lookup>(AST_Node::no_range, "rest"),
-                        std::move(captures),
-                        0,
-                        "rest"};
+        auto closure = make_closure(
+            {}, body_ptr, expr<Name_Lookup>(AST_Node::no_range, "rest"),
+            std::move(captures), "rest");
 
-        CHECK_THROWS_WITH(closure.call({}),
+        CHECK_THROWS_WITH(closure->call({}),
                           "Cannot define rest as it is already defined");
     }
 
@@ -548,13 +535,11 @@ Literal(42) [0:0-0:0]
         auto body_ptr = make_body(std::move(body));
 
         auto p_val = Value::create(99_f);
-        Closure closure{{"p"},
-                        body_ptr,
-                        expr<Name_Lookup>(AST_Node::no_range, "p"),
-                        std::move(captures),
-                        0};
+        auto closure = make_closure({"p"}, body_ptr,
+                                    expr<Name_Lookup>(AST_Node::no_range, "p"),
+                                    std::move(captures));
 
-        auto result = closure.call({p_val});
+        auto result = closure->call({p_val});
         CHECK(result == p_val);
     }
 
@@ -566,13 +551,11 @@ Literal(42) [0:0-0:0]
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{},
-                        body_ptr,
-                        expr<Literal>(AST_Node::no_range, lit_val),
-                        std::move(captures),
-                        0};
+        auto closure = make_closure({}, body_ptr,
+                                    expr<Literal>(AST_Node::no_range, lit_val),
+                                    std::move(captures));
 
-        auto result = closure.call({});
+        auto result = closure->call({});
         CHECK(result == lit_val);
     }
 
@@ -582,17 +565,15 @@ Literal(42) [0:0-0:0]
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{"p"},
-                        body_ptr,
-                        expr<Name_Lookup>(AST_Node::no_range, "p"),
-                        std::move(captures),
-                        0};
+        auto closure = make_closure({"p"}, body_ptr,
+                                    expr<Name_Lookup>(AST_Node::no_range, "p"),
+                                    std::move(captures));
 
         auto first = Value::create(1_f);
         auto second = Value::create(2_f);
 
-        CHECK(closure.call({first}) == first);
-        CHECK(closure.call({second}) == second);
+        CHECK(closure->call({first}) == first);
+        CHECK(closure->call({second}) == second);
     }
 
     SECTION("Evaluation order follows statement order")
@@ -628,13 +609,11 @@ Literal(42) [0:0-0:0]
         body.push_back(std::move(third));
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{},
-                        body_ptr,
-                        expr<Literal>(AST_Node::no_range, third_val),
-                        std::move(captures),
-                        0};
+        auto closure = make_closure(
+            {}, body_ptr, expr<Literal>(AST_Node::no_range, third_val),
+            std::move(captures));
 
-        auto result = closure.call({});
+        auto result = closure->call({});
         CHECK(result == third_val);
     }
 
@@ -662,9 +641,10 @@ Literal(42) [0:0-0:0]
         body.push_back(std::move(body_expr));
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{}, body_ptr, return_expr, std::move(captures), 0};
+        auto closure = make_closure({}, body_ptr, return_expr,
+                                    std::move(captures));
 
-        auto result = closure.call({});
+        auto result = closure->call({});
         CHECK(result == return_val);
     }
 
@@ -678,14 +658,12 @@ Literal(42) [0:0-0:0]
             node<Literal>(AST_Node::no_range, Value::create(1_f)), false));
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{},
-                        body_ptr,
-                        expr<Name_Lookup>(AST_Node::no_range, "x"),
-                        std::move(captures),
-                        0};
+        auto closure = make_closure({}, body_ptr,
+                                    expr<Name_Lookup>(AST_Node::no_range, "x"),
+                                    std::move(captures));
 
-        auto first = closure.call({});
-        auto second = closure.call({});
+        auto first = closure->call({});
+        auto second = closure->call({});
 
         CHECK(first->get<Int>() == 1_f);
         CHECK(second->get<Int>() == 1_f);
@@ -701,17 +679,15 @@ Literal(42) [0:0-0:0]
                                     false));
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{"p"},
-                        body_ptr,
-                        expr<Name_Lookup>(AST_Node::no_range, "x"),
-                        std::move(captures),
-                        0};
+        auto closure = make_closure({"p"}, body_ptr,
+                                    expr<Name_Lookup>(AST_Node::no_range, "x"),
+                                    std::move(captures));
 
         auto first = Value::create(10_f);
         auto second = Value::create(20_f);
 
-        CHECK(closure.call({first}) == first);
-        CHECK(closure.call({second}) == second);
+        CHECK(closure->call({first}) == first);
+        CHECK(closure->call({second}) == second);
     }
 
     SECTION("Captured value used before local define")
@@ -728,16 +704,15 @@ Literal(42) [0:0-0:0]
             node<Literal>(AST_Node::no_range, Value::create(4_f)), false));
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{},
-                        body_ptr,
-                        expr<Binop>(AST_Node::no_range,
-                                    node<Name_Lookup>(AST_Node::no_range, "x"),
-                                    Binary_Op::PLUS,
-                                    node<Name_Lookup>(AST_Node::no_range, "y")),
-                        std::move(captures),
-                        0};
+        auto closure = make_closure(
+            {}, body_ptr,
+            expr<Binop>(AST_Node::no_range,
+                        node<Name_Lookup>(AST_Node::no_range, "x"),
+                        Binary_Op::PLUS,
+                        node<Name_Lookup>(AST_Node::no_range, "y")),
+            std::move(captures));
 
-        auto result = closure.call({});
+        auto result = closure->call({});
         CHECK(result->get<Int>() == 6_f);
     }
 
@@ -750,13 +725,11 @@ Literal(42) [0:0-0:0]
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{},
-                        body_ptr,
-                        expr<Name_Lookup>(AST_Node::no_range, "x"),
-                        std::move(captures),
-                        0};
+        auto closure = make_closure({}, body_ptr,
+                                    expr<Name_Lookup>(AST_Node::no_range, "x"),
+                                    std::move(captures));
 
-        auto result = closure.call({});
+        auto result = closure->call({});
         CHECK(result == x_val);
     }
 
@@ -774,15 +747,13 @@ Literal(42) [0:0-0:0]
                          node<Literal>(AST_Node::no_range, local_val), false));
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{},
-                        body_ptr,
-                        expr<Name_Lookup>(AST_Node::no_range, "x"),
-                        std::move(captures),
-                        0};
+        auto closure = make_closure({}, body_ptr,
+                                    expr<Name_Lookup>(AST_Node::no_range, "x"),
+                                    std::move(captures));
 
-        auto result = closure.call({});
+        auto result = closure->call({});
         CHECK(result == local_val);
-        CHECK(closure.debug_capture_table().lookup("x") == x_val);
+        CHECK(closure->debug_capture_table().lookup("x") == x_val);
     }
 
     SECTION("Body statements execute when return expression is explicit null")
@@ -794,9 +765,10 @@ Literal(42) [0:0-0:0]
         body.push_back(node<Flag_Statement>(&executed));
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{}, body_ptr, null_expr(), std::move(captures), 0};
+        auto closure = make_closure({}, body_ptr, null_expr(),
+                                    std::move(captures));
 
-        auto result = closure.call({});
+        auto result = closure->call({});
         CHECK(result->is<Null>());
         CHECK(executed == 1);
     }
@@ -813,10 +785,11 @@ Literal(42) [0:0-0:0]
         body.push_back(std::move(expr));
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{"p"}, body_ptr, null_expr(), std::move(captures), 0};
+        auto closure = make_closure({"p"}, body_ptr, null_expr(),
+                                    std::move(captures));
 
         CHECK_THROWS_WITH(
-            closure.call({Value::create(1_f), Value::create(2_f)}),
+            closure->call({Value::create(1_f), Value::create(2_f)}),
             ContainsSubstring("wrong number of arguments")
                 && ContainsSubstring("Expected 1, but got 2."));
     }
@@ -832,10 +805,11 @@ Literal(42) [0:0-0:0]
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{"p"}, body_ptr, return_expr, std::move(captures), 0};
+        auto closure = make_closure({"p"}, body_ptr, return_expr,
+                                    std::move(captures));
 
         CHECK_THROWS_WITH(
-            closure.call({Value::create(1_f), Value::create(2_f)}),
+            closure->call({Value::create(1_f), Value::create(2_f)}),
             ContainsSubstring("wrong number of arguments")
                 && ContainsSubstring("Expected 1, but got 2."));
     }
@@ -852,11 +826,11 @@ Literal(42) [0:0-0:0]
         body.push_back(std::move(expr));
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{"p", "q"},          body_ptr, null_expr(),
-                        std::move(captures), 0,        "rest"};
+        auto closure = make_closure({"p", "q"}, body_ptr, null_expr(),
+                                    std::move(captures), "rest");
 
         CHECK_THROWS_WITH(
-            closure.call({Value::create(1_f)}),
+            closure->call({Value::create(1_f)}),
             ContainsSubstring("wrong number of arguments")
                 && ContainsSubstring("Expected at least 2, but got 1."));
     }
@@ -872,11 +846,11 @@ Literal(42) [0:0-0:0]
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{"p", "q"},          body_ptr, return_expr,
-                        std::move(captures), 0,        "rest"};
+        auto closure = make_closure({"p", "q"}, body_ptr, return_expr,
+                                    std::move(captures), "rest");
 
         CHECK_THROWS_WITH(
-            closure.call({Value::create(1_f)}),
+            closure->call({Value::create(1_f)}),
             ContainsSubstring("wrong number of arguments")
                 && ContainsSubstring("Expected at least 2, but got 1."));
     }
@@ -887,14 +861,13 @@ Literal(42) [0:0-0:0]
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{"p"},
-                        body_ptr,
-                        expr<Literal>(AST_Node::no_range, Value::create(1_f)),
-                        std::move(captures),
-                        0};
+        auto closure = make_closure(
+            {"p"}, body_ptr,
+            expr<Literal>(AST_Node::no_range, Value::create(1_f)),
+            std::move(captures));
 
         CHECK_THROWS_WITH(
-            closure.call({Value::create(1_f), Value::create(2_f)}),
+            closure->call({Value::create(1_f), Value::create(2_f)}),
             ContainsSubstring("wrong number of arguments")
                 && ContainsSubstring("Expected 1, but got 2."));
     }
@@ -906,17 +879,15 @@ Literal(42) [0:0-0:0]
         body.push_back(node<Literal>(AST_Node::no_range, Value::null()));
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{
-            {},
-            body_ptr,
+        auto closure = make_closure(
+            {}, body_ptr,
             expr<Binop>(AST_Node::no_range,
                         node<Literal>(AST_Node::no_range, Value::create(1_f)),
                         Binary_Op::PLUS,
                         node<Literal>(AST_Node::no_range, Value::create(true))),
-            std::move(captures),
-            0};
+            std::move(captures));
 
-        CHECK_THROWS_WITH(closure.call({}),
+        CHECK_THROWS_WITH(closure->call({}),
                           ContainsSubstring("Cannot add incompatible types"));
     }
 
@@ -926,13 +897,11 @@ Literal(42) [0:0-0:0]
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{},
-                        body_ptr,
-                        expr<Uncaptured_Lookup>("missing"),
-                        std::move(captures),
-                        0};
+        auto closure = make_closure({}, body_ptr,
+                                    expr<Uncaptured_Lookup>("missing"),
+                                    std::move(captures));
 
-        CHECK_THROWS_WITH(closure.call({}),
+        CHECK_THROWS_WITH(closure->call({}),
                           ContainsSubstring("Symbol")
                               && ContainsSubstring("missing")
                               && ContainsSubstring("not defined"));
@@ -951,13 +920,12 @@ TEST_CASE("Debug Dump Closure")
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{},
-                        body_ptr,
-                        expr<Literal>(AST_Node::no_range, Value::create(42_f)),
-                        std::move(captures),
-                        0};
+        auto closure = make_closure(
+            {}, body_ptr,
+            expr<Literal>(AST_Node::no_range, Value::create(42_f)),
+            std::move(captures));
 
-        const auto dump = closure.debug_dump();
+        const auto dump = closure->debug_dump();
         std::cout << dump;
 
         CHECK(dump == R"(<Closure>
@@ -971,9 +939,10 @@ Literal(42) [0:0-0:0]
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{}, body_ptr, null_expr(), std::move(captures), 0};
+        auto closure = make_closure({}, body_ptr, null_expr(),
+                                    std::move(captures));
 
-        const auto dump = closure.debug_dump();
+        const auto dump = closure->debug_dump();
         std::cout << dump;
 
         CHECK(dump == R"(<Closure>
@@ -991,15 +960,12 @@ Literal(null) [0:0-0:0]
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{},
-                        body_ptr,
-                        expr<Literal>(AST_Node::no_range, Value::create(42_f)),
-                        std::move(captures),
-                        0,
-                        {},
-                        "rec"};
+        auto closure = make_closure(
+            {}, body_ptr,
+            expr<Literal>(AST_Node::no_range, Value::create(42_f)),
+            std::move(captures), {}, "rec");
 
-        const auto dump = closure.debug_dump();
+        const auto dump = closure->debug_dump();
         std::cout << dump;
 
         const auto [header, body_dump] = split_header_body(dump);
@@ -1019,15 +985,12 @@ Literal(null) [0:0-0:0]
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{{},
-                        body_ptr,
-                        expr<Literal>(AST_Node::no_range, Value::create(42_f)),
-                        std::move(captures),
-                        0,
-                        {},
-                        "rec"};
+        auto closure = make_closure(
+            {}, body_ptr,
+            expr<Literal>(AST_Node::no_range, Value::create(42_f)),
+            std::move(captures), {}, "rec");
 
-        const auto dump = closure.debug_dump();
+        const auto dump = closure->debug_dump();
         std::cout << dump;
 
         CHECK(dump == R"(<Closure> (capturing: rec)
@@ -1044,9 +1007,8 @@ Literal(42) [0:0-0:0]
         std::vector<Statement::Ptr> body;
         auto body_ptr = make_body(std::move(body));
 
-        Closure closure{
-            {},
-            body_ptr,
+        auto closure = make_closure(
+            {}, body_ptr,
             expr<If>(AST_Node::no_range,
                      node<Name_Lookup>(AST_Node::no_range, "x"),
                      node<Binop>(
@@ -1056,10 +1018,9 @@ Literal(42) [0:0-0:0]
                          node<Name_Lookup>(AST_Node::no_range, "y")),
                      std::optional<Expression::Ptr>{node<Literal>(
                          AST_Node::no_range, Value::create(0_f))}),
-            std::move(captures),
-            0};
+            std::move(captures));
 
-        const auto dump = closure.debug_dump();
+        const auto dump = closure->debug_dump();
         std::cout << dump;
 
         const auto [header, body_dump] = split_header_body(dump);
@@ -4,6 +4,7 @@
 
 #include <cctype>
 #include <filesystem>
+#include <fstream>
 #include <string>
 
 #include <frost/testing/stringmaker-specializations.hpp>
@@ -178,6 +179,29 @@ TEST_CASE("std.io stringreader")
         auto got = read_one->call({});
         CHECK(got->is<Null>());
     }
+
+    SECTION("Read some returns at most max characters")
+    {
+        auto reader_map = reader_fn->call({Value::create("abcde"s)});
+        auto read_some = get_map_fn(reader_map, "read_some");
+
+        auto first = read_some->call({Value::create(2_f)});
+        REQUIRE(first->is<String>());
+        CHECK(first->get<String>() == "ab");
+
+        auto rest = read_some->call({Value::create(100_f)});
+        REQUIRE(rest->is<String>());
+        CHECK(rest->get<String>() == "cde");
+
+        auto at_eof = read_some->call({Value::create(100_f)});
+        REQUIRE(at_eof->is<String>());
+        CHECK(at_eof->get<String>() == "");
+
+        CHECK_THROWS_MATCHES(
+            read_some->call({Value::create(0_f)}), Frost_User_Error,
+            MessageMatches(ContainsSubstring("<system closure:read_some>")
+                           && ContainsSubstring("max > 0")));
+    }
 }
 
 TEST_CASE("std.io stringwriter")
@@ -529,6 +553,39 @@ TEST_CASE("std.io open_trunc")
     }
 }
 
+TEST_CASE("std.io open_read")
+{
+    auto mod = io_module();
+    auto open_read_fn = lookup(mod, "open_read");
+
+    SECTION("Read some is not limited to the file buffer")
+    {
+        auto dir = make_test_dir("std_io_open_read_read_some");
+        auto path = unique_path(dir, "large");
+
+        const std::string contents(100'000, 'x');
+        {
+            std::ofstream out{path};
+            out << contents;
+        }
+
+        auto reader = open_read_fn->call({Value::create(path.string())});
+        auto read_some = get_map_fn(reader, "read_some");
+
+        auto first = read_some->call({Value::create(30'000_f)});
+        REQUIRE(first->is<String>());
+        CHECK(first->get<String>().value().size() == 30'000);
+
+        auto rest = read_some->call({Value::create(1'000'000_f)});
+        REQUIRE(rest->is<String>());
+        CHECK(rest->get<String>().value().size() == 70'000);
+
+        auto at_eof = read_some->call({Value::create(10_f)});
+        REQUIRE(at_eof->is<String>());
+        CHECK(at_eof->get<String>() == "");
+    }
+}
+
 TEST_CASE("std.io open_append")
 {
     auto mod = io_module();
@@ -2,9 +2,13 @@
 #include <catch2/matchers/catch_matchers_exception.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 
+#include <memory>
+#include <vector>
+
 #include <frost/testing/stringmaker-specializations.hpp>
 
 #include <frost/builtin.hpp>
+#include <frost/builtins-common.hpp>
 #include <frost/stdlib.hpp>
 #include <frost/value.hpp>
 
@@ -36,6 +40,23 @@ Function lookup(const Map& mod, const std::string& name)
     return it->second->raw_get<Function>();
 }
 
+// A reader whose read_some hands out the given chunks, then "" for EOF
+Value_Ptr chunked_reader(std::vector<std::string> chunks)
+{
+    auto remaining = std::make_shared<std::vector<std::string>>(
+        chunks.rbegin(), chunks.rend());
+    return Value::create(Map{
+        {Value::create("read_some"s),
+         system_closure([remaining](builtin_args_t) {
+             if (remaining->empty())
+                 return Value::create(""s);
+             auto chunk = std::move(remaining->back());
+             remaining->pop_back();
+             return Value::create(std::move(chunk));
+         })},
+    });
+}
+
 } // namespace
 
 TEST_CASE("std.json decode")
@@ -100,6 +121,48 @@ TEST_CASE("std.json decode")
     {
         CHECK_THROWS_AS(decode->call({Value::create("{]"s)}),
                         Frost_Recoverable_Error);
+        CHECK_THROWS_AS(decode->call({Value::create(""s)}),
+                        Frost_Recoverable_Error);
+        CHECK_THROWS_AS(decode->call({Value::create("[1] [2]"s)}),
+                        Frost_Recoverable_Error);
+    }
+
+    SECTION("Builds nested structures")
+    {
+        auto val = decode->call({Value::create(
+            R"({"b": [1, {"c": "long \u00e9scaped string"}], "a": null})"s)});
+        REQUIRE(val->is<Map>());
+        const auto& map = val->raw_get<Map>();
+        REQUIRE(map.size() == 2);
+        CHECK(map.keys().front()->get<String>() == "a");
+        CHECK(map.at(Value::create("a"s))->is<Null>());
+
+        const auto& arr = map.at(Value::create("b"s))->raw_get<Array>();
+        REQUIRE(arr.size() == 2);
+        CHECK(arr[0]->get<Int>().value() == 1_f);
+        CHECK(arr[1]->raw_get<Map>().at(Value::create("c"s))->get<String>()
+              == "long \u00e9scaped string");
+    }
+
+    SECTION("The last of a repeated key wins")
+    {
+        auto val = decode->call({Value::create(R"({"a": 1, "a": 2})"s)});
+        REQUIRE(val->is<Map>());
+        REQUIRE(val->raw_get<Map>().size() == 1);
+        CHECK(val->raw_get<Map>().at(Value::create("a"s))->get<Int>().value()
+              == 2_f);
+    }
+
+    SECTION("Repeated keys share one Value")
+    {
+        auto val = decode->call(
+            {Value::create(R"([{"id": 1, "x": 0}, {"id": 2, "x": 0}])"s)});
+        const auto& arr = val->raw_get<Array>();
+        REQUIRE(arr.size() == 2);
+        CHECK(arr[0]->raw_get<Map>().keys()[0]
+              == arr[1]->raw_get<Map>().keys()[0]);
+        CHECK(arr[0]->raw_get<Map>().keys()[1]
+              == arr[1]->raw_get<Map>().keys()[1]);
     }
 
     SECTION("Out-of-range unsigned integers are recoverable errors")
@@ -109,6 +172,97 @@ TEST_CASE("std.json decode")
     }
 }
 
+TEST_CASE("std.json decode_stream")
+{
+    auto mod = json_module();
+    auto decode_stream = lookup(mod, "decode_stream");
+
+    Array seen;
+    auto collect = system_closure([&seen](builtin_args_t args) {
+        seen.push_back(args.at(0));
+        return Value::null();
+    });
+
+    SECTION("Arity and type errors")
+    {
+        CHECK_THROWS_MATCHES(
+            decode_stream->call({}), Frost_User_Error,
+            MessageMatches(ContainsSubstring("insufficient arguments")
+                           && ContainsSubstring("requires at least 2")));
+        CHECK_THROWS_MATCHES(
+            decode_stream->call({Value::create("[]"s), collect}),
+            Frost_User_Error,
+            MessageMatches(ContainsSubstring("json.decode_stream")
+                           && ContainsSubstring("Map")
+                           && ContainsSubstring("String")));
+        CHECK_THROWS_MATCHES(
+            decode_stream->call({Value::create(Map{}), collect}),
+            Frost_User_Error,
+            MessageMatches(ContainsSubstring("read_some method")));
+    }
+
+    SECTION("Calls back once per top-level value")
+    {
+        auto result = decode_stream->call(
+            {chunked_reader({"{\"a\": 1}\n{\"a\": 2}\n", "[true, null]\n"}),
+             collect});
+        CHECK(result->is<Null>());
+
+        REQUIRE(seen.size() == 3);
+        REQUIRE(seen[0]->is<Map>());
+        CHECK(seen[0]->raw_get<Map>().size() == 1);
+        REQUIRE(seen[1]->is<Map>());
+        REQUIRE(seen[2]->is<Array>());
+        CHECK(seen[2]->raw_get<Array>().size() == 2);
+    }
+
+    SECTION("Values may span chunks")
+    {
+        decode_stream->call({chunked_reader({"{\"na", "me\": \"x\"}  1", "2",
+                                             "3\n\"s\"", "\n"}),
+                             collect});
+
+        REQUIRE(seen.size() == 3);
+        REQUIRE(seen[0]->is<Map>());
+        auto it = seen[0]->raw_get<Map>().find(Value::create("name"s));
+        REQUIRE(it != seen[0]->raw_get<Map>().end());
+        CHECK(it->second->get<String>() == "x");
+        REQUIRE(seen[1]->is<Int>());
+        CHECK(seen[1]->get<Int>().value() == 123_f);
+        REQUIRE(seen[2]->is<String>());
+        CHECK(seen[2]->get<String>() == "s");
+    }
+
+    SECTION("A value ending at EOF is still delivered")
+    {
+        decode_stream->call({chunked_reader({"1 2"}), collect});
+
+        REQUIRE(seen.size() == 2);
+        CHECK(seen[0]->get<Int>().value() == 1_f);
+        CHECK(seen[1]->get<Int>().value() == 2_f);
+    }
+
+    SECTION("Empty and whitespace-only input produce no values")
+    {
+        decode_stream->call({chunked_reader({}), collect});
+        decode_stream->call({chunked_reader({"  \n", "\n"}), collect});
+        CHECK(seen.empty());
+    }
+
+    SECTION("Parse errors are recoverable")
+    {
+        CHECK_THROWS_MATCHES(
+            decode_stream->call({chunked_reader({"[1]\n{]"}), collect}),
+            Frost_Recoverable_Error,
+            MessageMatches(ContainsSubstring("json.decode_stream")));
+        CHECK(seen.size() == 1);
+
+        CHECK_THROWS_AS(
+            decode_stream->call({chunked_reader({"[1, 2"}), collect}),
+            Frost_Recoverable_Error);
+    }
+}
+
 TEST_CASE("std.json encode")
 {
     auto mod = json_module();
@@ -161,6 +315,23 @@ TEST_CASE("std.json encode")
         CHECK(json->get<String>() == "[1,2]");
     }
 
+    SECTION("Escapes strings")
+    {
+        // Non-ASCII text is passed through as it is
+        auto json = encode->call(
+            {Value::create("a\"b\\c\nd\te\x01" "f\u00e9"s)});
+        CHECK(json->get<String>() == R"("a\"b\\c\nd\te\u0001f)" "\u00e9\""s);
+    }
+
+    SECTION("Serializes maps with their keys in order")
+    {
+        auto map = Value::create(Map{
+            {Value::create("b"s), Value::create(Array{})},
+            {Value::create("a"s), Value::create(Value::trusted, Map{})},
+        });
+        CHECK(encode->call({map})->get<String>() == R"({"a":{},"b":[]})");
+    }
+
     SECTION("Non-String Map keys are rejected")
     {
         auto map = Value::create(Map{{Value::create(1_f), Value::create(2_f)}});
@@ -207,6 +378,73 @@ TEST_CASE("std.json encode")
     }
 }
 
+TEST_CASE("std.json encode_to")
+{
+    auto mod = json_module();
+    auto encode_to = lookup(mod, "encode_to");
+
+    std::vector<std::string> chunks;
+    auto writer = Value::create(Map{
+        {Value::create("write"s),
+         system_closure([&chunks](builtin_args_t args) {
+             chunks.push_back(args.at(0)->raw_get<String>());
+             return Value::null();
+         })},
+    });
+
+    SECTION("Arity and type errors")
+    {
+        CHECK_THROWS_MATCHES(
+            encode_to->call({writer}), Frost_User_Error,
+            MessageMatches(ContainsSubstring("insufficient arguments")
+                           && ContainsSubstring("requires at least 2")));
+        CHECK_THROWS_MATCHES(
+            encode_to->call({Value::create(Map{}), Value::null()}),
+            Frost_User_Error,
+            MessageMatches(ContainsSubstring("json.encode_to")
+                           && ContainsSubstring("write method")));
+    }
+
+    SECTION("Writes the same text as encode")
+    {
+        auto map = Value::create(Map{
+            {Value::create("a"s),
+             Value::create(Array{Value::create(1_f), Value::create("x"s)})},
+        });
+        CHECK(encode_to->call({writer, map})->is<Null>());
+
+        REQUIRE(chunks.size() == 1);
+        CHECK(chunks[0] == lookup(mod, "encode")->call({map})->get<String>());
+    }
+
+    SECTION("Large values are written in several chunks")
+    {
+        Array arr;
+        for (Int i = 0; i < 100'000; ++i)
+            arr.push_back(Value::create(String(8, 'x')));
+        auto value = Value::create(std::move(arr));
+
+        encode_to->call({writer, value});
+        CHECK(chunks.size() > 1);
+
+        std::string joined;
+        for (const auto& chunk : chunks)
+            joined += chunk;
+        CHECK(joined == lookup(mod, "encode")->call({value})->get<String>());
+    }
+
+    SECTION("Unsupported values are rejected")
+    {
+        Symbol_Table table;
+        inject_builtins(table);
+        auto arr = Value::create(Array{table.lookup("len")});
+        CHECK_THROWS_MATCHES(
+            encode_to->call({writer, arr}), Frost_Recoverable_Error,
+            MessageMatches(ContainsSubstring("json.encode_to")
+                           && ContainsSubstring("Function")));
+    }
+}
+
 TEST_CASE("std.json encode_pretty")
 {
     auto mod = json_module();
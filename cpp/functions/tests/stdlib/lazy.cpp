@@ -0,0 +1,313 @@
+#include <catch2/catch_all.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+
+#include <frost/testing/stringmaker-specializations.hpp>
+
+#include <frost/builtin.hpp>
+#include <frost/stdlib.hpp>
+#include <frost/value.hpp>
+
+#include <limits>
+#include <ranges>
+#include <vector>
+
+using namespace frst;
+using namespace std::literals;
+using Catch::Matchers::ContainsSubstring;
+
+namespace
+{
+
+Map lazy_module()
+{
+    Stdlib_Registry_Builder builder;
+    register_module_lazy(builder);
+    auto registry = std::move(builder).build();
+    auto module = registry.lookup_module("std.lazy");
+    REQUIRE(module.has_value());
+    REQUIRE(module.value()->is<Map>());
+    return module.value()->raw_get<Map>();
+}
+
+Function lookup(const Map& mod, const std::string& name)
+{
+    auto key = Value::create(String{name});
+    auto it = mod.find(key);
+    REQUIRE(it != mod.end());
+    REQUIRE(it->second->is<Function>());
+    return it->second->raw_get<Function>();
+}
+
+Value_Ptr make_fn(std::function<Value_Ptr(builtin_args_t)> fn)
+{
+    return Value::create(
+        Function{std::make_shared<Builtin>(std::move(fn), "test_fn")});
+}
+
+std::vector<Int> as_ints(const Value_Ptr& value)
+{
+    REQUIRE(value->is<Array>());
+    return value->raw_get<Array>()
+           | std::views::transform([](const Value_Ptr& elem) {
+                 return elem->raw_get<Int>();
+             })
+           | std::ranges::to<std::vector>();
+}
+
+} // namespace
+
+TEST_CASE("std.lazy")
+{
+    auto mod = lazy_module();
+    auto range = lookup(mod, "range");
+    auto count = lookup(mod, "count");
+    auto iterate = lookup(mod, "iterate");
+    auto map = lookup(mod, "map");
+    auto select = lookup(mod, "select");
+    auto take = lookup(mod, "take");
+    auto drop = lookup(mod, "drop");
+    auto stride = lookup(mod, "stride");
+    auto take_while = lookup(mod, "take_while");
+    auto drop_while = lookup(mod, "drop_while");
+    auto zip = lookup(mod, "zip");
+    auto chunk = lookup(mod, "chunk");
+    auto xprod = lookup(mod, "xprod");
+    auto collect = lookup(mod, "collect");
+    auto fold = lookup(mod, "fold");
+    auto is_sequence = lookup(mod, "is_sequence");
+
+    auto collect_ints = [&](const Value_Ptr& seq) {
+        return as_ints(collect->call({seq}));
+    };
+    auto collect_rows = [&](const Value_Ptr& seq) {
+        auto rows = collect->call({seq});
+        REQUIRE(rows->is<Array>());
+        return rows->raw_get<Array>()
+               | std::views::transform(as_ints)
+               | std::ranges::to<std::vector>();
+    };
+
+    SECTION("range matches the eager range")
+    {
+        CHECK(collect_ints(range->call({Value::create(5_f)}))
+              == std::vector<Int>{0, 1, 2, 3, 4});
+        CHECK(collect_ints(
+                  range->call({Value::create(2_f), Value::create(5_f)}))
+              == std::vector<Int>{2, 3, 4});
+        CHECK(collect_ints(range->call({Value::create(0_f), Value::create(10_f),
+                                        Value::create(3_f)}))
+              == std::vector<Int>{0, 3, 6, 9});
+        CHECK(collect_ints(range->call({Value::create(5_f), Value::create(0_f),
+                                        Value::create(-2_f)}))
+              == std::vector<Int>{5, 3, 1});
+        CHECK(collect_ints(range->call({Value::create(-3_f)})).empty());
+        CHECK_THROWS_WITH(range->call({Value::create(0_f), Value::create(1_f),
+                                       Value::create(0_f)}),
+                          ContainsSubstring("step != 0"));
+    }
+
+    SECTION("range stops at the end of Int instead of wrapping")
+    {
+        constexpr auto max = std::numeric_limits<Int>::max();
+        CHECK(collect_ints(range->call({Value::create(Int{max - 2}),
+                                        Value::create(Int{max}),
+                                        Value::create(5_f)}))
+              == std::vector<Int>{max - 2});
+    }
+
+    SECTION("Calling a sequence collects it, as often as asked")
+    {
+        auto seq = range->call({Value::create(3_f)});
+        REQUIRE(seq->is<Function>());
+        CHECK(as_ints(seq->raw_get<Function>()->call({}))
+              == std::vector<Int>{0, 1, 2});
+        CHECK(as_ints(seq->raw_get<Function>()->call({}))
+              == std::vector<Int>{0, 1, 2});
+        CHECK(is_sequence->call({seq})->truthy());
+        CHECK_FALSE(is_sequence->call({Value::create(Array{})})->truthy());
+        CHECK_FALSE(is_sequence->call({Value::create(
+                                          Function{collect})})->truthy());
+    }
+
+    SECTION("Only as many elements are pulled as needed")
+    {
+        Int calls = 0;
+        auto is_even = make_fn([&](builtin_args_t args) {
+            ++calls;
+            return Value::create(args[0]->raw_get<Int>() % 2 == 0);
+        });
+
+        auto seq = range->call({Value::create(100'000'000_f)});
+        seq = select->call({seq, is_even});
+        seq = take->call({seq, Value::create(3_f)});
+        CHECK(calls == 0);
+
+        CHECK(collect_ints(seq) == std::vector<Int>{0, 2, 4});
+        CHECK(calls == 5);
+    }
+
+    SECTION("Endless sequences")
+    {
+        auto twice = make_fn([](builtin_args_t args) {
+            return Value::create(args[0]->raw_get<Int>() * 2);
+        });
+
+        CHECK(collect_ints(take->call({count->call({}), Value::create(3_f)}))
+              == std::vector<Int>{0, 1, 2});
+        CHECK(collect_ints(take->call(
+                  {count->call({Value::create(10_f)}), Value::create(2_f)}))
+              == std::vector<Int>{10, 11});
+        CHECK(collect_ints(take->call(
+                  {iterate->call({Value::create(1_f), twice}),
+                   Value::create(5_f)}))
+              == std::vector<Int>{1, 2, 4, 8, 16});
+    }
+
+    SECTION("Adaptors")
+    {
+        auto seq = range->call({Value::create(10_f)});
+        auto twice = make_fn([](builtin_args_t args) {
+            return Value::create(args[0]->raw_get<Int>() * 2);
+        });
+        auto below_4 = make_fn([](builtin_args_t args) {
+            return Value::create(args[0]->raw_get<Int>() < 4);
+        });
+
+        CHECK(collect_ints(map->call({seq, twice}))
+              == std::vector<Int>{0, 2, 4, 6, 8, 10, 12, 14, 16, 18});
+        CHECK(collect_ints(drop->call({seq, Value::create(7_f)}))
+              == std::vector<Int>{7, 8, 9});
+        CHECK(collect_ints(take->call({seq, Value::create(0_f)})).empty());
+        CHECK(collect_ints(stride->call({seq, Value::create(4_f)}))
+              == std::vector<Int>{0, 4, 8});
+        CHECK(collect_ints(take_while->call({seq, below_4}))
+              == std::vector<Int>{0, 1, 2, 3});
+        CHECK(collect_ints(drop_while->call({seq, below_4}))
+              == std::vector<Int>{4, 5, 6, 7, 8, 9});
+    }
+
+    SECTION("zip stops at the shortest sequence")
+    {
+        using Rows = std::vector<std::vector<Int>>;
+
+        CHECK(collect_rows(zip->call({range->call({Value::create(3_f)}),
+                                      count->call({Value::create(10_f)})}))
+              == Rows{{0, 10}, {1, 11}, {2, 12}});
+        CHECK(collect_rows(zip->call({count->call({}), count->call({}),
+                                      range->call({Value::create(2_f)})}))
+              == Rows{{0, 0, 0}, {1, 1, 1}});
+        CHECK(collect_rows(take->call(
+                  {zip->call({count->call({}), count->call({})}),
+                   Value::create(2_f)}))
+              == Rows{{0, 0}, {1, 1}});
+        CHECK(collect_rows(zip->call(
+                  {range->call({Value::create(0_f)}), count->call({})}))
+                  .empty());
+    }
+
+    SECTION("zip pulls no further than the shortest sequence")
+    {
+        Int calls = 0;
+        auto counted = make_fn([&](builtin_args_t args) {
+            ++calls;
+            return args[0];
+        });
+
+        (void)collect->call({zip->call(
+            {range->call({Value::create(3_f)}),
+             map->call({count->call({}), counted})})});
+        CHECK(calls == 3);
+    }
+
+    SECTION("chunk")
+    {
+        using Rows = std::vector<std::vector<Int>>;
+
+        CHECK(collect_rows(chunk->call({range->call({Value::create(7_f)}),
+                                        Value::create(3_f)}))
+              == Rows{{0, 1, 2}, {3, 4, 5}, {6}});
+        CHECK(collect_rows(chunk->call({range->call({Value::create(4_f)}),
+                                        Value::create(2_f)}))
+              == Rows{{0, 1}, {2, 3}});
+        CHECK(collect_rows(chunk->call({range->call({Value::create(0_f)}),
+                                        Value::create(2_f)}))
+                  .empty());
+        CHECK(collect_rows(take->call(
+                  {chunk->call({count->call({}), Value::create(2_f)}),
+                   Value::create(2_f)}))
+              == Rows{{0, 1}, {2, 3}});
+    }
+
+    SECTION("xprod")
+    {
+        using Rows = std::vector<std::vector<Int>>;
+
+        auto arr = Value::create(Array{Value::create(1_f), Value::create(2_f)});
+        CHECK(collect_rows(xprod->call({arr, range->call({Value::create(2_f)}),
+                                        Value::create(Array{
+                                            Value::create(9_f)})}))
+              == Rows{{1, 0, 9}, {1, 1, 9}, {2, 0, 9}, {2, 1, 9}});
+        CHECK(collect_rows(xprod->call({arr, Value::create(Array{})}))
+                  .empty());
+        CHECK(collect_rows(take->call(
+                  {xprod->call({count->call({}), arr}), Value::create(3_f)}))
+              == Rows{{0, 1}, {0, 2}, {1, 1}});
+    }
+
+    SECTION("take_while calls its predicate once per element")
+    {
+        Int calls = 0;
+        auto below_4 = make_fn([&](builtin_args_t args) {
+            ++calls;
+            return Value::create(args[0]->raw_get<Int>() < 4);
+        });
+
+        (void)collect->call(
+            {take_while->call({range->call({Value::create(10_f)}), below_4})});
+        CHECK(calls == 5);
+    }
+
+    SECTION("Arrays are accepted as sequences")
+    {
+        auto arr = Value::create(
+            Array{Value::create(1_f), Value::create(2_f), Value::create(3_f)});
+        CHECK(collect_ints(drop->call({arr, Value::create(1_f)}))
+              == std::vector<Int>{2, 3});
+        CHECK(collect_ints(arr) == std::vector<Int>{1, 2, 3});
+    }
+
+    SECTION("fold")
+    {
+        auto plus = make_fn([](builtin_args_t args) {
+            return Value::create(args[0]->raw_get<Int>()
+                                 + args[1]->raw_get<Int>());
+        });
+        auto seq = range->call({Value::create(1_f), Value::create(101_f)});
+
+        CHECK(fold->call({seq, plus})->raw_get<Int>() == 5050);
+        CHECK(fold->call({seq, plus, Value::create(10_f)})->raw_get<Int>()
+              == 5060);
+        CHECK(fold->call({range->call({Value::create(0_f)}), plus})
+                  ->is<Null>());
+    }
+
+    SECTION("Errors")
+    {
+        CHECK_THROWS_WITH(take->call({Value::create(1_f), Value::create(1_f)}),
+                          ContainsSubstring("lazy sequence or Array"));
+        CHECK_THROWS_WITH(
+            take->call({Value::create(Function{collect}), Value::create(1_f)}),
+            ContainsSubstring("lazy sequence or Array"));
+        auto empty = Value::create(Array{});
+        CHECK_THROWS_AS(take->call({empty, Value::create(-1_f)}),
+                        Frost_User_Error);
+        CHECK_THROWS_AS(stride->call({empty, Value::create(0_f)}),
+                        Frost_User_Error);
+        CHECK_THROWS_AS(chunk->call({empty, Value::create(0_f)}),
+                        Frost_User_Error);
+        CHECK_THROWS_AS(zip->call({empty}), Frost_User_Error);
+        CHECK_THROWS_AS(xprod->call({empty}), Frost_User_Error);
+        CHECK_THROWS_WITH(zip->call({empty, Value::create(1_f)}),
+                          ContainsSubstring("lazy sequence or Array"));
+    }
+}
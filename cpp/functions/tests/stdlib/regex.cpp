@@ -52,7 +52,8 @@ TEST_CASE("std.regex")
 
     SECTION("Registered in module")
     {
-        CHECK(mod.size() == 7);
+        CHECK(mod.size() == 8);
+        REQUIRE(get_re_fn("compile"));
 
         for (const auto& name : names)
             REQUIRE(get_re_fn(name));
@@ -634,4 +635,109 @@ TEST_CASE("std.regex")
         CHECK(get_field(n1_map, "matched")->get<Bool>().value());
         CHECK(get_field(n1_map, "value")->raw_get<String>() == "1");
     }
+
+    SECTION("Compile")
+    {
+        auto compile = get_re_fn("compile");
+
+        auto method = [](const Value_Ptr& obj, const std::string& name) {
+            REQUIRE(obj->is<Map>());
+            const auto& map = obj->raw_get<Map>();
+            auto it = map.find(Value::create(String{name}));
+            REQUIRE(it != map.end());
+            REQUIRE(it->second->is<Function>());
+            return it->second->raw_get<Function>();
+        };
+
+        auto re = compile->call({Value::create(R"((\d+))"s)});
+        REQUIRE(re->is<Map>());
+
+        auto pattern = re->raw_get<Map>().find(Value::create("pattern"s));
+        REQUIRE(pattern != re->raw_get<Map>().end());
+        CHECK(pattern->second->raw_get<String>() == R"((\d+))");
+
+        CHECK(method(re, "matches")
+                  ->call({Value::create("123"s)})
+                  ->get<Bool>()
+                  .value());
+        CHECK_FALSE(method(re, "matches")
+                        ->call({Value::create("a123"s)})
+                        ->get<Bool>()
+                        .value());
+        CHECK(method(re, "contains")
+                  ->call({Value::create("a123"s)})
+                  ->get<Bool>()
+                  .value());
+        CHECK(method(re, "replace")
+                  ->call({Value::create("a1b22"s), Value::create("<$1>"s)})
+                  ->raw_get<String>()
+              == "a<1>b<22>");
+        CHECK(method(re, "replace_first")
+                  ->call({Value::create("a1b22"s), Value::create("#"s)})
+                  ->raw_get<String>()
+              == "a#b22");
+
+        auto split = method(re, "split")->call({Value::create("a1b22c"s)});
+        REQUIRE(split->is<Array>());
+        const auto& parts = split->raw_get<Array>();
+        REQUIRE(parts.size() == 3);
+        CHECK(parts.at(0)->raw_get<String>() == "a");
+        CHECK(parts.at(1)->raw_get<String>() == "b");
+        CHECK(parts.at(2)->raw_get<String>() == "c");
+
+        auto scan =
+            method(re, "scan_matches")->call({Value::create("a1b22"s)});
+        REQUIRE(scan->is<Map>());
+        auto count = scan->raw_get<Map>().find(Value::create("count"s));
+        REQUIRE(count != scan->raw_get<Map>().end());
+        CHECK(count->second->raw_get<Int>() == 2);
+
+        SECTION("Reusing a compiled regex gives the same results")
+        {
+            auto matches = method(re, "matches");
+            for (int i = 0; i < 3; ++i)
+            {
+                CHECK(matches->call({Value::create("42"s)})
+                          ->get<Bool>()
+                          .value());
+            }
+        }
+
+        SECTION("Flags")
+        {
+            auto icase = compile->call(
+                {Value::create("hello"s), Value::create("i"s)});
+            CHECK(method(icase, "matches")
+                      ->call({Value::create("HeLLo"s)})
+                      ->get<Bool>()
+                      .value());
+
+            // The same pattern without flags must not share the cached
+            // case-insensitive regex
+            auto plain = compile->call({Value::create("hello"s)});
+            CHECK_FALSE(method(plain, "matches")
+                            ->call({Value::create("HeLLo"s)})
+                            ->get<Bool>()
+                            .value());
+            CHECK_FALSE(get_re_fn("matches")
+                            ->call({Value::create("HeLLo"s),
+                                    Value::create("hello"s)})
+                            ->get<Bool>()
+                            .value());
+        }
+
+        SECTION("Errors")
+        {
+            CHECK_THROWS_MATCHES(compile->call({Value::create("("s)}),
+                                 Frost_User_Error,
+                                 MessageMatches(StartsWith("Regex error: ")));
+            CHECK_THROWS_WITH(
+                compile->call({Value::create("a"s), Value::create("q"s)}),
+                ContainsSubstring("unknown flag 'q'"));
+            CHECK_THROWS_WITH(
+                method(re, "matches")->call({Value::create(1_f)}),
+                ContainsSubstring("compiled_regex.matches")
+                    && ContainsSubstring("got Int"));
+        }
+    }
 }
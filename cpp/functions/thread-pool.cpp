@@ -0,0 +1,164 @@
+#include <frost/thread-pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <memory>
+
+using namespace frst;
+
+namespace
+{
+
+// Shared between the caller of for_chunks and the helpers it queues, which
+// may only get to run after the call is over
+struct Chunked_Job
+{
+    static constexpr auto no_failure = std::numeric_limits<std::size_t>::max();
+
+    Chunked_Job(Thread_Pool::Chunk_Body body, std::size_t count,
+                std::size_t chunk_size)
+        : body{std::move(body)}
+        , count{count}
+        , chunk_size{chunk_size}
+        , chunk_count{(count + chunk_size - 1) / chunk_size}
+        , errors(chunk_count)
+    {
+    }
+
+    Thread_Pool::Chunk_Body body;
+    std::size_t count;
+    std::size_t chunk_size;
+    std::size_t chunk_count;
+
+    std::atomic<std::size_t> next_chunk = 0;
+    std::atomic<std::size_t> first_failure = no_failure;
+    std::vector<std::exception_ptr> errors;
+
+    std::mutex mutex;
+    std::condition_variable done;
+    std::size_t finished = 0;
+
+    // Claim and run chunks until none are left
+    void run()
+    {
+        for (auto chunk = next_chunk++; chunk < chunk_count;
+             chunk = next_chunk++)
+        {
+            if (chunk < first_failure)
+                run_chunk(chunk);
+
+            std::lock_guard lock{mutex};
+            if (++finished == chunk_count)
+                done.notify_all();
+        }
+    }
+
+    void run_chunk(std::size_t chunk)
+    {
+        try
+        {
+            const auto begin = chunk * chunk_size;
+            body(begin, std::min(count, begin + chunk_size));
+        }
+        catch (...)
+        {
+            errors[chunk] = std::current_exception();
+
+            auto seen = first_failure.load();
+            while (chunk < seen
+                   && not first_failure.compare_exchange_weak(seen, chunk))
+            {
+            }
+        }
+    }
+};
+
+} // namespace
+
+Thread_Pool::Thread_Pool(std::size_t thread_count)
+{
+    workers_.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; ++i)
+        workers_.emplace_back([queue = queue_](std::stop_token stop) {
+            work(queue, std::move(stop));
+        });
+}
+
+Thread_Pool::~Thread_Pool()
+{
+    for (auto& worker : workers_)
+    {
+        worker.request_stop();
+
+        // A thread cannot join itself. This worker goes on to finish its job
+        // and whatever else is queued, then finds the stop request.
+        if (worker.get_id() == std::this_thread::get_id())
+            worker.detach();
+    }
+}
+
+void Thread_Pool::post(Job job)
+{
+    {
+        std::lock_guard lock{queue_->mutex};
+        queue_->jobs.push(std::move(job));
+    }
+    queue_->ready.notify_one();
+}
+
+void Thread_Pool::for_chunks(std::size_t count, std::size_t chunk_size,
+                             Chunk_Body body)
+{
+    if (count == 0)
+        return;
+
+    chunk_size = std::max<std::size_t>(chunk_size, 1);
+
+    auto job =
+        std::make_shared<Chunked_Job>(std::move(body), count, chunk_size);
+
+    const auto helpers = std::min(size(), job->chunk_count - 1);
+    for (std::size_t i = 0; i < helpers; ++i)
+        post([job] { job->run(); });
+
+    job->run();
+
+    {
+        std::unique_lock lock{job->mutex};
+        job->done.wait(lock, [&] { return job->finished == job->chunk_count; });
+    }
+
+    if (job->first_failure != Chunked_Job::no_failure)
+        std::rethrow_exception(job->errors[job->first_failure]);
+}
+
+Thread_Pool& Thread_Pool::shared()
+{
+    static Thread_Pool pool{std::max(1u, std::thread::hardware_concurrency())};
+    return pool;
+}
+
+void Thread_Pool::work(const std::shared_ptr<Queue>& queue,
+                       std::stop_token stop)
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock lock{queue->mutex};
+
+            // Once stopped, carry on until the queue is drained
+            queue->ready.wait(lock, stop, [&] {
+                return not queue->jobs.empty();
+            });
+            if (queue->jobs.empty())
+                return;
+
+            job = std::move(queue->jobs.front());
+            queue->jobs.pop();
+        }
+        job();
+    }
+}
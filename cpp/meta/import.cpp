@@ -36,6 +36,11 @@ std::vector<std::filesystem::path> env_module_path()
 namespace
 {
 
+std::string describe_import(const std::string& module_spec)
+{
+    return fmt::format("Import Boundary ({})", module_spec);
+}
+
 struct Importer
 {
     import::search_path_t search_path;
@@ -124,7 +129,7 @@ struct Importer
                 import_cache->erase(module_file);
         };
 
-        auto guard = make_frame_guard("Import Boundary ({})", module_spec);
+        auto guard = make_frame_guard<describe_import>(module_spec);
 
         auto parse_result = parse_file(module_file);
 
@@ -7,6 +7,8 @@
 #include <frost/testing/stringmaker-specializations.hpp>
 #include <frost/value.hpp>
 
+#include <vector>
+
 using namespace frst::literals;
 
 TEST_CASE("Parser Reduce Expressions")
@@ -474,3 +476,66 @@ TEST_CASE("Parser Reduce Expressions")
         CHECK(range.end.column == 34);
     }
 }
+
+TEST_CASE("Reduce growing an Array accumulator")
+{
+    auto evaluate = [](std::string_view input) {
+        auto result = frst::parse_data(std::string{input});
+        REQUIRE(result.has_value());
+        auto expr = std::move(result).value();
+
+        frst::Symbol_Table table;
+        frst::Evaluation_Context ctx{.symbols = table};
+        return expr->evaluate(ctx);
+    };
+
+    auto ints = [](const frst::Value_Ptr& value) {
+        REQUIRE(value->is<frst::Array>());
+        std::vector<frst::Int> out;
+        for (const auto& elem : value->raw_get<frst::Array>())
+            out.push_back(elem->get<frst::Int>().value());
+        return out;
+    };
+
+    SECTION("Only the first parameter plus brackets is grown in place")
+    {
+        auto appends = evaluate("fn (acc, x) -> acc + [x * 2, x]");
+        REQUIRE(appends->is<frst::Function>());
+        CHECK(appends->raw_get<frst::Function>()->appends_to_first_argument());
+
+        auto uses_acc = evaluate("fn (acc, x) -> acc + [acc]");
+        CHECK_FALSE(
+            uses_acc->raw_get<frst::Function>()->appends_to_first_argument());
+
+        auto other_param = evaluate("fn (acc, x) -> x + [acc]");
+        CHECK_FALSE(other_param->raw_get<frst::Function>()
+                        ->appends_to_first_argument());
+    }
+
+    SECTION("Matches concatenating on every call")
+    {
+        CHECK(ints(evaluate("reduce [1, 2, 3] init: [0] "
+                            "with fn (acc, x) -> acc + [x * 2, x]"))
+              == std::vector<frst::Int>{0, 2, 1, 4, 2, 6, 3});
+        CHECK(ints(evaluate("reduce [] init: [7] "
+                            "with fn (acc, x) -> acc + [x]"))
+              == std::vector<frst::Int>{7});
+    }
+
+    SECTION("Brackets that use the accumulator see every step")
+    {
+        auto nested =
+            evaluate("reduce [1, 2] init: [] with fn (acc, x) -> acc + [acc]");
+        REQUIRE(nested->is<frst::Array>());
+        const auto& outer = nested->raw_get<frst::Array>();
+        REQUIRE(outer.size() == 2);
+        CHECK(outer[0]->raw_get<frst::Array>().empty());
+        CHECK(outer[1]->raw_get<frst::Array>().size() == 1);
+    }
+
+    SECTION("A non-Array init still fails as + does")
+    {
+        CHECK_THROWS(
+            evaluate("reduce [1] init: 'a' with fn (acc, x) -> acc + [x]"));
+    }
+}
@@ -10,6 +10,10 @@ Value_Ptr Value::clone() const
         Overload{[](const Null&) {
                      return Value::null();
                  },
+                 [](const Int& value) -> Value_Ptr {
+                     // Bypass the small Int cache, a clone never aliases
+                     return std::make_shared<Value>(value);
+                 },
                  [](const Frost_Primitive auto& value) {
                      return Value::create(auto{value});
                  },
@@ -25,11 +29,20 @@ Value_Ptr Value::clone() const
                          | std::ranges::to<Array>());
                  },
                  [](const Map& value) {
-                     Map acc;
+                     // Clones order just like the originals, so the keys
+                     // can be handed over already sorted
+                     Map::key_container_type keys;
+                     Map::mapped_container_type values;
+                     keys.reserve(value.size());
+                     values.reserve(value.size());
                      for (const auto& [k, v] : value)
                      {
-                         acc.emplace(k->clone(), v->clone());
+                         keys.push_back(k->clone());
+                         values.push_back(v->clone());
                      }
-                     return Value::create(Value::trusted, std::move(acc));
+                     return Value::create(Value::trusted,
+                                          Map{std::sorted_unique,
+                                              std::move(keys),
+                                              std::move(values)});
                  }});
 }
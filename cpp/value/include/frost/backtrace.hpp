@@ -2,9 +2,9 @@
 #define FROST_BACKTRACE_HPP
 
 #include <algorithm>
-#include <optional>
 #include <ranges>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <fmt/format.h>
@@ -12,6 +12,22 @@
 namespace frst
 {
 
+//! @brief One frame of a backtrace, as recorded while running
+//!
+//! Recording a frame costs two pointers: what the frame is about, and how to
+//! describe it. Describing it only happens if a snapshot is ever captured,
+//! while the subject is still alive.
+struct Backtrace_Frame
+{
+    std::string (*describe)(const void* subject);
+    const void* subject;
+
+    std::string to_string() const
+    {
+        return describe(subject);
+    }
+};
+
 class Backtrace_State
 {
   public:
@@ -20,9 +36,9 @@ class Backtrace_State
         frames_.reserve(256);
     }
 
-    void push(std::string frame)
+    void push(Backtrace_Frame frame)
     {
-        frames_.push_back(std::move(frame));
+        frames_.push_back(frame);
     }
     void pop()
     {
@@ -33,6 +49,7 @@ class Backtrace_State
     {
         return frames_
                | std::views::reverse
+               | std::views::transform(&Backtrace_Frame::to_string)
                | std::ranges::to<std::vector<std::string>>();
     }
 
@@ -46,18 +63,19 @@ class Backtrace_State
     }
 
   private:
-    std::vector<std::string> frames_;
+    std::vector<Backtrace_Frame> frames_;
     static inline thread_local Backtrace_State* current_state_ = nullptr;
 };
 
 class Frame_Guard
 {
   public:
-    Frame_Guard(Backtrace_State* state, std::string frame)
+    // A null state records nothing
+    Frame_Guard(Backtrace_State* state, Backtrace_Frame frame)
         : state_{state}
     {
         if (state_)
-            state_->push(std::move(frame));
+            state_->push(frame);
     }
 
     Frame_Guard(const Frame_Guard&) = delete;
@@ -79,14 +97,22 @@ class Frame_Guard
     Backtrace_State* state_;
 };
 
-template <typename... Ts>
-std::optional<Frame_Guard> make_frame_guard(fmt::format_string<Ts...> fmt,
-                                            Ts&&... args)
+//! @brief Record a frame about `subject` for as long as the guard lives
+//!
+//! `Describe` is a function taking `const Subject&` and producing the frame's
+//! text. The subject must outlive the guard.
+template <auto Describe, typename Subject>
+Frame_Guard make_frame_guard(const Subject& subject)
 {
-    auto* bt = Backtrace_State::current();
-    if (!bt)
-        return std::nullopt;
-    return Frame_Guard{bt, fmt::format(fmt, std::forward<Ts>(args)...)};
+    return Frame_Guard{
+        Backtrace_State::current(),
+        Backtrace_Frame{
+            .describe = [](const void* s) -> std::string {
+                return Describe(*static_cast<const Subject*>(s));
+            },
+            .subject = &subject,
+        },
+    };
 }
 
 } // namespace frst
@@ -0,0 +1,74 @@
+#ifndef FROST_MAP_BUILDER_HPP
+#define FROST_MAP_BUILDER_HPP
+
+#include "types.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace frst
+{
+
+//! @brief Collects Map entries in any order, then builds the Map in one go
+//!
+//! Inserting into a flat_map out of order shifts both of its containers, so
+//! building a large Map one key at a time is quadratic. The builder instead
+//! sorts all of its entries once, and hands them over with sorted_unique.
+class Map_Builder
+{
+  public:
+    void reserve(std::size_t size)
+    {
+        entries_.reserve(size);
+    }
+
+    void add(Value_Ptr key, Value_Ptr value)
+    {
+        entries_.emplace_back(std::move(key), std::move(value));
+    }
+
+    // Keeps the first value added for each key, as try_emplace would
+    Map build() &&
+    {
+        return std::move(*this).build([](const Value_Ptr&) {});
+    }
+
+    // As above, but calls on_duplicate(key) for every entry dropped because
+    // its key was already added, which may throw to reject it
+    template <typename On_Duplicate>
+    Map build(On_Duplicate&& on_duplicate) &&
+    {
+        constexpr auto less = Map::key_compare{};
+
+        std::ranges::stable_sort(entries_, less, &Entry::first);
+
+        Map::key_container_type keys;
+        Map::mapped_container_type values;
+        keys.reserve(entries_.size());
+        values.reserve(entries_.size());
+
+        for (auto& [key, value] : entries_)
+        {
+            // Sorted, so a repeated key is always right after the first
+            if (not keys.empty() && not less(keys.back(), key))
+            {
+                on_duplicate(key);
+                continue;
+            }
+            keys.push_back(std::move(key));
+            values.push_back(std::move(value));
+        }
+        entries_.clear();
+
+        return Map{std::sorted_unique, std::move(keys), std::move(values)};
+    }
+
+  private:
+    using Entry = std::pair<Value_Ptr, Value_Ptr>;
+    std::vector<Entry> entries_;
+};
+
+} // namespace frst
+
+#endif
@@ -49,6 +49,23 @@ class Callable
     virtual Value_Ptr call(std::span<const Value_Ptr> args) const = 0;
     virtual std::string debug_dump() const = 0;
     virtual std::string name() const = 0;
+
+    //! @brief Whether every call adds elements to an Array first argument
+    //!
+    //! That is, call(args) is always args[0] + appended_elements(args) when
+    //! args[0] is an Array, as with fn acc, x -> acc + [x]. A reduction can
+    //! then grow one Array instead of copying it on every call.
+    virtual bool appends_to_first_argument() const
+    {
+        return false;
+    }
+
+    // The Array of elements call(args) would add, without looking at args[0].
+    // Only called when appends_to_first_argument().
+    virtual Value_Ptr appended_elements(std::span<const Value_Ptr>) const
+    {
+        return nullptr;
+    }
 };
 
 using Function = std::shared_ptr<const Callable>;
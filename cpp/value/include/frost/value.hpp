@@ -1,6 +1,7 @@
 #ifndef FROST_VALUE_HPP
 #define FROST_VALUE_HPP
 
+#include <array>
 #include <cassert>
 #include <memory>
 #include <optional>
@@ -151,6 +152,33 @@ class Value
             return false_singleton_;
     }
 
+    // Small Ints are by far the most common arithmetic results (counters,
+    // indices, accumulators), so like Null and the Bools, each has a single
+    // shared Value rather than an allocation per result
+    constexpr static Int small_int_min = -128;
+    constexpr static Int small_int_max = 1023;
+
+    [[nodiscard]] static Value_Ptr create(Int i)
+    {
+        if (i >= small_int_min && i <= small_int_max)
+            return small_ints()[i - small_int_min];
+        return std::make_shared<Value>(i);
+    }
+
+    // The operators build their result as a Value first. A Value can't hold a
+    // Null or Bool outside the singletons, so only Ints need mapping here
+    [[nodiscard]] static Value_Ptr create(Value&& value)
+    {
+        if (const auto* i = std::get_if<Int>(&value.value_))
+            return create(*i);
+        return std::make_shared<Value>(std::move(value));
+    }
+
+    [[nodiscard]] static Value_Ptr create(int i)
+    {
+        return create(Int{i});
+    }
+
     //! @brief Check if a Value is a particular type
     template <Frost_Type T>
     [[nodiscard]] bool is() const
@@ -334,6 +362,22 @@ class Value
         std::make_shared<Value>(singleton_tag, true);
     static inline Value_Ptr false_singleton_ =
         std::make_shared<Value>(singleton_tag, false);
+
+    using Small_Ints =
+        std::array<Value_Ptr, small_int_max - small_int_min + 1>;
+
+    // Function-local, so it is ready for values created during static
+    // initialization too
+    static const Small_Ints& small_ints()
+    {
+        static const Small_Ints cache = [] {
+            Small_Ints ints;
+            for (Int i = small_int_min; i <= small_int_max; ++i)
+                ints[i - small_int_min] = std::make_shared<Value>(i);
+            return ints;
+        }();
+        return cache;
+    }
 };
 
 inline namespace literals
@@ -1,3 +1,4 @@
+#include <frost/map-builder.hpp>
 #include <frost/value.hpp>
 
 #include <algorithm>
@@ -33,7 +34,8 @@ Value_Ptr map_map(const Value_Ptr& map_val, const Function& op,
     if (map.empty())
         return map_val;
 
-    Map acc;
+    Map_Builder acc;
+    acc.reserve(map.size());
     for (const auto& [k, v] : map)
     {
         auto intermediate_val = op->call({k, v});
@@ -45,22 +47,16 @@ Value_Ptr map_map(const Value_Ptr& map_val, const Function& op,
                 parent_op_name, intermediate_val->type_name())};
         }
 
-        const Map& intermediate = intermediate_val->raw_get<Map>();
-
-        for (const auto& [i_k, i_v] : intermediate)
-        {
-            auto [_, ok] = acc.insert({i_k, i_v});
-
-            if (not ok)
-            {
-                throw Frost_Recoverable_Error(
-                    fmt::format("{} operation key collision with key: {}",
-                                parent_op_name, i_k->to_internal_string()));
-            }
-        }
+        for (const auto& [i_k, i_v] : intermediate_val->raw_get<Map>())
+            acc.add(i_k, i_v);
     }
 
-    return Value::create(Value::trusted, std::move(acc));
+    return Value::create(
+        Value::trusted, std::move(acc).build([&](const Value_Ptr& key) {
+            throw Frost_Recoverable_Error(
+                fmt::format("{} operation key collision with key: {}",
+                            parent_op_name, key->to_internal_string()));
+        }));
 }
 
 Value_Ptr filter_map(const Map& map, const Function& pred)
@@ -101,10 +97,21 @@ Value_Ptr reduce_array(const Array& arr, const Function& op,
         return std::ranges::fold_left_first(arr, reduction)
             .value_or(Value::null());
     }
-    else
+
+    // As with fn acc, x -> acc + [x]: one Array is grown, rather than a new
+    // one built from the accumulator on every call
+    if ((*init)->is<Array>() && op->appends_to_first_argument())
     {
-        return std::ranges::fold_left(arr, *init, reduction);
+        Array acc = (*init)->raw_get<Array>();
+        for (const auto& elem : arr)
+        {
+            const auto added = op->appended_elements({Value::null(), elem});
+            acc.append_range(added->raw_get<Array>());
+        }
+        return Value::create(std::move(acc));
     }
+
+    return std::ranges::fold_left(arr, *init, reduction);
 }
 
 Value_Ptr reduce_map(const Map& arr, const Function& op,
@@ -81,6 +81,8 @@ struct Add_Impl
     {
         return lhs + rhs;
     }
+    // Both sides are copied, as either may be shared. A reduction by
+    // fn acc, x -> acc + [...] never gets here: see reduce_array.
     static Value operator()(const Array& lhs, const Array& rhs)
     {
         return std::views::concat(lhs, rhs) | std::ranges::to<Array>();
@@ -98,6 +100,23 @@ struct Add_Impl
 
 Value_Ptr Value::add(const Value_Ptr& lhs, const Value_Ptr& rhs)
 {
+    // Values are immutable, so adding an empty collection can share the other
+    // side rather than copy it
+    const auto is_empty = [](const Value_Ptr& val) {
+        if (val->is<Array>())
+            return val->raw_get<Array>().empty();
+        if (val->is<Map>())
+            return val->raw_get<Map>().empty();
+        return false;
+    };
+    if (lhs->value_.index() == rhs->value_.index())
+    {
+        if (is_empty(rhs))
+            return lhs;
+        if (is_empty(lhs))
+            return rhs;
+    }
+
     return Value::create(std::visit(add_impl, lhs->value_, rhs->value_));
 }
 
@@ -125,6 +125,8 @@ TEST_CASE("Array Concat")
     SECTION("ARR + EMPTY")
     {
         auto res = Value::add(arr1, empty);
+        // Nothing is added, so the result shares the other side
+        CHECK(res == arr1);
         REQUIRE(res->is<frst::Array>());
         auto bare_res = res->get<frst::Array>();
         REQUIRE(bare_res->size() == 3);
@@ -138,6 +140,8 @@ TEST_CASE("Array Concat")
     SECTION("EMPTY + ARR")
     {
         auto res = Value::add(empty, arr1);
+        // Nothing is added, so the result shares the other side
+        CHECK(res == arr1);
         REQUIRE(res->is<frst::Array>());
         auto bare_res = res->get<frst::Array>();
         REQUIRE(bare_res->size() == 3);
@@ -229,6 +233,8 @@ TEST_CASE("Map Union")
     SECTION("EMPTY + MAP")
     {
         auto res = Value::add(empty, map1);
+        // Nothing is added, so the result shares the other side
+        CHECK(res == map1);
 
         CHECK(res->get<frst::Map>()->size() == 3);
         for (const auto& [k, v] : *res->get<frst::Map>())
@@ -247,6 +253,8 @@ TEST_CASE("Map Union")
     SECTION("MAP + EMPTY")
     {
         auto res = Value::add(map1, empty);
+        // Nothing is added, so the result shares the other side
+        CHECK(res == map1);
 
         CHECK(res->get<frst::Map>()->size() == 3);
         for (const auto& [k, v] : *res->get<frst::Map>())
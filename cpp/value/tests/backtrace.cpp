@@ -0,0 +1,84 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+#include <frost/backtrace.hpp>
+#include <frost/value.hpp>
+
+using namespace frst;
+using namespace std::literals;
+
+namespace
+{
+struct Subject
+{
+    std::string name;
+    mutable int times_described = 0;
+};
+
+std::string describe(const Subject& subject)
+{
+    ++subject.times_described;
+    return "At " + subject.name;
+}
+
+// Install a state for the duration of a test
+struct Scoped_State
+{
+    Backtrace_State state;
+
+    Scoped_State()
+    {
+        Backtrace_State::set_current(&state);
+    }
+
+    ~Scoped_State()
+    {
+        Backtrace_State::set_current(nullptr);
+    }
+};
+} // namespace
+
+TEST_CASE("Backtrace frames are described only when captured")
+{
+    Scoped_State scoped;
+    Subject outer{"outer"};
+    Subject inner{"inner"};
+
+    auto outer_guard = make_frame_guard<describe>(outer);
+    {
+        auto inner_guard = make_frame_guard<describe>(inner);
+        CHECK(outer.times_described == 0);
+        CHECK(inner.times_described == 0);
+
+        CHECK(scoped.state.capture_snapshot()
+              == std::vector{"At inner"s, "At outer"s});
+        CHECK(outer.times_described == 1);
+        CHECK(inner.times_described == 1);
+    }
+
+    CHECK(scoped.state.capture_snapshot() == std::vector{"At outer"s});
+}
+
+TEST_CASE("Backtrace frames are not recorded without a state")
+{
+    Subject subject{"nowhere"};
+    {
+        auto guard = make_frame_guard<describe>(subject);
+    }
+
+    Scoped_State scoped;
+    CHECK(scoped.state.capture_snapshot().empty());
+    CHECK(subject.times_described == 0);
+}
+
+TEST_CASE("Errors capture the backtrace when thrown")
+{
+    Scoped_State scoped;
+    Subject subject{"throw site"};
+    auto guard = make_frame_guard<describe>(subject);
+
+    Frost_Recoverable_Error error{"boom"};
+    CHECK(error.take_backtrace() == std::vector{"At throw site"s});
+}
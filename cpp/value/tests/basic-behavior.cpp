@@ -306,4 +306,48 @@ TEST_CASE("Singleton identity")
         CHECK(true_a->get<frst::Bool>().value());
         CHECK_FALSE(false_a->get<frst::Bool>().value());
     }
+
+    SECTION("Comparison results are the Bool singletons")
+    {
+        using namespace frst::literals;
+
+        const auto one = Value::create(1_f);
+        const auto two = Value::create(2_f);
+
+        CHECK(Value::less_than(one, two) == Value::create(true));
+        CHECK(Value::less_than(two, one) == Value::create(false));
+        CHECK(Value::equal(one, one) == Value::create(true));
+        CHECK(Value::not_equal(one, one) == Value::create(false));
+    }
+
+    SECTION("Small Ints are shared")
+    {
+        using namespace frst::literals;
+
+        for (const frst::Int i : {Value::small_int_min, frst::Int{-1},
+                                  frst::Int{0}, Value::small_int_max})
+        {
+            const auto a = Value::create(i);
+            const auto b = Value::create(i);
+            CHECK(a == b);
+            CHECK(a->get<frst::Int>() == i);
+        }
+
+        CHECK(Value::create(7) == Value::create(7_f));
+        CHECK(Value::add(Value::create(2_f), Value::create(3_f))
+              == Value::create(5_f));
+    }
+
+    SECTION("Ints outside the small range are distinct")
+    {
+        for (const frst::Int i :
+             {Value::small_int_min - 1, Value::small_int_max + 1})
+        {
+            const auto a = Value::create(i);
+            const auto b = Value::create(i);
+            CHECK(a != b);
+            CHECK(a->get<frst::Int>() == i);
+            CHECK(b->get<frst::Int>() == i);
+        }
+    }
 }
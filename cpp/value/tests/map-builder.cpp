@@ -0,0 +1,100 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+
+#include <vector>
+
+#include <frost/map-builder.hpp>
+#include <frost/value.hpp>
+
+using namespace frst;
+using namespace std::literals;
+using Catch::Matchers::ContainsSubstring;
+
+TEST_CASE("Map_Builder")
+{
+    SECTION("Builds an empty Map")
+    {
+        CHECK(Map_Builder{}.build().empty());
+    }
+
+    SECTION("Entries added out of order come out sorted")
+    {
+        Map_Builder builder;
+        for (Int i : {5, 3, 9, 1, 7})
+            builder.add(Value::create(i), Value::create(i * 10));
+
+        const auto map = std::move(builder).build();
+        REQUIRE(map.size() == 5);
+
+        std::vector<Int> keys;
+        for (const auto& [k, v] : map)
+        {
+            keys.push_back(k->raw_get<Int>());
+            CHECK(v->raw_get<Int>() == k->raw_get<Int>() * 10);
+        }
+        CHECK(keys == std::vector<Int>{1, 3, 5, 7, 9});
+    }
+
+    SECTION("Keys of different types order like a Map does")
+    {
+        Map_Builder builder;
+        builder.add(Value::create("b"s), Value::create(1_f));
+        builder.add(Value::create(2_f), Value::create(2_f));
+        builder.add(Value::create(true), Value::create(3_f));
+        builder.add(Value::create("a"s), Value::create(4_f));
+
+        Map expected;
+        expected.emplace(Value::create("b"s), Value::create(1_f));
+        expected.emplace(Value::create(2_f), Value::create(2_f));
+        expected.emplace(Value::create(true), Value::create(3_f));
+        expected.emplace(Value::create("a"s), Value::create(4_f));
+
+        const auto map = std::move(builder).build();
+        CHECK(Value::equal(Value::create(Value::trusted, auto{map}),
+                           Value::create(Value::trusted, std::move(expected)))
+                  ->truthy());
+    }
+
+    SECTION("Repeated keys keep the first value")
+    {
+        auto first = Value::create(1_f);
+
+        Map_Builder builder;
+        builder.add(Value::create("k"s), first);
+        builder.add(Value::create("other"s), Value::create(2_f));
+        builder.add(Value::create("k"s), Value::create(3_f));
+
+        const auto map = std::move(builder).build();
+        REQUIRE(map.size() == 2);
+        CHECK(map.at(Value::create("k"s)) == first);
+    }
+
+    SECTION("Repeated keys can be rejected")
+    {
+        Map_Builder builder;
+        builder.add(Value::create(1_f), Value::create(1_f));
+        builder.add(Value::create(1_f), Value::create(2_f));
+
+        CHECK_THROWS_WITH(
+            std::move(builder).build([](const Value_Ptr& key) {
+                throw Frost_Recoverable_Error{
+                    fmt::format("duplicate {}", key->to_internal_string())};
+            }),
+            ContainsSubstring("duplicate 1"));
+    }
+
+    SECTION("Builds large Maps")
+    {
+        constexpr Int size = 200'000;
+
+        Map_Builder builder;
+        builder.reserve(size);
+        for (Int i = size; i > 0; --i)
+            builder.add(Value::create(i), Value::null());
+
+        const auto map = std::move(builder).build();
+        REQUIRE(map.size() == size);
+        CHECK(map.begin()->first->raw_get<Int>() == 1);
+        CHECK(std::prev(map.end())->first->raw_get<Int>() == size);
+    }
+}
@@ -0,0 +1,286 @@
+#include <frost/ast.hpp>
+#include <frost/ast/lambda.hpp>
+#include <frost/closure.hpp>
+#include <frost/vm.hpp>
+
+#include <algorithm>
+#include <memory>
+
+using namespace frst;
+using namespace frst::vm;
+
+namespace
+{
+
+//! @brief Lowers statements and expressions into a single Chunk
+//!
+//! Registers are handed out in stack order: an expression is compiled into a
+//! destination register, and may use any register above the high-water mark
+//! as scratch, releasing it all once done. Operands for each instruction are
+//! evaluated in the same order as the tree walker would evaluate them.
+class Compiler
+{
+  public:
+    Compiler() = default;
+    Compiler(const Compiler&) = delete;
+    Compiler(Compiler&&) = delete;
+    Compiler& operator=(const Compiler&) = delete;
+    Compiler& operator=(Compiler&&) = delete;
+    ~Compiler() = default;
+
+    void statement(const ast::Statement& node);
+    void expression(const ast::Expression& node, std::uint32_t dst);
+
+    std::uint32_t acquire()
+    {
+        const auto reg = next_register_++;
+        chunk_.register_count =
+            std::max(chunk_.register_count, next_register_);
+        return reg;
+    }
+
+    std::uint32_t emit(Op op, std::uint32_t a = 0, std::uint32_t b = 0,
+                       std::uint32_t c = 0)
+    {
+        chunk_.code.push_back(Instruction{.op = op, .a = a, .b = b, .c = c});
+        return static_cast<std::uint32_t>(chunk_.code.size() - 1);
+    }
+
+    std::uint32_t constant(Value_Ptr value)
+    {
+        return add_operand(chunk_.constants, std::move(value));
+    }
+
+    Chunk finish() &&
+    {
+        return std::move(chunk_);
+    }
+
+  private:
+    // Point a previously emitted jump at the next instruction
+    void patch_jump(std::uint32_t jump)
+    {
+        chunk_.code.at(jump).b = static_cast<std::uint32_t>(chunk_.code.size());
+    }
+
+    template <typename T>
+    static std::uint32_t add_operand(std::vector<T>& table, T operand)
+    {
+        table.push_back(std::move(operand));
+        return static_cast<std::uint32_t>(table.size() - 1);
+    }
+
+    void load(const std::string& name, const std::optional<Frame_Slot>& slot,
+              std::uint32_t dst);
+    void bind(const std::string& name, const std::optional<Frame_Slot>& slot,
+              std::uint32_t src);
+
+    void binop(const ast::Binop& node, std::uint32_t dst);
+    void if_expr(const ast::If& node, std::uint32_t dst);
+    void call(const ast::Function_Call& node, std::uint32_t dst);
+    void array(const ast::Array_Constructor& node, std::uint32_t dst);
+
+    Chunk chunk_;
+    std::uint32_t next_register_ = 0;
+};
+
+void Compiler::statement(const ast::Statement& node)
+{
+    const auto mark = next_register_;
+
+    if (const auto* expr = dynamic_cast<const ast::Expression*>(&node))
+    {
+        expression(*expr, acquire());
+        next_register_ = mark;
+        return;
+    }
+
+    if (const auto* define = dynamic_cast<const ast::Define*>(&node))
+    {
+        if (const auto* binding = dynamic_cast<const ast::Destructure_Binding*>(
+                &define->destructure()))
+        {
+            const auto value = acquire();
+            expression(define->expr(), value);
+            if (binding->name())
+                bind(binding->name().value(), binding->slot(), value);
+            next_register_ = mark;
+            return;
+        }
+    }
+
+    emit(Op::Execute, 0, add_operand(chunk_.statements, &node));
+}
+
+void Compiler::expression(const ast::Expression& node, std::uint32_t dst)
+{
+    if (const auto* literal = dynamic_cast<const ast::Literal*>(&node))
+        emit(Op::Load_Const, dst, constant(literal->value()));
+    else if (const auto* lookup = dynamic_cast<const ast::Name_Lookup*>(&node))
+        load(lookup->name(), lookup->slot(), dst);
+    else if (const auto* bin = dynamic_cast<const ast::Binop*>(&node))
+        binop(*bin, dst);
+    else if (const auto* if_node = dynamic_cast<const ast::If*>(&node))
+        if_expr(*if_node, dst);
+    else if (const auto* fn_call =
+                 dynamic_cast<const ast::Function_Call*>(&node))
+        call(*fn_call, dst);
+    else if (const auto* array_ctor =
+                 dynamic_cast<const ast::Array_Constructor*>(&node))
+        array(*array_ctor, dst);
+    else if (const auto* block = dynamic_cast<const ast::Do_Block*>(&node);
+             block && block->resolved())
+    {
+        // A resolved block binds straight into the frame, so its body can be
+        // inlined. An unresolved one needs a table of its own.
+        for (const ast::Statement::Ptr& each : block->body_prefix())
+            statement(*each);
+        expression(block->value_expr(), dst);
+    }
+    else
+        emit(Op::Evaluate, dst, add_operand(chunk_.expressions, &node));
+}
+
+void Compiler::load(const std::string& name,
+                    const std::optional<Frame_Slot>& slot, std::uint32_t dst)
+{
+    if (slot)
+        emit(Op::Load_Slot, dst,
+             add_operand(chunk_.slots, Slot_Operand{slot.value(), name}));
+    else
+        emit(Op::Load_Name, dst, add_operand(chunk_.names, name));
+}
+
+void Compiler::bind(const std::string& name,
+                    const std::optional<Frame_Slot>& slot, std::uint32_t src)
+{
+    if (slot)
+        emit(Op::Define_Slot, src,
+             add_operand(chunk_.slots, Slot_Operand{slot.value(), name}));
+    else
+        emit(Op::Define_Name, src, add_operand(chunk_.names, name));
+}
+
+void Compiler::binop(const ast::Binop& node, std::uint32_t dst)
+{
+    using enum ast::Binary_Op;
+
+    expression(node.lhs(), dst);
+
+    // The short-circuiting operators produce whichever operand decided them
+    if (node.op() == AND || node.op() == OR)
+    {
+        const auto skip_rhs =
+            emit(node.op() == AND ? Op::Jump_If_False : Op::Jump_If_True, dst);
+        expression(node.rhs(), dst);
+        patch_jump(skip_rhs);
+        return;
+    }
+
+    const auto mark = next_register_;
+    const auto rhs = acquire();
+    expression(node.rhs(), rhs);
+    emit(Op::Binary, dst, rhs, static_cast<std::uint32_t>(node.op()));
+    next_register_ = mark;
+}
+
+void Compiler::if_expr(const ast::If& node, std::uint32_t dst)
+{
+    expression(node.condition(), dst);
+    const auto to_alternate = emit(Op::Jump_If_False, dst);
+
+    expression(node.consequent(), dst);
+    const auto to_end = emit(Op::Jump);
+
+    patch_jump(to_alternate);
+    if (const auto* alternate = node.alternate())
+        expression(*alternate, dst);
+    else
+        emit(Op::Load_Const, dst, constant(Value::null()));
+
+    patch_jump(to_end);
+}
+
+void Compiler::call(const ast::Function_Call& node, std::uint32_t dst)
+{
+    const auto mark = next_register_;
+
+    const auto callee = acquire();
+    expression(node.fn_expr(), callee);
+    emit(Op::Check_Callable, callee);
+
+    for (const ast::Expression::Ptr& arg : node.args_exprs())
+        expression(*arg, acquire());
+
+    emit(node.tail_call() ? Op::Tail_Call : Op::Call, dst, callee,
+         static_cast<std::uint32_t>(node.args_exprs().size()));
+    next_register_ = mark;
+}
+
+void Compiler::array(const ast::Array_Constructor& node, std::uint32_t dst)
+{
+    const auto mark = next_register_;
+
+    // Each element takes the next register up, starting from the mark
+    for (const ast::Expression::Ptr& elem : node.elems())
+        expression(*elem, acquire());
+
+    emit(Op::Make_Array, dst, mark,
+         static_cast<std::uint32_t>(node.elems().size()));
+    next_register_ = mark;
+}
+
+class Bytecode_Body final : public Compiled_Body
+{
+  public:
+    explicit Bytecode_Body(Chunk chunk)
+        : chunk_{std::move(chunk)}
+    {
+    }
+
+    Value_Ptr run(Execution_Context ctx) const final
+    {
+        return vm::run(chunk_, ctx);
+    }
+
+  private:
+    Chunk chunk_;
+};
+
+Chunk compile_lambda_body(const ast::Lambda& lambda)
+{
+    Compiler compiler;
+    for (const ast::Statement::Ptr& statement : lambda.body_prefix())
+        compiler.statement(*statement);
+
+    const auto result = compiler.acquire();
+    compiler.expression(lambda.return_expr(), result);
+    compiler.emit(Op::Return, result);
+    return std::move(compiler).finish();
+}
+
+} // namespace
+
+Chunk vm::compile_program(const std::vector<ast::Statement::Ptr>& program)
+{
+    // Nested lambdas are children of their enclosing lambda, so walking the
+    // program reaches every one of them
+    for (const ast::Statement::Ptr& statement : program)
+    {
+        for (const ast::AST_Node* node : statement->walk())
+        {
+            if (const auto* lambda = dynamic_cast<const ast::Lambda*>(node))
+                lambda->set_compiled_body(std::make_shared<const Bytecode_Body>(
+                    compile_lambda_body(*lambda)));
+        }
+    }
+
+    Compiler compiler;
+    for (const ast::Statement::Ptr& statement : program)
+        compiler.statement(*statement);
+
+    const auto result = compiler.acquire();
+    compiler.emit(Op::Load_Const, result, compiler.constant(Value::null()));
+    compiler.emit(Op::Return, result);
+    return std::move(compiler).finish();
+}
@@ -0,0 +1,24 @@
+#ifndef FROST_VM_HPP
+#define FROST_VM_HPP
+
+#include <frost/ast/statement.hpp>
+#include <frost/execution-context.hpp>
+#include <frost/vm/bytecode.hpp>
+
+#include <vector>
+
+namespace frst::vm
+{
+
+// Lower a program to bytecode
+// Every lambda within the program also has its body compiled, so closures
+// created from it run on the VM as well
+// The program must outlive the chunk
+Chunk compile_program(const std::vector<ast::Statement::Ptr>& program);
+
+// Run a chunk to its Return, and produce the returned value
+Value_Ptr run(const Chunk& chunk, Execution_Context ctx);
+
+} // namespace frst::vm
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef FROST_VM_BYTECODE_HPP
+#define FROST_VM_BYTECODE_HPP
+
+#include <frost/ast/expression.hpp>
+#include <frost/ast/statement.hpp>
+#include <frost/frame.hpp>
+#include <frost/value.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace frst::vm
+{
+
+// R[x] is register x, the operand tables live in the Chunk
+enum class Op : std::uint8_t
+{
+    Load_Const,     // R[a] = constants[b]
+    Load_Name,      // R[a] = lookup names[b] in the symbol table
+    Load_Slot,      // R[a] = lookup slots[b] in the frame
+    Define_Name,    // define names[b] = R[a] in the symbol table
+    Define_Slot,    // define slots[b] = R[a] in the frame
+    Binary,         // R[a] = R[a] <Binary_Op c> R[b]
+    Jump,           // goto b
+    Jump_If_False,  // if not R[a]: goto b
+    Jump_If_True,   // if R[a]: goto b
+    Check_Callable, // fail unless R[a] is a function
+    Call,           // R[a] = R[b](R[b + 1], ..., R[b + c])
+    Tail_Call,      // as Call, but left to the running closure to make
+    Make_Array,     // R[a] = [R[b], ..., R[b + c - 1]]
+    Evaluate,       // R[a] = evaluate expressions[b]
+    Execute,        // execute statements[b]
+    Return,         // return R[a]
+};
+
+struct Instruction
+{
+    Op op;
+    std::uint32_t a = 0;
+    std::uint32_t b = 0;
+    std::uint32_t c = 0;
+};
+
+struct Slot_Operand
+{
+    Frame_Slot slot;
+    std::string name;
+};
+
+//! @brief A unit of bytecode: a whole program, or one closure body
+//!
+//! Anything the compiler does not lower is kept as a pointer to its AST node
+//! and run by the tree walker, so the AST must outlive the chunk.
+struct Chunk
+{
+    std::vector<Instruction> code;
+    std::vector<Value_Ptr> constants;
+    std::vector<std::string> names;
+    std::vector<Slot_Operand> slots;
+    std::vector<const ast::Expression*> expressions;
+    std::vector<const ast::Statement*> statements;
+    std::uint32_t register_count = 0;
+};
+
+} // namespace frst::vm
+
+#endif
@@ -0,0 +1,167 @@
+#include <frost/ast/binop.hpp>
+#include <frost/ast/function-call.hpp>
+#include <frost/backtrace.hpp>
+#include <frost/tail-call.hpp>
+#include <frost/vm.hpp>
+
+#include <fmt/format.h>
+
+#include <span>
+
+using namespace frst;
+using namespace frst::vm;
+
+namespace
+{
+
+Value_Ptr binary(ast::Binary_Op op, const Value_Ptr& lhs, const Value_Ptr& rhs)
+{
+    using enum ast::Binary_Op;
+
+    switch (op)
+    {
+    case PLUS:
+        return Value::add(lhs, rhs);
+    case MINUS:
+        return Value::subtract(lhs, rhs);
+    case MULTIPLY:
+        return Value::multiply(lhs, rhs);
+    case DIVIDE:
+        return Value::divide(lhs, rhs);
+    case MODULUS:
+        return Value::modulus(lhs, rhs);
+    case EQ:
+        return Value::equal(lhs, rhs);
+    case NE:
+        return Value::not_equal(lhs, rhs);
+    case LT:
+        return Value::less_than(lhs, rhs);
+    case LE:
+        return Value::less_than_or_equal(lhs, rhs);
+    case GT:
+        return Value::greater_than(lhs, rhs);
+    case GE:
+        return Value::greater_than_or_equal(lhs, rhs);
+    case AND:
+        [[fallthrough]];
+    case OR:
+        // Lowered to jumps by the compiler
+        THROW_UNREACHABLE;
+    }
+
+    THROW_UNREACHABLE;
+}
+
+} // namespace
+
+Value_Ptr vm::run(const Chunk& chunk, Execution_Context ctx)
+{
+    std::vector<Value_Ptr> registers(chunk.register_count);
+    const std::span<const Value_Ptr> args_window{registers};
+
+    const Instruction* const code = chunk.code.data();
+    const Instruction* pc = code;
+
+    while (true)
+    {
+        const Instruction& ins = *pc++;
+
+        switch (ins.op)
+        {
+        case Op::Load_Const:
+            registers[ins.a] = chunk.constants[ins.b];
+            break;
+        case Op::Load_Name:
+            registers[ins.a] = ctx.symbols.lookup(chunk.names[ins.b]);
+            break;
+        case Op::Load_Slot:
+        {
+            const auto& [slot, name] = chunk.slots[ins.b];
+            registers[ins.a] = ctx.frame->lookup(slot, name);
+            break;
+        }
+        case Op::Define_Name:
+            ctx.symbols.define(chunk.names[ins.b], registers[ins.a]);
+            break;
+        case Op::Define_Slot:
+        {
+            const auto& [slot, name] = chunk.slots[ins.b];
+            ctx.frame->define(slot, registers[ins.a], name);
+            break;
+        }
+        case Op::Binary:
+            registers[ins.a] = binary(static_cast<ast::Binary_Op>(ins.c),
+                                      registers[ins.a], registers[ins.b]);
+            break;
+        case Op::Jump:
+            pc = code + ins.b;
+            break;
+        case Op::Jump_If_False:
+            if (not registers[ins.a]->truthy())
+                pc = code + ins.b;
+            break;
+        case Op::Jump_If_True:
+            if (registers[ins.a]->truthy())
+                pc = code + ins.b;
+            break;
+        case Op::Check_Callable:
+            if (not registers[ins.a]->is<Function>())
+            {
+                throw Frost_Recoverable_Error{
+                    fmt::format("Cannot call value of type {}",
+                                registers[ins.a]->type_name())};
+            }
+            break;
+        case Op::Tail_Call:
+            // As in the tree walker, backtraces keep every frame
+            if (not Backtrace_State::current())
+            {
+                const auto args = args_window.subspan(ins.b + 1, ins.c);
+                registers[ins.a] =
+                    Tail_Call::defer(registers[ins.b]->raw_get<Function>(),
+                                     {args.begin(), args.end()});
+                break;
+            }
+            [[fallthrough]];
+        case Op::Call:
+        {
+            const auto& callable = registers[ins.b]->raw_get<Function>();
+
+            Value_Ptr result;
+            {
+                auto guard =
+                    make_frame_guard<ast::Function_Call::describe_call>(
+                        *callable);
+                result =
+                    callable->call(args_window.subspan(ins.b + 1, ins.c));
+            }
+
+            // Let go of the callee and arguments as soon as the call is
+            // done, as the tree walker would
+            for (auto& reg : std::span{registers}.subspan(ins.b, ins.c + 1))
+                reg.reset();
+
+            registers[ins.a] = std::move(result);
+            break;
+        }
+        case Op::Make_Array:
+        {
+            Array elems;
+            elems.reserve(ins.c);
+            for (auto& reg : std::span{registers}.subspan(ins.b, ins.c))
+                elems.push_back(std::move(reg));
+            registers[ins.a] = Value::create(std::move(elems));
+            break;
+        }
+        case Op::Evaluate:
+            registers[ins.a] =
+                chunk.expressions[ins.b]->evaluate(ctx.as_eval());
+            break;
+        case Op::Execute:
+            chunk.statements[ins.b]->execute(ctx);
+            break;
+        case Op::Return:
+            return std::move(registers[ins.a]);
+        }
+    }
+}
@@ -0,0 +1,171 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <frost/builtin.hpp>
+#include <frost/parser.hpp>
+#include <frost/symbol-table.hpp>
+#include <frost/testing/stringmaker-specializations.hpp>
+#include <frost/value.hpp>
+#include <frost/vm.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <string>
+
+using namespace frst;
+
+namespace
+{
+
+enum class Engine
+{
+    Tree,
+    VM,
+};
+
+// Run a program on one engine, and render what it bound to `result`, or the
+// error it failed with
+std::string run_program(const std::string& source, Engine engine)
+{
+    auto program = parse_program(source, "<test>");
+    REQUIRE(program.has_value());
+
+    Symbol_Table root;
+    inject_builtins(root);
+    Symbol_Table symbols{&root};
+    Execution_Context ctx{.symbols = symbols};
+
+    try
+    {
+        if (engine == Engine::VM)
+        {
+            (void)vm::run(vm::compile_program(program.value()), ctx);
+        }
+        else
+        {
+            for (const auto& statement : program.value())
+                statement->execute(ctx);
+        }
+    }
+    catch (const Frost_User_Error& e)
+    {
+        return fmt::format("error: {}", e.what());
+    }
+
+    return symbols.lookup("result")->to_internal_string({.in_structure = true});
+}
+
+void check_engines_agree(const std::string& source)
+{
+    CAPTURE(source);
+    CHECK(run_program(source, Engine::VM)
+          == run_program(source, Engine::Tree));
+}
+
+bool has_op(const vm::Chunk& chunk, vm::Op op)
+{
+    return std::ranges::contains(chunk.code, op, &vm::Instruction::op);
+}
+
+} // namespace
+
+TEST_CASE("VM: lowers plain expressions without the tree walker")
+{
+    auto program =
+        parse_program("def result = len([1, 2]) + (3 * 4)", "<test>");
+    REQUIRE(program.has_value());
+
+    const auto chunk = vm::compile_program(program.value());
+    CHECK(has_op(chunk, vm::Op::Call));
+    CHECK(has_op(chunk, vm::Op::Make_Array));
+    CHECK(has_op(chunk, vm::Op::Binary));
+    CHECK(has_op(chunk, vm::Op::Define_Name));
+    CHECK_FALSE(has_op(chunk, vm::Op::Evaluate));
+    CHECK_FALSE(has_op(chunk, vm::Op::Execute));
+}
+
+TEST_CASE("VM: agrees with the tree walker on arithmetic and logic")
+{
+    check_engines_agree("def result = 1 + 2 * 3 - 4 / 2");
+    check_engines_agree("def result = [1 < 2, 2 <= 2, 3 > 4, 3 >= 4]");
+    check_engines_agree("def result = [1 == 1, 1 != 1, 'a' + 'b', 7 % 3]");
+    check_engines_agree("def result = [false and 1, true and 2, null or 3]");
+    check_engines_agree("def result = [1 or 2, false or null]");
+}
+
+TEST_CASE("VM: agrees with the tree walker on control flow")
+{
+    check_engines_agree("def result = if true: 1 else: 2");
+    check_engines_agree("def result = if false: 1");
+    check_engines_agree(R"(
+defn classify(n) -> if n == 1: 'one' elif n == 2: 'two' else: 'many'
+def result = [classify(1), classify(2), classify(3)]
+)");
+}
+
+TEST_CASE("VM: agrees with the tree walker on closures")
+{
+    check_engines_agree(R"(
+defn fib(n) -> if n < 2: n else: fib(n - 1) + fib(n - 2)
+def result = fib(15)
+)");
+    check_engines_agree(R"(
+def adder = fn x -> fn y -> x + y
+def result = adder(3)(4)
+)");
+    check_engines_agree(R"(
+def f = fn x -> {
+    def y = do {
+        def z = x * 2
+        z + 1
+    }
+    [x, y]
+}
+def result = f(5)
+)");
+    check_engines_agree(R"(
+defn pick(v) -> match v { [a, b] => a + b, {x} => x, _ => 'other' }
+def result = [pick([1, 2]), pick({x: 3}), pick(4)]
+)");
+    check_engines_agree(R"(
+def result = do {
+    def [a, b] = [1, 2]
+    def {c: c} = {c: 3}
+    a + b + c
+}
+)");
+}
+
+TEST_CASE("VM: agrees with the tree walker on deep tail recursion")
+{
+    check_engines_agree(R"(
+defn count(n, acc) -> if n == 0: acc else: count(n - 1, acc + 1)
+def result = count(1000000, 0)
+)");
+    check_engines_agree(R"(
+defn walk(n) -> match n {
+    0 => 'done',
+    _ => do {
+        def next = n - 1
+        walk(next)
+    }
+}
+def result = walk(1000000)
+)");
+}
+
+TEST_CASE("VM: agrees with the tree walker on errors")
+{
+    check_engines_agree("def result = 1 + 'a'");
+    check_engines_agree("def result = 1(2)");
+    check_engines_agree("def result = undefined_name");
+    check_engines_agree(R"(
+def x = 1
+def x = 2
+def result = x
+)");
+    check_engines_agree(R"(
+def f = fn a -> a
+def result = f(1, 2)
+)");
+}
@@ -0,0 +1,11 @@
+#!/usr/bin/env python3
+
+n = 1_000_000
+
+checksum = 0
+for i in range(n):
+    step = i % 17 if i % 3 == 0 else i % 11 + 1
+    checksum = (checksum * 31 + step) % 1009
+
+assert checksum == 519
+print(checksum)
@@ -0,0 +1,12 @@
+#!/usr/bin/env ruby
+
+n = 1_000_000
+
+checksum = 0
+(0...n).each do |i|
+  step = (i % 3).zero? ? i % 17 : i % 11 + 1
+  checksum = (checksum * 31 + step) % 1009
+end
+
+raise unless checksum == 519
+puts checksum